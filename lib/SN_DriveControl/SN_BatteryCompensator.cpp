@@ -0,0 +1,53 @@
+#include <SN_BatteryCompensator.h>
+
+BatteryCompensator::BatteryCompensator(const battery_comp_config_t &config)
+    : config_(config) {
+    reset();
+}
+
+void BatteryCompensator::reset() {
+    have_voltage_ = false;
+    filtered_v_ = 0.0f;
+    gain_ = 1.0f;
+}
+
+void BatteryCompensator::updateVoltage(float bus_v, float dt_s) {
+    if (bus_v < config_.min_valid_v) {
+        // No usable reading: run uncompensated until the ADC delivers again
+        have_voltage_ = false;
+        gain_ = 1.0f;
+        return;
+    }
+
+    if (!have_voltage_) {
+        filtered_v_ = bus_v;
+        have_voltage_ = true;
+    } else if (dt_s > 0.0f) {
+        float alpha = dt_s / (config_.filter_tau_s + dt_s);
+        filtered_v_ += alpha * (bus_v - filtered_v_);
+    }
+
+    float gain = config_.nominal_v / filtered_v_;
+    if (gain < config_.min_gain) gain = config_.min_gain;
+    if (gain > config_.max_gain) gain = config_.max_gain;
+    gain_ = gain;
+}
+
+drive_mix_t BatteryCompensator::apply(const drive_mix_t &duty) const {
+    float left = duty.left * gain_;
+    float right = duty.right * gain_;
+
+    // Keep the turn ratio if a side would saturate
+    float abs_left = left < 0.0f ? -left : left;
+    float abs_right = right < 0.0f ? -right : right;
+    float peak = abs_left > abs_right ? abs_left : abs_right;
+    if (peak > 100.0f) {
+        left *= 100.0f / peak;
+        right *= 100.0f / peak;
+    }
+
+    drive_mix_t out;
+    out.left = (int16_t)(left >= 0.0f ? left + 0.5f : left - 0.5f);
+    out.right = (int16_t)(right >= 0.0f ? right + 0.5f : right - 0.5f);
+    return out;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+#include <SN_DriveMixer.h>
+
+// ============================================================================
+// BATTERY-SAG FEED-FORWARD (OBC)
+// ============================================================================
+// Motor speed follows the applied voltage, duty x bus voltage, so the same
+// stick position gets slower as the pack discharges. BatteryCompensator
+// scales the open-loop duty by nominal / measured bus voltage:
+//   - the measurement is low-pass filtered (time constant filter_tau_s) so
+//     the fast sag caused by the motors themselves does not feed back into
+//     the duty
+//   - the gain is clamped to [min_gain, max_gain]
+//   - if a side would exceed 100 %, both sides are scaled down by the same
+//     factor so the turn ratio is kept
+//   - readings below min_valid_v (ADC disabled or not yet read) disable the
+//     compensation (gain 1)
+// With nominal_v below full charge the response is the same from full
+// charge down to nominal_v / max_gain; full stick still reaches 100 % duty.
+//
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_BATTERY_COMP_ENABLED
+#define SN_BATTERY_COMP_ENABLED 1
+#endif
+
+#ifndef SN_BATTERY_COMP_NOMINAL_V
+#define SN_BATTERY_COMP_NOMINAL_V 11.1f     // 3S nominal: full charge (12.6 V) is scaled down, 10.5 V up
+#endif
+
+#ifndef SN_BATTERY_COMP_MIN_GAIN
+#define SN_BATTERY_COMP_MIN_GAIN 0.8f
+#endif
+
+#ifndef SN_BATTERY_COMP_MAX_GAIN
+#define SN_BATTERY_COMP_MAX_GAIN 1.25f
+#endif
+
+#ifndef SN_BATTERY_COMP_TAU_S
+#define SN_BATTERY_COMP_TAU_S 2.0f
+#endif
+
+#ifndef SN_BATTERY_COMP_MIN_VALID_V
+#define SN_BATTERY_COMP_MIN_VALID_V 6.0f
+#endif
+
+typedef struct {
+    float nominal_v;
+    float min_gain;
+    float max_gain;
+    float filter_tau_s;
+    float min_valid_v;
+} battery_comp_config_t;
+
+class BatteryCompensator {
+public:
+    explicit BatteryCompensator(const battery_comp_config_t &config);
+
+    void reset();
+
+    // Feed one bus voltage reading taken dt_s after the previous one
+    void updateVoltage(float bus_v, float dt_s);
+
+    // Scale left/right duty (percent) by the current gain
+    drive_mix_t apply(const drive_mix_t &duty) const;
+
+    float filteredVoltage() const { return filtered_v_; }
+    float gain() const { return gain_; }
+
+private:
+    battery_comp_config_t config_;
+    bool have_voltage_;
+    float filtered_v_;
+    float gain_;
+};
@@ -0,0 +1,181 @@
+#include <SN_DriveControl.h>
+#include <string.h>
+#include <math.h>
+
+// Signed distance a - b on a wrapping 32-bit microsecond clock
+static inline int32_t timeDiff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+static uint16_t toAxis(float v) {
+    if (v <= 0.0f) return 0;
+    if (v >= (float)CMD_INTERP_AXIS_MAX) return CMD_INTERP_AXIS_MAX;
+    return (uint16_t)(v + 0.5f);
+}
+
+CommandInterpolator::CommandInterpolator(const cmd_interp_config_t &config)
+    : config_(config) {
+    reset();
+}
+
+void CommandInterpolator::reset() {
+    count_ = 0;
+    newest_settled_ = false;
+    base_time_us_ = 0;
+    have_offset_ = false;
+    offset_us_ = 0;
+    window_min_us_ = 0;
+    prev_window_min_us_ = 0;
+    window_samples_ = 0;
+    memset(result_count_, 0, sizeof(result_count_));
+}
+
+bool CommandInterpolator::addSample(uint32_t tx_time_us, uint32_t rx_time_us, uint16_t x, uint16_t y, bool update_clock,
+                                    bool settled) {
+    if (update_clock) {
+        // Windowed minimum of (rx - tx): the smallest value is the frame that
+        // saw the least queueing. Two windows overlap so clock drift between
+        // the boards is followed within 2 * CMD_INTERP_OFFSET_WINDOW frames.
+        uint32_t d = rx_time_us - tx_time_us;
+        if (!have_offset_) {
+            window_min_us_ = d;
+            prev_window_min_us_ = d;
+            window_samples_ = 0;
+            have_offset_ = true;
+        } else if (window_samples_ >= CMD_INTERP_OFFSET_WINDOW) {
+            prev_window_min_us_ = window_min_us_;
+            window_min_us_ = d;
+            window_samples_ = 0;
+        } else if (timeDiff(d, window_min_us_) < 0) {
+            window_min_us_ = d;
+        }
+        window_samples_++;
+        offset_us_ = (timeDiff(window_min_us_, prev_window_min_us_) < 0) ? window_min_us_ : prev_window_min_us_;
+    }
+
+    if (count_ > 0) {
+        int32_t since_newest = timeDiff(tx_time_us, base_time_us_) - samples_[count_ - 1].t;
+        if (since_newest <= 0) {
+            return false;   // Stale or duplicate
+        }
+        if ((uint32_t)since_newest > config_.max_sample_gap_us) {
+            count_ = 0;     // Nothing meaningful to blend across the gap
+        }
+    }
+
+    if (count_ == 0) {
+        base_time_us_ = tx_time_us;
+    } else if (count_ == CMD_INTERP_HISTORY) {
+        memmove(&samples_[0], &samples_[1], (CMD_INTERP_HISTORY - 1) * sizeof(Sample));
+        count_--;
+    }
+
+    Sample &s = samples_[count_++];
+    s.t = timeDiff(tx_time_us, base_time_us_);
+    s.x = (float)x;
+    s.y = (float)y;
+    newest_settled_ = settled;
+
+    // Keep the oldest sample at t = 0 so relative times stay small
+    int32_t shift = samples_[0].t;
+    if (shift != 0) {
+        for (size_t i = 0; i < count_; i++) samples_[i].t -= shift;
+        base_time_us_ += (uint32_t)shift;
+    }
+    return true;
+}
+
+float CommandInterpolator::slope(const Sample *s, size_t a, size_t b, bool axis_y) const {
+    float dv = axis_y ? (s[b].y - s[a].y) : (s[b].x - s[a].x);
+    return dv / (float)(s[b].t - s[a].t);
+}
+
+float CommandInterpolator::blend(const Sample *s, size_t i, float t, bool axis_y) const {
+    float v0 = axis_y ? s[i].y : s[i].x;
+    float v1 = axis_y ? s[i + 1].y : s[i + 1].x;
+    float h = (float)(s[i + 1].t - s[i].t);
+    float u = (t - (float)s[i].t) / h;
+
+    if (config_.mode != CMD_INTERP_CUBIC) {
+        return v0 + (v1 - v0) * u;
+    }
+
+    // Cubic Hermite; tangents from the neighbouring segments (Catmull-Rom on
+    // non-uniform spacing), one-sided at the ends of the history
+    float m_seg = slope(s, i, i + 1, axis_y);
+    float m0 = (i > 0) ? 0.5f * (slope(s, i - 1, i, axis_y) + m_seg) : m_seg;
+    float m1 = (i + 2 < count_) ? 0.5f * (m_seg + slope(s, i + 1, i + 2, axis_y)) : m_seg;
+
+    float u2 = u * u;
+    float u3 = u2 * u;
+    float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+    float h10 = u3 - 2.0f * u2 + u;
+    float h01 = -2.0f * u3 + 3.0f * u2;
+    float h11 = u3 - u2;
+    return h00 * v0 + h10 * h * m0 + h01 * v1 + h11 * h * m1;
+}
+
+float CommandInterpolator::extrapolate(float dt, bool axis_y) const {
+    const Sample &prev = samples_[count_ - 2];
+    const Sample &newest = samples_[count_ - 1];
+    float v0 = axis_y ? prev.y : prev.x;
+    float v1 = axis_y ? newest.y : newest.x;
+    float neutral = (float)(axis_y ? config_.neutral_y : config_.neutral_x);
+    float v = v1 + slope(samples_, count_ - 2, count_ - 1, axis_y) * dt;
+
+    // No further than the last two samples moved
+    float span = fabsf(v1 - v0);
+    if (v > v1 + span) v = v1 + span;
+    if (v < v1 - span) v = v1 - span;
+
+    // Stop at neutral rather than crossing it
+    if ((v1 >= neutral && v < neutral) || (v1 <= neutral && v > neutral)) v = neutral;
+    return v;
+}
+
+cmd_interp_result_t CommandInterpolator::evaluate(uint32_t now_us, uint16_t &x, uint16_t &y) {
+    if (count_ == 0) {
+        result_count_[CMD_INTERP_RESULT_NONE]++;
+        return CMD_INTERP_RESULT_NONE;
+    }
+
+    const Sample &newest = samples_[count_ - 1];
+    cmd_interp_result_t result = CMD_INTERP_RESULT_HELD;
+    float vx = newest.x;
+    float vy = newest.y;
+
+    if (config_.mode != CMD_INTERP_STEP && have_offset_) {
+        // Render instant on the CTU clock, relative to the oldest sample
+        uint32_t render_us = now_us - offset_us_ - config_.playout_delay_us;
+        float t = (float)timeDiff(render_us, base_time_us_);
+
+        if (t <= (float)samples_[0].t) {
+            vx = samples_[0].x;
+            vy = samples_[0].y;
+        } else if (t < (float)newest.t) {
+            size_t i = 0;
+            while ((float)samples_[i + 1].t <= t) i++;
+            vx = blend(samples_, i, t, false);
+            vy = blend(samples_, i, t, true);
+            result = CMD_INTERP_RESULT_INTERPOLATED;
+        } else if (count_ >= 2 && !newest_settled_) {
+            // Next sample is late: continue the last slope for a bounded
+            // time, then fall back to the newest sample
+            float dt = t - (float)newest.t;
+            if (dt <= (float)config_.max_extrapolation_us) {
+                vx = extrapolate(dt, false);
+                vy = extrapolate(dt, true);
+                result = CMD_INTERP_RESULT_EXTRAPOLATED;
+            }
+        }
+    }
+
+    x = toAxis(vx);
+    y = toAxis(vy);
+    result_count_[result]++;
+    return result;
+}
+
+uint32_t CommandInterpolator::resultCount(cmd_interp_result_t result) const {
+    return (result <= CMD_INTERP_RESULT_HELD) ? result_count_[result] : 0;
+}
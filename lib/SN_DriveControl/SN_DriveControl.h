@@ -0,0 +1,139 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// TELECOMMAND INTERPOLATION / SHORT-HORIZON PREDICTION (OBC)
+// ============================================================================
+// The CTU sends joystick samples on events (at most every few ms while the
+// stick moves, every heartbeat while it rests), and each frame arrives with
+// its own radio delay. Applying every sample as a step makes the motors
+// follow that timing noise. CommandInterpolator turns the sample stream into
+// a continuous command that the control task can evaluate at its own rate:
+//
+//   - Samples are placed on the CTU clock using the frame timestamp, so
+//     radio jitter does not move them. A windowed minimum of (rx - tx) gives
+//     the clock offset plus the fastest transit seen; the CTU clock "now" is
+//     estimated as local time minus that offset.
+//   - The command is rendered playout_delay_us behind the estimated CTU
+//     clock and blended between the samples either side of that instant:
+//     linearly, or with a cubic Hermite (Catmull-Rom style) curve through
+//     four neighbouring samples.
+//   - If the next sample is late, the last two samples are extrapolated
+//     linearly for at most max_extrapolation_us, then the newest sample is
+//     held. The extrapolation never moves further from the newest sample
+//     than the last two samples are apart, and never carries an axis
+//     through its neutral value (a released stick must not become reverse).
+//     A sample the CTU marked settled (stick at rest or centred, see
+//     SN_SendPolicy.h) is never extrapolated: silence after it means hold.
+//   - Samples further apart than max_sample_gap_us are never blended or
+//     used for a slope (e.g. the first sample after the link came back).
+//
+// All times are low 32 bits of esp_timer_get_time() on the respective board;
+// wrap-around is handled with modular arithmetic.
+//
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_TC_INTERP_MODE
+#define SN_TC_INTERP_MODE 1                 // 0 = step (newest sample), 1 = linear, 2 = cubic
+#endif
+
+#ifndef SN_TC_PLAYOUT_DELAY_US
+#define SN_TC_PLAYOUT_DELAY_US 5000         // One minimum telecommand gap (TC_SEND_MIN_GAP_MS)
+#endif
+
+#ifndef SN_TC_MAX_EXTRAPOLATION_US
+#define SN_TC_MAX_EXTRAPOLATION_US 40000
+#endif
+
+#ifndef SN_TC_MAX_SAMPLE_GAP_US
+#define SN_TC_MAX_SAMPLE_GAP_US 250000      // Longer than the 100 ms send heartbeat
+#endif
+
+#define CMD_INTERP_HISTORY 4                // Samples kept: enough for one cubic segment
+#define CMD_INTERP_OFFSET_WINDOW 64         // Samples per clock-offset minimum window
+#define CMD_INTERP_AXIS_MAX 4095            // Raw 12-bit joystick ADC range
+
+typedef enum : uint8_t {
+    CMD_INTERP_STEP = 0,
+    CMD_INTERP_LINEAR = 1,
+    CMD_INTERP_CUBIC = 2,
+} cmd_interp_mode_t;
+
+typedef struct {
+    cmd_interp_mode_t mode;
+    uint32_t playout_delay_us;
+    uint32_t max_extrapolation_us;
+    uint32_t max_sample_gap_us;
+    uint16_t neutral_x;                 // Centred stick, ADC counts (extrapolation stops here)
+    uint16_t neutral_y;
+} cmd_interp_config_t;
+
+// How the latest evaluate() result was produced
+typedef enum : uint8_t {
+    CMD_INTERP_RESULT_NONE = 0,         // No sample yet
+    CMD_INTERP_RESULT_INTERPOLATED,     // Between two samples
+    CMD_INTERP_RESULT_EXTRAPOLATED,     // Past the newest sample, within the horizon (clamped)
+    CMD_INTERP_RESULT_HELD,             // Past the horizon, settled or step mode: newest value held
+} cmd_interp_result_t;
+
+class CommandInterpolator {
+public:
+    explicit CommandInterpolator(const cmd_interp_config_t &config);
+
+    // Forget all samples and the clock offset estimate
+    void reset();
+
+    /**
+     * Add one joystick sample.
+     * tx_time_us:   CTU timestamp of the sample
+     * rx_time_us:   local time the carrying frame was received
+     * update_clock: false for samples recovered from a later frame's history,
+     *               whose rx time says nothing about their own transit
+     * settled:      the CTU reported the stick at rest; hold this sample
+     *               instead of extrapolating past it
+     * Samples not newer than the newest one already held are ignored.
+     * Returns true if the sample was accepted.
+     */
+    bool addSample(uint32_t tx_time_us, uint32_t rx_time_us, uint16_t x, uint16_t y, bool update_clock,
+                   bool settled = false);
+
+    /**
+     * Evaluate the command at local time now_us.
+     * Returns CMD_INTERP_RESULT_NONE (x/y untouched) until a sample arrived.
+     */
+    cmd_interp_result_t evaluate(uint32_t now_us, uint16_t &x, uint16_t &y);
+
+    // Number of evaluate() calls per result kind
+    uint32_t resultCount(cmd_interp_result_t result) const;
+
+    const cmd_interp_config_t &config() const { return config_; }
+
+private:
+    struct Sample {
+        int32_t t;      // CTU time relative to base_time_us_
+        float x;
+        float y;
+    };
+
+    float blend(const Sample *s, size_t i, float t, bool axis_y) const;
+    float slope(const Sample *s, size_t a, size_t b, bool axis_y) const;
+    float extrapolate(float dt, bool axis_y) const;
+
+    cmd_interp_config_t config_;
+
+    Sample samples_[CMD_INTERP_HISTORY];    // Oldest first
+    size_t count_;
+    bool newest_settled_;                   // Newest sample came from a settled frame
+    uint32_t base_time_us_;                 // CTU time origin for Sample::t
+
+    bool have_offset_;
+    uint32_t offset_us_;                    // Estimated (local - CTU) clock offset
+    uint32_t window_min_us_;                // Minimum (rx - tx) in the current window
+    uint32_t prev_window_min_us_;           // Minimum of the previous window
+    uint32_t window_samples_;
+
+    uint32_t result_count_[CMD_INTERP_RESULT_HELD + 1];
+};
@@ -0,0 +1,57 @@
+#include <SN_DriveMixer.h>
+
+static constexpr mixer_axis_config_t steering_config = {
+    SN_MIXER_X_NEUTRAL, SN_MIXER_X_DEADBAND, SN_MIXER_X_EXPO_PCT, SN_MIXER_X_SCALE_PCT
+};
+static constexpr mixer_axis_config_t throttle_config = {
+    SN_MIXER_Y_NEUTRAL, SN_MIXER_Y_DEADBAND, SN_MIXER_Y_EXPO_PCT, SN_MIXER_Y_SCALE_PCT
+};
+
+static_assert(SN_MIXER_X_NEUTRAL < MIXER_ADC_RANGE && SN_MIXER_Y_NEUTRAL < MIXER_ADC_RANGE, "mixer neutral out of ADC range");
+static_assert(SN_MIXER_X_EXPO_PCT <= 100 && SN_MIXER_Y_EXPO_PCT <= 100, "mixer expo must be 0..100");
+static_assert(SN_MIXER_X_SCALE_PCT <= 100 && SN_MIXER_Y_SCALE_PCT <= 100, "mixer scale must be 0..100");
+
+// Generated by the compiler, placed in flash
+static constexpr MixerAxisTable steering_table(steering_config);
+static constexpr MixerAxisTable throttle_table(throttle_config);
+
+static_assert(steering_table[SN_MIXER_X_NEUTRAL] == 0, "steering table not centred");
+static_assert(throttle_table[SN_MIXER_Y_NEUTRAL] == 0, "throttle table not centred");
+static_assert(steering_table[MIXER_ADC_RANGE - 1] == MIXER_FULL_SCALE * SN_MIXER_X_SCALE_PCT / 100, "steering table does not reach full scale");
+static_assert(throttle_table[0] == -MIXER_FULL_SCALE * SN_MIXER_Y_SCALE_PCT / 100, "throttle table does not reach full scale");
+
+int16_t SN_DriveMixer_Steering(uint16_t joystick_x) {
+    return steering_table[joystick_x];
+}
+
+int16_t SN_DriveMixer_Throttle(uint16_t joystick_y) {
+    return throttle_table[joystick_y];
+}
+
+// 0.1 % units to percent, rounded half away from zero
+static inline int16_t toPercent(int32_t value) {
+    return (int16_t)((value >= 0 ? value + 5 : value - 5) / 10);
+}
+
+drive_mix_t SN_DriveMixer_MixShaped(int16_t steering, int16_t throttle) {
+    int32_t left = -(int32_t)steering - throttle;
+    int32_t right = -(int32_t)steering + throttle;
+
+    // Desaturate: scale both sides by the same factor so the ratio survives
+    int32_t abs_left = left < 0 ? -left : left;
+    int32_t abs_right = right < 0 ? -right : right;
+    int32_t peak = abs_left > abs_right ? abs_left : abs_right;
+    if (peak > MIXER_FULL_SCALE) {
+        left = left * MIXER_FULL_SCALE / peak;
+        right = right * MIXER_FULL_SCALE / peak;
+    }
+
+    drive_mix_t mix;
+    mix.left = toPercent(left);
+    mix.right = toPercent(right);
+    return mix;
+}
+
+drive_mix_t SN_DriveMixer_Mix(uint16_t joystick_x, uint16_t joystick_y) {
+    return SN_DriveMixer_MixShaped(steering_table[joystick_x], throttle_table[joystick_y]);
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// DIFFERENTIAL-DRIVE MIXER (OBC)
+// ============================================================================
+// Turns the two raw 12-bit joystick ADC values into left/right motor speeds.
+//
+// Each axis goes through a 4096-entry lookup table that is generated at
+// compile time (constexpr) from the axis configuration:
+//   - neutral:  ADC value of the centred stick
+//   - deadband: ADC counts either side of neutral that map to 0
+//   - expo:     0..100 % blend of a cubic curve into the linear response
+//               (finer control near centre, same full-scale output)
+//   - scale:    full-scale output in percent
+// Outside the deadband each half of the axis is normalised separately, so
+// an off-centre neutral still reaches full scale in both directions.
+// Table values are in 0.1 % units (-1000..1000) to keep resolution through
+// the mix; the tables live in flash.
+//
+// Mixing (same sign convention as the original SN_OBC_DrivingHandler):
+//   left  = -steering - throttle
+//   right = -steering + throttle
+// If either side exceeds full scale, both are scaled down by the same
+// factor, so the turn ratio is preserved instead of one side clipping.
+//
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+// X axis: steering (left/right)
+#ifndef SN_MIXER_X_NEUTRAL
+#define SN_MIXER_X_NEUTRAL 2117
+#endif
+#ifndef SN_MIXER_X_DEADBAND
+#define SN_MIXER_X_DEADBAND 50
+#endif
+#ifndef SN_MIXER_X_EXPO_PCT
+#define SN_MIXER_X_EXPO_PCT 0
+#endif
+#ifndef SN_MIXER_X_SCALE_PCT
+#define SN_MIXER_X_SCALE_PCT 100
+#endif
+
+// Y axis: throttle (forward/backward)
+#ifndef SN_MIXER_Y_NEUTRAL
+#define SN_MIXER_Y_NEUTRAL 2000
+#endif
+#ifndef SN_MIXER_Y_DEADBAND
+#define SN_MIXER_Y_DEADBAND 50
+#endif
+#ifndef SN_MIXER_Y_EXPO_PCT
+#define SN_MIXER_Y_EXPO_PCT 0
+#endif
+#ifndef SN_MIXER_Y_SCALE_PCT
+#define SN_MIXER_Y_SCALE_PCT 100
+#endif
+
+#define MIXER_ADC_RANGE 4096        // 12-bit ADC
+#define MIXER_FULL_SCALE 1000       // Table units per 100 %
+
+typedef struct {
+    uint16_t neutral;
+    uint16_t deadband;
+    uint8_t expo_pct;
+    uint8_t scale_pct;
+} mixer_axis_config_t;
+
+typedef struct {
+    int16_t left;       // Percent, -100..100
+    int16_t right;      // Percent, -100..100
+} drive_mix_t;
+
+// One axis response curve, indexed by raw ADC value
+struct MixerAxisTable {
+    int16_t value[MIXER_ADC_RANGE];
+
+    constexpr explicit MixerAxisTable(const mixer_axis_config_t &cfg) : value() {
+        const int neutral = cfg.neutral;
+        const int deadband = cfg.deadband;
+        const float expo = cfg.expo_pct / 100.0f;
+        const float full = (float)MIXER_FULL_SCALE * cfg.scale_pct / 100.0f;
+
+        for (int adc = 0; adc < MIXER_ADC_RANGE; adc++) {
+            int offset = adc - neutral;
+            int magnitude = offset < 0 ? -offset : offset;
+            if (magnitude <= deadband) {
+                value[adc] = 0;
+                continue;
+            }
+            int span = (offset > 0) ? (MIXER_ADC_RANGE - 1 - neutral - deadband) : (neutral - deadband);
+            float x = span > 0 ? (float)(magnitude - deadband) / (float)span : 1.0f;
+            if (x > 1.0f) x = 1.0f;
+            float y = (1.0f - expo) * x + expo * x * x * x;
+            int16_t out = (int16_t)(y * full + 0.5f);
+            value[adc] = (offset > 0) ? out : (int16_t)-out;
+        }
+    }
+
+    constexpr int16_t operator[](uint16_t adc) const {
+        return value[adc < MIXER_ADC_RANGE ? adc : MIXER_ADC_RANGE - 1];
+    }
+};
+
+// Shaped axis values in 0.1 % units (-1000..1000)
+int16_t SN_DriveMixer_Steering(uint16_t joystick_x);
+int16_t SN_DriveMixer_Throttle(uint16_t joystick_y);
+
+// Full mix: raw joystick ADC values to left/right speeds in percent
+drive_mix_t SN_DriveMixer_Mix(uint16_t joystick_x, uint16_t joystick_y);
+
+// Saturation-aware mix of already shaped axis values (0.1 % units)
+drive_mix_t SN_DriveMixer_MixShaped(int16_t steering, int16_t throttle);
@@ -0,0 +1,168 @@
+#include <SN_VelocityControl.h>
+#include <math.h>
+
+static inline float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// ----------------------------------------------------------------------------
+// VelocityController
+// ----------------------------------------------------------------------------
+
+VelocityController::VelocityController(const velocity_pid_config_t &config)
+    : config_(config) {
+    reset();
+}
+
+void VelocityController::reset() {
+    integral_ = 0.0f;
+    saturated_ = false;
+}
+
+float VelocityController::update(float setpoint, float measured, float dt_s) {
+    float error = setpoint - measured;
+    float unclamped = config_.kff * setpoint + config_.kp * error + integral_;
+    float limit = config_.output_limit;
+
+    // Conditional integration: hold the integral while the output is pinned
+    // at a limit and the error would push it further
+    bool pushing_high = unclamped >= limit && error > 0.0f;
+    bool pushing_low = unclamped <= -limit && error < 0.0f;
+    if (!pushing_high && !pushing_low && dt_s > 0.0f) {
+        integral_ = clampf(integral_ + config_.ki * error * dt_s,
+                           -config_.integrator_limit, config_.integrator_limit);
+    }
+
+    float output = config_.kff * setpoint + config_.kp * error + integral_;
+    saturated_ = output > limit || output < -limit;
+
+    // Commanded stop: do not hold the motors against the setpoint with the integral
+    if (setpoint == 0.0f && fabsf(measured) < 1.0f) {
+        integral_ = 0.0f;
+        return 0.0f;
+    }
+    return clampf(output, -limit, limit);
+}
+
+// ----------------------------------------------------------------------------
+// EncoderSpeedFeedback
+// ----------------------------------------------------------------------------
+
+EncoderSpeedFeedback::EncoderSpeedFeedback(float counts_per_s_full)
+    : counts_per_s_full_(counts_per_s_full) {
+    reset();
+}
+
+void EncoderSpeedFeedback::reset() {
+    primed_ = false;
+    last_left_ = 0;
+    last_right_ = 0;
+    speed_ = {0.0f, 0.0f, false};
+}
+
+wheel_speed_t EncoderSpeedFeedback::update(int32_t left_count, int32_t right_count, float dt_s) {
+    if (!primed_ || dt_s <= 0.0f) {
+        last_left_ = left_count;
+        last_right_ = right_count;
+        primed_ = true;
+        return speed_;
+    }
+
+    int32_t dl = (int32_t)((uint32_t)left_count - (uint32_t)last_left_);
+    int32_t dr = (int32_t)((uint32_t)right_count - (uint32_t)last_right_);
+    last_left_ = left_count;
+    last_right_ = right_count;
+
+    float scale = 100.0f / (counts_per_s_full_ * dt_s);
+    speed_.left += VELOCITY_FEEDBACK_ALPHA * ((float)dl * scale - speed_.left);
+    speed_.right += VELOCITY_FEEDBACK_ALPHA * ((float)dr * scale - speed_.right);
+    speed_.valid = true;
+    return speed_;
+}
+
+// ----------------------------------------------------------------------------
+// CurrentYawSpeedEstimator
+// ----------------------------------------------------------------------------
+
+CurrentYawSpeedEstimator::CurrentYawSpeedEstimator(const speed_estimator_config_t &config)
+    : config_(config) {
+    reset();
+}
+
+void CurrentYawSpeedEstimator::reset() {
+    speed_ = {0.0f, 0.0f, false};
+}
+
+wheel_speed_t CurrentYawSpeedEstimator::update(float left_duty, float right_duty, float bus_voltage_v,
+                                               float bus_current_a, float yaw_rate_dps) {
+    // Split into translation (sides opposite in the mirrored duty frame) and rotation (same sign)
+    float translation_cmd = (right_duty - left_duty) * 0.5f;
+
+    // Translation, DC motor model: speed = applied voltage - I * R.
+    // The bus sees the motor current scaled by duty, so the per-percent drop
+    // is the bus current above idle divided by the summed duty.
+    float applied = fabsf(translation_cmd) * bus_voltage_v / config_.nominal_bus_v;
+    float duty_sum = (fabsf(left_duty) + fabsf(right_duty)) / 100.0f;
+    float droop = 0.0f;
+    if (duty_sum > 0.01f) {
+        float motor_current = (bus_current_a - config_.idle_current_a) / duty_sum;
+        droop = clampf(motor_current / config_.amps_per_pct, 0.0f, applied);
+    }
+    float translation = (translation_cmd < 0.0f) ? -(applied - droop) : (applied - droop);
+
+    // Rotation: measured directly by the gyro
+    float rotation = clampf(yaw_rate_dps / config_.full_yaw_dps * 100.0f, -100.0f, 100.0f);
+
+    float left = rotation - translation;
+    float right = rotation + translation;
+    speed_.left += VELOCITY_FEEDBACK_ALPHA * (left - speed_.left);
+    speed_.right += VELOCITY_FEEDBACK_ALPHA * (right - speed_.right);
+    speed_.valid = true;
+    return speed_;
+}
+
+// ----------------------------------------------------------------------------
+// DiffDrivePlant
+// ----------------------------------------------------------------------------
+
+DiffDrivePlant::DiffDrivePlant(const diff_drive_plant_config_t &config)
+    : config_(config) {
+    reset();
+}
+
+void DiffDrivePlant::reset() {
+    bus_v_ = config_.nominal_bus_v;
+    left_ = 0.0f;
+    right_ = 0.0f;
+    left_count_ = 0.0;
+    right_count_ = 0.0;
+    bus_current_ = config_.idle_current_a;
+}
+
+void DiffDrivePlant::step(float left_duty, float right_duty, float dt_s) {
+    float v_ratio = bus_v_ / config_.nominal_bus_v;
+    float alpha = clampf(dt_s / config_.tau_s, 0.0f, 1.0f);
+    float current = config_.idle_current_a;
+
+    float *speeds[2] = { &left_, &right_ };
+    float duties[2] = { left_duty, right_duty };
+    for (int i = 0; i < 2; i++) {
+        float applied = duties[i] * v_ratio;    // Percent of nominal voltage
+        float &speed = *speeds[i];
+
+        // Drag opposes motion; it cannot reverse a wheel on its own
+        float target = applied;
+        if (applied > config_.drag_pct) target = applied - config_.drag_pct;
+        else if (applied < -config_.drag_pct) target = applied + config_.drag_pct;
+        else target = 0.0f;
+
+        speed += alpha * (target - speed);
+
+        // Bus current: motor current (applied - back-EMF) scaled by duty
+        current += config_.current_per_pct_a * fabsf(applied - speed) * fabsf(duties[i]) / 100.0f;
+    }
+
+    left_count_ += (double)left_ / 100.0 * config_.counts_per_s_full * dt_s;
+    right_count_ += (double)right_ / 100.0 * config_.counts_per_s_full * dt_s;
+    bus_current_ = current;
+}
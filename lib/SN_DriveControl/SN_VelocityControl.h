@@ -0,0 +1,191 @@
+#pragma once
+#include <stdint.h>
+
+// ============================================================================
+// CLOSED-LOOP PER-SIDE VELOCITY CONTROL (OBC)
+// ============================================================================
+// Open-loop duty makes speed depend on battery voltage and load. With
+// velocity control the mixer output is taken as a wheel speed setpoint
+// (percent of full speed) and each side runs a feedforward + PI loop:
+//
+//   duty = kff * setpoint + kp * error + integral
+//
+// Anti-windup: the integral is clamped to +-integrator_limit, and it stops
+// integrating while the output is saturated in the direction of the error.
+//
+// Speeds are signed per side in the motor duty frame used by the mixer
+// (left = -steering - throttle, right = -steering + throttle), so the
+// sides are mirrored: driving straight ahead is left < 0, right > 0.
+//
+// Feedback sources (any of them feeds wheel_speed_t into the controllers):
+//   - EncoderSpeedFeedback:     wheel encoder counts, when encoders are fitted
+//                               (SN_WheelEncoders_GetCounts; its weak default
+//                               in SN_Handler.cpp returns false, i.e. open loop)
+//   - CurrentYawSpeedEstimator: no encoders; translation from a DC motor
+//                               model (duty x Main_Bus_V minus the I*R drop
+//                               implied by Main_Bus_I), rotation from the
+//                               IMU yaw rate. Its inputs are sampled by the
+//                               sensor task, so call it once per sensor
+//                               period with the mean duty the motors ran
+//                               at (after the ramp) over that period.
+// DiffDrivePlant is a first-order model of the drivetrain that produces the
+// same signals (encoder counts, bus current, yaw rate) for tuning the gains
+// and regression-checking the loop on the host.
+//
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_VELOCITY_CONTROL_MODE
+#define SN_VELOCITY_CONTROL_MODE 0      // 0 = open loop, 1 = wheel encoders (needs a driver), 2 = bus current + yaw rate estimate
+#endif
+
+#ifndef SN_VELOCITY_KP
+#define SN_VELOCITY_KP 0.6f
+#endif
+#ifndef SN_VELOCITY_KI
+#define SN_VELOCITY_KI 4.0f             // Per second
+#endif
+#ifndef SN_VELOCITY_KFF
+#define SN_VELOCITY_KFF 1.0f
+#endif
+#ifndef SN_VELOCITY_I_LIMIT
+#define SN_VELOCITY_I_LIMIT 40.0f       // Percent duty
+#endif
+
+// Encoder feedback
+#ifndef SN_ENCODER_COUNTS_PER_S_FULL
+#define SN_ENCODER_COUNTS_PER_S_FULL 3000.0f    // Counts per second at 100 % wheel speed
+#endif
+
+// Estimator feedback
+#ifndef SN_ESTIMATOR_NOMINAL_BUS_V
+#define SN_ESTIMATOR_NOMINAL_BUS_V 12.6f        // Bus voltage at which 100 % duty gives 100 % speed
+#endif
+#ifndef SN_ESTIMATOR_AMPS_PER_PCT
+#define SN_ESTIMATOR_AMPS_PER_PCT 0.15f         // Motor current per percent of (applied - back-EMF), one side
+#endif
+#ifndef SN_ESTIMATOR_IDLE_CURRENT_A
+#define SN_ESTIMATOR_IDLE_CURRENT_A 0.3f        // Main bus current with the motors stopped
+#endif
+#ifndef SN_ESTIMATOR_FULL_YAW_DPS
+#define SN_ESTIMATOR_FULL_YAW_DPS 360.0f        // Yaw rate spinning in place at 100 % (negate to flip the gyro sign)
+#endif
+
+#define VELOCITY_FEEDBACK_ALPHA 0.3f            // Low-pass weight of a new speed measurement
+
+typedef struct {
+    float kp;
+    float ki;                   // 1/s
+    float kff;
+    float integrator_limit;     // Percent duty
+    float output_limit;         // Percent duty
+} velocity_pid_config_t;
+
+// Measured or estimated wheel speeds in percent of full speed
+typedef struct {
+    float left;
+    float right;
+    bool valid;
+} wheel_speed_t;
+
+class VelocityController {
+public:
+    explicit VelocityController(const velocity_pid_config_t &config);
+
+    void reset();
+
+    // One control tick: returns the duty (percent) for this side
+    float update(float setpoint, float measured, float dt_s);
+
+    float integral() const { return integral_; }
+    bool saturated() const { return saturated_; }
+    const velocity_pid_config_t &config() const { return config_; }
+
+private:
+    velocity_pid_config_t config_;
+    float integral_;
+    bool saturated_;
+};
+
+class EncoderSpeedFeedback {
+public:
+    explicit EncoderSpeedFeedback(float counts_per_s_full);
+
+    void reset();
+
+    // Cumulative encoder counts (wrap-safe); first call only primes the filter
+    wheel_speed_t update(int32_t left_count, int32_t right_count, float dt_s);
+
+private:
+    float counts_per_s_full_;
+    bool primed_;
+    int32_t last_left_;
+    int32_t last_right_;
+    wheel_speed_t speed_;
+};
+
+typedef struct {
+    float nominal_bus_v;
+    float amps_per_pct;
+    float idle_current_a;
+    float full_yaw_dps;
+} speed_estimator_config_t;
+
+class CurrentYawSpeedEstimator {
+public:
+    explicit CurrentYawSpeedEstimator(const speed_estimator_config_t &config);
+
+    void reset();
+
+    /**
+     * left_duty/right_duty: mean duty applied to the motors since the last update (percent)
+     * bus_voltage_v:        Main_Bus_V
+     * bus_current_a:        Main_Bus_I
+     * yaw_rate_dps:         IMU yaw rate, positive when both sides run positive
+     */
+    wheel_speed_t update(float left_duty, float right_duty, float bus_voltage_v,
+                         float bus_current_a, float yaw_rate_dps);
+
+private:
+    speed_estimator_config_t config_;
+    wheel_speed_t speed_;
+};
+
+typedef struct {
+    float tau_s;                // Wheel speed time constant
+    float nominal_bus_v;        // Voltage at which 100 % duty gives 100 % speed
+    float drag_pct;             // Constant load, percent speed lost while moving
+    float current_per_pct_a;    // Motor current per percent of (applied - back-EMF)
+    float idle_current_a;       // Electronics
+    float counts_per_s_full;    // Encoder counts per second at 100 % speed
+    float full_yaw_dps;         // Yaw rate spinning in place at 100 %
+} diff_drive_plant_config_t;
+
+class DiffDrivePlant {
+public:
+    explicit DiffDrivePlant(const diff_drive_plant_config_t &config);
+
+    void reset();
+    void setBusVoltage(float volts) { bus_v_ = volts; }
+    void setDrag(float drag_pct) { config_.drag_pct = drag_pct; }
+
+    // Advance the model by dt_s with the given duties (percent)
+    void step(float left_duty, float right_duty, float dt_s);
+
+    float leftSpeed() const { return left_; }
+    float rightSpeed() const { return right_; }
+    int32_t leftCount() const { return (int32_t)left_count_; }
+    int32_t rightCount() const { return (int32_t)right_count_; }
+    float busCurrent() const { return bus_current_; }
+    float yawRate() const { return config_.full_yaw_dps * (left_ + right_) * 0.5f / 100.0f; }
+
+private:
+    diff_drive_plant_config_t config_;
+    float bus_v_;
+    float left_;
+    float right_;
+    double left_count_;
+    double right_count_;
+    float bus_current_;
+};
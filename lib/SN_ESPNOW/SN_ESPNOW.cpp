@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <atomic>
 #include <esp_now.h>
 #include <Wire.h>
 #include <SN_ESPNOW.h>
@@ -6,30 +7,68 @@
 // #include <SN_Common.h>
 #include <SN_StatusPanel.h> // Include for LED_State and SN_StatusPanel__SetStatusLedState
 #include <SN_Handler.h>
+#include <SN_SPSC_Queue.h>
+#include <SN_LinkStats.h>
+#include <SN_Trace.h>
+#include <SN_RuntimeStats.h>
 #include <SN_WiFi.h>
 #include <SN_XR_Board_Types.h>
 #include <SN_Motors.h>
-#include <SN_Handler.h>
 
 extern xr4_system_context_t xr4_system_context;
 
 esp_now_peer_info_t peerInfo;
 
+// Rolling sequence number for frames sent by this board. Each board only
+// transmits in one direction, so one counter covers the whole outgoing link.
+// Atomic because the OBC also sends pong replies from the WiFi task.
+static std::atomic<uint16_t> tx_seq(0);
+
+// Header metadata for the next outgoing frame
+static sn_wire_meta_t nextTxMeta() {
+  sn_wire_meta_t meta;
+  meta.seq = tx_seq.fetch_add(1);
+  meta.tx_time_us = (uint32_t)esp_timer_get_time();
+  return meta;
+}
+
 
 
 #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
   // REPLACE WITH THE MAC OF THE CONTROL & TELEMETRY UNIT (CTU)
   uint8_t broadcastAddress[] = {0x24, 0x0a, 0xc4, 0xc0, 0xf1, 0xec}; //{0x24, 0x0a, 0xc4, 0xc0, 0xe5, 0x78}; // MAC Address of the receiver (SN_XR4_CTU_ESP32 - Control/Telemetry Unit)
 
-  bool OBC_TC_received_data_ready = false;
   uint8_t OBC_TC_last_received_data_type = 0;
 
+  // Telecommand mailbox: OnTelecommandReceive (WiFi task) is the only producer,
+  // the OBC control task (SN_OBC_ControlStep) is the only consumer
+  #define TC_MAILBOX_DEPTH 8
+  static SN_SPSC_Queue<telecommand_mailbox_entry_t, TC_MAILBOX_DEPTH> OBC_TC_mailbox;
+  static uint32_t OBC_TC_rx_seq = 0;          // Written by the producer only
+  // Switch flags of the newest live telecommand. Stored before every push, so
+  // an E-STOP/ARM change still reaches the control task when the mailbox is
+  // full and the entry carrying it is dropped.
+  static std::atomic<uint16_t> OBC_TC_latest_flags(0);
+
+  // Uplink (CTU --> OBC) statistics, fed by OnTelecommandReceive
+  static LinkStats OBC_TC_link_stats;
+
+  // Newest telecommand sequence number handed to the control task (WiFi task only)
+  static bool OBC_TC_have_applied_seq = false;
+  static uint16_t OBC_TC_last_applied_seq = 0;
+  // A sequence number this far behind the last applied one means the CTU restarted
+  #define TC_SEQ_RESYNC_WINDOW 1000
+
+  // Telecommands recovered from redundant-frame history
+  static uint32_t OBC_TC_replayed_count = 0;
+
   // OBC struct_message to hold outgoing telemetry data (OBC --> CTU)
   telemetry_GPS_data_t OBC_out_TM_GPS_data;
   telemetry_IMU_data_t OBC_out_TM_IMU_data;
   telemetry_HK_data_t OBC_out_TM_HK_data;
 
-  // OBC struct_message to hold incoming telecommand data (CTU --> OBC)
+  // Last telecommand decoded by OnTelecommandReceive. Only touched on the WiFi
+  // task; the control task gets its copy through OBC_TC_mailbox.
   telecommand_data_t OBC_in_telecommand_data;
 
   #define NUM_TM_MSG_TYPES 3
@@ -50,17 +89,43 @@ esp_now_peer_info_t peerInfo;
   // Last sent timestamps for each message type (in microseconds)
   static uint64_t last_sent_time_us[NUM_TM_MSG_TYPES] = {0};
 
+#if SN_ESPNOW_TM_SUPERFRAME == 1
+  // Superframe section bit for each message type (same order as telemetry_msg_types)
+  static const uint8_t telemetry_section_bits[NUM_TM_MSG_TYPES] = {
+    SN_WIRE_SECTION_GPS,
+    SN_WIRE_SECTION_IMU,
+    SN_WIRE_SECTION_HK
+  };
+
+  // An unchanged section is still re-sent after this long so the CTU never goes stale
+  #define TM_SECTION_KEEPALIVE_MS 1000
+
+  // Last time each section was actually transmitted (in microseconds)
+  static uint64_t last_tx_time_us[NUM_TM_MSG_TYPES] = {0};
+
+  // Encoded copy of each section as last transmitted, for change detection.
+  // Comparing the fixed-point encoding ignores noise below wire resolution.
+  static uint8_t last_tx_section[NUM_TM_MSG_TYPES][SN_WIRE_MAX_FRAME_LEN];
+  static size_t last_tx_section_len[NUM_TM_MSG_TYPES] = {0};
+#else
   // Static index for rotating through message types
   static uint8_t current_tm_index = 0;
+#endif
 
 
 #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
   // REPLACE WITH THE MAC OF THE ON-BOARD COMPUTER UNIT (OBC)
   uint8_t broadcastAddress[] = {0x24, 0x0a, 0xc4, 0xbf, 0x9a, 0xe0}; // MAC Address of the receiver (SN_XR4_OBC_ESP32 - On-Board Computer Unit on the XR4 Rover)
 
-  bool CTU_TM_received_data_ready = false;
   uint8_t CTU_TM_last_received_data_type = 0;
 
+  // Sections (SN_WIRE_SECTION_*) decoded by OnTelemetryReceive but not yet
+  // applied to the system context. Set on the WiFi task, consumed on the loop task.
+  static std::atomic<uint8_t> CTU_TM_pending_sections(0);
+
+  // Set by the first decoded HK section; until then CTU_in_TM_HK_data is all zero
+  static std::atomic<bool> CTU_TM_HK_received(false);
+
   // CTU struct_message to hold outgoing telecommand data (CTU --> OBC)
   telecommand_data_t CTU_out_telecommand_data;
 
@@ -78,6 +143,19 @@ esp_now_peer_info_t peerInfo;
   static uint32_t telecommand_packets_sent = 0;
   static uint32_t telecommand_send_failures = 0;
 
+  // Downlink (OBC --> CTU) statistics, fed by OnTelemetryReceive
+  static LinkStats CTU_TM_link_stats;
+
+  // Round-trip time of TC_PING_MSG --> TM_PONG_MSG
+  static LatencyHistogram CTU_RTT_histogram;
+
+#if SN_ESPNOW_TC_REDUNDANCY > 0
+  static_assert(SN_ESPNOW_TC_REDUNDANCY <= TELECOMMAND_HISTORY_MAX, "SN_ESPNOW_TC_REDUNDANCY too large");
+
+  // Last SN_ESPNOW_TC_REDUNDANCY telecommands sent, oldest first
+  static telecommand_history_t CTU_TC_history = {};
+#endif
+
 #endif
 
 // Variable to store if sending data was successful
@@ -217,6 +295,77 @@ bool SN_ESPNOW_add_peer(){
 // ----------------- Data Send Functions -----------------
 #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
 
+#if SN_ESPNOW_TM_SUPERFRAME == 1
+
+// Encode one section on its own so it can be compared with what was last sent.
+// The header metadata is zeroed so only the payload takes part in the comparison.
+static size_t encodeSection(uint8_t index, uint8_t *buf, size_t buf_len) {
+  const sn_wire_meta_t meta = {0, 0};
+  switch (telemetry_msg_types[index]) {
+    case TM_GPS_DATA_MSG: return SN_Wire_EncodeTelemetryGPS(OBC_out_TM_GPS_data, meta, buf, buf_len);
+    case TM_IMU_DATA_MSG: return SN_Wire_EncodeTelemetryIMU(OBC_out_TM_IMU_data, meta, buf, buf_len);
+    case TM_HK_DATA_MSG:  return SN_Wire_EncodeTelemetryHK(OBC_out_TM_HK_data, meta, buf, buf_len);
+    default:              return 0;
+  }
+}
+
+void SN_ESPNOW_SendTelemetry(void) {
+  uint64_t now_us = esp_timer_get_time(); // Get current time in microseconds
+
+  // Find sections whose interval has expired
+  bool any_due = false;
+  for (uint8_t i = 0; i < NUM_TM_MSG_TYPES; i++) {
+    if ((now_us - last_sent_time_us[i]) / 1000 >= telemetry_intervals_ms[i]) {
+      any_due = true;
+      break;
+    }
+  }
+  if (!any_due) return;
+
+  SN_Telemetry_updateStruct(xr4_system_context);
+
+  // A due section goes out only if its data changed or its keep-alive expired
+  uint8_t section_mask = 0;
+  uint8_t encoded[NUM_TM_MSG_TYPES][SN_WIRE_MAX_FRAME_LEN];
+  size_t encoded_len[NUM_TM_MSG_TYPES] = {0};
+
+  for (uint8_t i = 0; i < NUM_TM_MSG_TYPES; i++) {
+    if ((now_us - last_sent_time_us[i]) / 1000 < telemetry_intervals_ms[i]) continue;
+    last_sent_time_us[i] = now_us;  // Restart interval whether or not it is sent
+
+    encoded_len[i] = encodeSection(i, encoded[i], sizeof(encoded[i]));
+    bool changed = encoded_len[i] != last_tx_section_len[i] ||
+                   memcmp(encoded[i], last_tx_section[i], encoded_len[i]) != 0;
+    bool keepalive_expired = (now_us - last_tx_time_us[i]) / 1000 >= TM_SECTION_KEEPALIVE_MS;
+
+    if (changed || keepalive_expired) {
+      section_mask |= telemetry_section_bits[i];
+    }
+  }
+  if (section_mask == 0) return;
+
+  uint8_t frame[SN_WIRE_MAX_FRAME_LEN];
+  size_t frame_len = SN_Wire_EncodeTelemetrySuperframe(section_mask,
+                                                       OBC_out_TM_GPS_data,
+                                                       OBC_out_TM_IMU_data,
+                                                       OBC_out_TM_HK_data,
+                                                       nextTxMeta(),
+                                                       frame, sizeof(frame));
+  if (frame_len == 0) return;
+
+  if (esp_now_send(broadcastAddress, frame, frame_len) == ESP_OK) {
+    for (uint8_t i = 0; i < NUM_TM_MSG_TYPES; i++) {
+      if (section_mask & telemetry_section_bits[i]) {
+        memcpy(last_tx_section[i], encoded[i], encoded_len[i]);
+        last_tx_section_len[i] = encoded_len[i];
+        last_tx_time_us[i] = now_us;
+      }
+    }
+  }
+}
+
+#else
+
 void SN_ESPNOW_SendTelemetry(void) {
   // Use current_tm_index (0, 1, 2) to access the arrays properly
   telemetry_message_type_id_t msg_type = telemetry_msg_types[current_tm_index];
@@ -229,21 +378,28 @@ void SN_ESPNOW_SendTelemetry(void) {
       SN_Telemetry_updateStruct(xr4_system_context);
       esp_err_t result;
 
+      // Encode into the packed wire format (no struct padding on the air)
+      uint8_t frame[SN_WIRE_MAX_FRAME_LEN];
+      size_t frame_len = 0;
+
+      sn_wire_meta_t meta = nextTxMeta();
+
       switch (msg_type) {
           case TM_GPS_DATA_MSG:
-              result = esp_now_send(broadcastAddress, (uint8_t *)&OBC_out_TM_GPS_data, sizeof(telemetry_GPS_data_t));
+              frame_len = SN_Wire_EncodeTelemetryGPS(OBC_out_TM_GPS_data, meta, frame, sizeof(frame));
               break;
           case TM_IMU_DATA_MSG:
-              result = esp_now_send(broadcastAddress, (uint8_t *)&OBC_out_TM_IMU_data, sizeof(telemetry_IMU_data_t));
+              frame_len = SN_Wire_EncodeTelemetryIMU(OBC_out_TM_IMU_data, meta, frame, sizeof(frame));
               break;
           case TM_HK_DATA_MSG:
-              result = esp_now_send(broadcastAddress, (uint8_t *)&OBC_out_TM_HK_data, sizeof(telemetry_HK_data_t));
+              frame_len = SN_Wire_EncodeTelemetryHK(OBC_out_TM_HK_data, meta, frame, sizeof(frame));
               break;
           default:
-              result = ESP_FAIL;
               break;
       }
 
+      result = (frame_len > 0) ? esp_now_send(broadcastAddress, frame, frame_len) : ESP_FAIL;
+
       if (result == ESP_OK) {
           last_sent_time_us[current_tm_index] = now_us; // Update last sent time using INDEX
       }
@@ -253,16 +409,52 @@ void SN_ESPNOW_SendTelemetry(void) {
   current_tm_index = (current_tm_index + 1) % NUM_TM_MSG_TYPES;
 }
 
+#endif // SN_ESPNOW_TM_SUPERFRAME
+
 #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 void SN_ESPNOW_SendTelecommand(uint8_t TC_out_msg_type){
-    // Send message via ESP-NOW
-    SN_Telecommand_updateStruct(xr4_system_context);
-
-    esp_err_t result;
+    // Send message via ESP-NOW. CTU_out_telecommand_data is built by the CTU
+    // handler (SN_Telecommand_updateStruct) and then marked by the send
+    // policy (settled bit); rebuilding it here would drop those marks.
 
     if(TC_out_msg_type == TC_C2_DATA_MSG){
-      result = esp_now_send(broadcastAddress, (uint8_t *) &CTU_out_telecommand_data, sizeof(telecommand_data_t));
-      telecommand_packets_sent++;  // Diagnostic counter
+      uint8_t frame[SN_WIRE_MAX_FRAME_LEN];
+      sn_wire_meta_t meta = nextTxMeta();
+#if SN_ESPNOW_TC_REDUNDANCY > 0
+      // Repeat the previous telecommands so the OBC can recover any it lost
+      size_t frame_len = SN_Wire_EncodeTelecommandRedundant(CTU_out_telecommand_data, CTU_TC_history,
+                                                            meta, frame, sizeof(frame));
+#else
+      size_t frame_len = SN_Wire_EncodeTelecommand(CTU_out_telecommand_data, meta, frame, sizeof(frame));
+#endif
+      if (frame_len > 0) {
+        esp_now_send(broadcastAddress, frame, frame_len);
+        telecommand_packets_sent++;  // Diagnostic counter
+        SN_TRACE_INSTANT("tc_send", meta.seq);
+      }
+
+#if SN_ESPNOW_TC_REDUNDANCY > 0
+      // Remember this telecommand for the next frames' history
+      if (CTU_TC_history.count == SN_ESPNOW_TC_REDUNDANCY) {
+        memmove(&CTU_TC_history.samples[0], &CTU_TC_history.samples[1],
+                (SN_ESPNOW_TC_REDUNDANCY - 1) * sizeof(telecommand_sample_t));
+        CTU_TC_history.count--;
+      }
+      telecommand_sample_t &sample = CTU_TC_history.samples[CTU_TC_history.count++];
+      sample.Seq = meta.seq;
+      sample.Tx_Time_us = meta.tx_time_us;
+      sample.Joystick_X = CTU_out_telecommand_data.Joystick_X;
+      sample.Joystick_Y = CTU_out_telecommand_data.Joystick_Y;
+      sample.flags = CTU_out_telecommand_data.flags;
+#endif
+    }
+    else if(TC_out_msg_type == TC_PING_MSG){
+      // The OBC echoes the header's seq/timestamp back in a TM_PONG_MSG
+      uint8_t frame[SN_WIRE_MAX_FRAME_LEN];
+      size_t frame_len = SN_Wire_EncodePing(nextTxMeta(), frame, sizeof(frame));
+      if (frame_len > 0) {
+        esp_now_send(broadcastAddress, frame, frame_len);
+      }
     }
 }
 #endif
@@ -315,6 +507,15 @@ void SN_Telemetry_updateStruct(xr4_system_context_t context){
   OBC_out_TM_HK_data.Bus_3V3 = context.Bus_3V3;
   OBC_out_TM_HK_data.OBC_RSSI = context.OBC_RSSI;
   OBC_out_TM_HK_data.temp = context.temp;
+  OBC_out_TM_HK_data.TC_Loss_Permille = OBC_TC_link_stats.lossPermille();
+
+  const runtime_stats_summary_t &runtime = SN_RuntimeStats_GetSummary();
+  OBC_out_TM_HK_data.CPU_Load_Core0 = runtime.cpu_load_pct[0];
+  OBC_out_TM_HK_data.CPU_Load_Core1 = runtime.cpu_load_pct[1];
+  OBC_out_TM_HK_data.Min_Stack_Free = runtime.min_stack_free > UINT16_MAX ? UINT16_MAX : (uint16_t)runtime.min_stack_free;
+  OBC_out_TM_HK_data.Heap_Free_KB = (uint16_t)(runtime.heap_free / 1024);
+  OBC_out_TM_HK_data.Heap_Min_Free_KB = (uint16_t)(runtime.heap_min_free / 1024);
+  OBC_out_TM_HK_data.Heap_Largest_KB = (uint16_t)(runtime.heap_largest_block / 1024);
 }
 
 #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
@@ -337,65 +538,101 @@ void SN_Telecommand_updateStruct(xr4_system_context_t context){
 // ----------------- Update OBC Context with Received Telecommand -----------------
 #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
 
-// PERFORMANCE CRITICAL: This function is called every main loop iteration
+// PERFORMANCE CRITICAL: This function is called every control task cycle
 // Optimized for minimum latency by eliminating unnecessary operations
-void SN_Telecommand_updateContext(const telecommand_data_t& OBC_in_telecommand_data){
-  if(OBC_TC_received_data_ready) {
-    // Direct assignment - no switch needed for single message type
-    xr4_system_context.Command = OBC_in_telecommand_data.Command;
-    xr4_system_context.Joystick_X = OBC_in_telecommand_data.Joystick_X;
-    xr4_system_context.Joystick_Y = OBC_in_telecommand_data.Joystick_Y;
-    xr4_system_context.Encoder_Pos = OBC_in_telecommand_data.Encoder_Pos;
-    xr4_system_context.CTU_RSSI = OBC_in_telecommand_data.CTU_RSSI;
-
-    // Inline flag extraction - faster than function calls
-    uint16_t flags = OBC_in_telecommand_data.flags;
-    xr4_system_context.Emergency_Stop = (flags >> EMERGENCY_STOP_BIT) & 1;
-    xr4_system_context.Armed = (flags >> ARMED_BIT) & 1;
-    xr4_system_context.Headlights_On = (flags >> HEADLIGHTS_ON_BIT) & 1;
-    xr4_system_context.Buzzer = (flags >> BUZZER_BIT) & 1;
-    xr4_system_context.Button_A = (flags >> BUTTON_A_BIT) & 1;
-    xr4_system_context.Button_B = (flags >> BUTTON_B_BIT) & 1;
-    xr4_system_context.Button_C = (flags >> BUTTON_C_BIT) & 1;
-    xr4_system_context.Button_D = (flags >> BUTTON_D_BIT) & 1;
-    
-    OBC_TC_received_data_ready = false;
+bool SN_ESPNOW_ConsumeTelecommand(telecommand_mailbox_entry_t &entry){
+  // Drain the mailbox and keep only the newest telecommand
+  bool received = false;
+  while (OBC_TC_mailbox.pop(entry)) {
+    received = true;
+  }
+  if (received) {
+    entry.data.flags = SN_ESPNOW_GetLatestTelecommandFlags();
   }
+  return received;
+}
+
+bool SN_ESPNOW_PopTelecommand(telecommand_mailbox_entry_t &entry){
+  return OBC_TC_mailbox.pop(entry);
+}
+
+uint16_t SN_ESPNOW_GetLatestTelecommandFlags(){
+  return OBC_TC_latest_flags.load(std::memory_order_acquire);
+}
+
+uint32_t SN_ESPNOW_GetTelecommandMailboxOverflows(){
+  return OBC_TC_mailbox.overflows();
+}
+
+const LinkStats& SN_ESPNOW_GetTelecommandLinkStats(){
+  return OBC_TC_link_stats;
+}
+
+uint32_t SN_ESPNOW_GetTelecommandReplays(){
+  return OBC_TC_replayed_count;
+}
+
+bool SN_Telecommand_updateContext(){
+  telecommand_mailbox_entry_t entry;
+  if (!SN_ESPNOW_ConsumeTelecommand(entry)) {
+    return false;
+  }
+
+  SN_Telecommand_applyToContext(entry.data);
+  return true;
+}
+
+void SN_Telecommand_applyToContext(const telecommand_data_t &tc){
+
+  // Direct assignment - no switch needed for single message type
+  xr4_system_context.Command = tc.Command;
+  xr4_system_context.Joystick_X = tc.Joystick_X;
+  xr4_system_context.Joystick_Y = tc.Joystick_Y;
+  xr4_system_context.Encoder_Pos = tc.Encoder_Pos;
+  xr4_system_context.CTU_RSSI = tc.CTU_RSSI;
+
+  // Inline flag extraction - faster than function calls
+  uint16_t flags = tc.flags;
+  xr4_system_context.Emergency_Stop = (flags >> EMERGENCY_STOP_BIT) & 1;
+  xr4_system_context.Armed = (flags >> ARMED_BIT) & 1;
+  xr4_system_context.Headlights_On = (flags >> HEADLIGHTS_ON_BIT) & 1;
+  xr4_system_context.Buzzer = (flags >> BUZZER_BIT) & 1;
+  xr4_system_context.Button_A = (flags >> BUTTON_A_BIT) & 1;
+  xr4_system_context.Button_B = (flags >> BUTTON_B_BIT) & 1;
+  xr4_system_context.Button_C = (flags >> BUTTON_C_BIT) & 1;
+  xr4_system_context.Button_D = (flags >> BUTTON_D_BIT) & 1;
 }
 
 #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 
-void SN_Telemetry_updateContext(uint8_t CTU_TM_last_received_data_type){
-  if(CTU_TM_received_data_ready){
-    switch(CTU_TM_last_received_data_type)
-    {
-      case TM_GPS_DATA_MSG:
-        xr4_system_context.GPS_lat = CTU_in_TM_GPS_data.GPS_lat;
-        xr4_system_context.GPS_lon = CTU_in_TM_GPS_data.GPS_lon;
-        xr4_system_context.GPS_time = CTU_in_TM_GPS_data.GPS_time;
-        break;
-
-      case TM_IMU_DATA_MSG:
-        // Update orientation data (heading, pitch, roll)
-        xr4_system_context.Heading_Degrees = CTU_in_TM_IMU_data.Heading_Degrees;
-        strncpy(xr4_system_context.Heading_Cardinal, CTU_in_TM_IMU_data.Heading_Cardinal, 2);
-        xr4_system_context.Heading_Cardinal[2] = '\0';
-        xr4_system_context.Pitch_Degrees = CTU_in_TM_IMU_data.Pitch_Degrees;
-        xr4_system_context.Roll_Degrees = CTU_in_TM_IMU_data.Roll_Degrees;
-        break;
-
-      case TM_HK_DATA_MSG:
-        xr4_system_context.Main_Bus_V = CTU_in_TM_HK_data.Main_Bus_V;
-        xr4_system_context.Main_Bus_I = CTU_in_TM_HK_data.Main_Bus_I;
-        xr4_system_context.Bus_5V = CTU_in_TM_HK_data.Bus_5V;
-        xr4_system_context.Bus_3V3 = CTU_in_TM_HK_data.Bus_3V3;
-        xr4_system_context.temp = CTU_in_TM_HK_data.temp;
-        xr4_system_context.OBC_RSSI = CTU_in_TM_HK_data.OBC_RSSI;
-        break;
-    }
-    CTU_TM_received_data_ready = false;
+void SN_Telemetry_updateContext(){
+  // Atomically take every section received since the last call
+  uint8_t pending = CTU_TM_pending_sections.exchange(0);
+
+  if (pending & SN_WIRE_SECTION_GPS) {
+    xr4_system_context.GPS_lat = CTU_in_TM_GPS_data.GPS_lat;
+    xr4_system_context.GPS_lon = CTU_in_TM_GPS_data.GPS_lon;
+    xr4_system_context.GPS_time = CTU_in_TM_GPS_data.GPS_time;
+    xr4_system_context.GPS_fix = CTU_in_TM_GPS_data.GPS_fix;
   }
 
+  if (pending & SN_WIRE_SECTION_IMU) {
+    // Update orientation data (heading, pitch, roll)
+    xr4_system_context.Heading_Degrees = CTU_in_TM_IMU_data.Heading_Degrees;
+    strncpy(xr4_system_context.Heading_Cardinal, CTU_in_TM_IMU_data.Heading_Cardinal, 2);
+    xr4_system_context.Heading_Cardinal[2] = '\0';
+    xr4_system_context.Pitch_Degrees = CTU_in_TM_IMU_data.Pitch_Degrees;
+    xr4_system_context.Roll_Degrees = CTU_in_TM_IMU_data.Roll_Degrees;
+  }
+
+  if (pending & SN_WIRE_SECTION_HK) {
+    xr4_system_context.Main_Bus_V = CTU_in_TM_HK_data.Main_Bus_V;
+    xr4_system_context.Main_Bus_I = CTU_in_TM_HK_data.Main_Bus_I;
+    xr4_system_context.Bus_5V = CTU_in_TM_HK_data.Bus_5V;
+    xr4_system_context.Bus_3V3 = CTU_in_TM_HK_data.Bus_3V3;
+    xr4_system_context.temp = CTU_in_TM_HK_data.temp;
+    xr4_system_context.OBC_RSSI = CTU_in_TM_HK_data.OBC_RSSI;
+  }
 }
 
 #endif
@@ -404,61 +641,111 @@ void SN_Telemetry_updateContext(uint8_t CTU_TM_last_received_data_type){
 // ---------------- Data Receive Callbacks ----------------
 // Callback when data is received
 #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
+
+// True if seq is newer than every telecommand already handed to the main
+// loop (and records it as the newest). Called on the WiFi task only.
+static bool acceptTelecommandSeq(uint16_t seq) {
+  int16_t delta = (int16_t)(uint16_t)(seq - OBC_TC_last_applied_seq);
+  if (OBC_TC_have_applied_seq && delta <= 0 && delta > -TC_SEQ_RESYNC_WINDOW) {
+    return false;
+  }
+  OBC_TC_have_applied_seq = true;
+  OBC_TC_last_applied_seq = seq;
+  return true;
+}
+
+// Hand a complete copy to the control task (dropped if it has fallen 7 entries
+// behind; the switch flags still get through OBC_TC_latest_flags)
+static void queueTelecommand(const telecommand_data_t &tc, uint16_t tx_seq, uint32_t tx_time_us, uint32_t rx_time_us, bool replayed) {
+  telecommand_mailbox_entry_t entry;
+  entry.seq = ++OBC_TC_rx_seq;
+  entry.rx_time_us = rx_time_us;
+  entry.tx_seq = tx_seq;
+  entry.tx_time_us = tx_time_us;
+  entry.replayed = replayed;
+  entry.data = tc;
+  if (!replayed) {
+    // Replays are older than the frame that carried them
+    OBC_TC_latest_flags.store(tc.flags, std::memory_order_release);
+  }
+  OBC_TC_mailbox.push(entry);
+}
+
 void OnTelecommandReceive(const uint8_t * mac, const uint8_t *incoming_telecommand_data, int len) {
+  SN_TRACE_SCOPE("tc_rx");
 
   // OPTIMIZED: Direct RSSI capture without intermediate variable
   xr4_system_context.CTU_RSSI = ((wifi_pkt_rx_ctrl_t *)incoming_telecommand_data)->rssi;
   xr4_system_context.OBC_RSSI = xr4_system_context.CTU_RSSI;  // Same value for bidirectional link
   
-  // OPTIMIZED: Check message type inline without intermediate variable
-  if(*(uint8_t*)incoming_telecommand_data == TC_C2_DATA_MSG){
-    // OPTIMIZED: Direct memcpy without type checking - we know it's TC_C2_DATA_MSG
-    memcpy(&OBC_in_telecommand_data, incoming_telecommand_data, sizeof(telecommand_data_t));
-    OBC_TC_last_received_data_type = TC_C2_DATA_MSG;
-    OBC_TC_received_data_ready = true;
+  sn_wire_meta_t meta;
+
+  // Round-trip latency probe: echo it straight back before doing anything else
+  if(SN_Wire_GetFrameType(incoming_telecommand_data, len) == SN_WIRE_FRAME_TC_PING){
+    if(SN_Wire_DecodePing(incoming_telecommand_data, len, &meta)){
+      telemetry_pong_data_t pong;
+      pong.Ping_Seq = meta.seq;
+      pong.Ping_Tx_Time_us = meta.tx_time_us;
+
+      uint8_t frame[SN_WIRE_MAX_FRAME_LEN];
+      size_t frame_len = SN_Wire_EncodePong(pong, nextTxMeta(), frame, sizeof(frame));
+      if (frame_len > 0) {
+        esp_now_send(broadcastAddress, frame, frame_len);
+      }
 
-    SN_OBC_DrivingHandler();
-    
-    // // LATENCY CRITICAL: Process motor commands IMMEDIATELY in ISR for fastest response
-    // // This bypasses the main loop entirely for time-critical motor control
-    // if(!xr4_system_context.Emergency_Stop && xr4_system_context.Armed) {
-    //   // Inline joystick mapping for zero-latency motor response
-    //   int16_t raw_x = (int16_t)OBC_in_telecommand_data.Joystick_X - 2117;
-    //   int16_t throttle = (abs(raw_x) < 50) ? 0 : (int16_t)(((int32_t)OBC_in_telecommand_data.Joystick_X * 200) / 4095) - 100;
-      
-    //   int16_t raw_y = (int16_t)OBC_in_telecommand_data.Joystick_Y - 2000;
-    //   int16_t steering = (abs(raw_y) < 50) ? 0 : (int16_t)(((int32_t)OBC_in_telecommand_data.Joystick_Y * 200) / 4095) - 100;
-      
-    //   // Differential drive calculation
-    //   // When joystick LEFT: steering is negative → left motors slower, right motors faster → turn LEFT
-    //   // When joystick RIGHT: steering is positive → left motors faster, right motors slower → turn RIGHT
-    //   int16_t leftSpeed = throttle + steering;
-    //   int16_t rightSpeed = throttle - steering;
-      
-    //   // Clamp
-    //   if (leftSpeed > 100) leftSpeed = 100;
-    //   else if (leftSpeed < -100) leftSpeed = -100;
-    //   if (rightSpeed > 100) rightSpeed = 100;
-    //   else if (rightSpeed < -100) rightSpeed = -100;
-      
-    //   // Drive motors IMMEDIATELY - no waiting for main loop!
-    //   SN_Motors_Drive(leftSpeed, rightSpeed);
-    // } else {
-    //   // Safety: Stop motors if ESTOP or disarmed
-    //   SN_Motors_Drive(0, 0);
-    // }
-    
-    // LATENCY CRITICAL: Handle headlights IMMEDIATELY as well
-    // Extract headlights flag directly from telecommand flags
-    bool headlights_on = (OBC_in_telecommand_data.flags >> 1) & 0x01;  // Bit 1 is headlights
-    if(headlights_on) {
-      SN_StatusPanel__ControlHeadlights(true);
-    } else {
-      SN_StatusPanel__ControlHeadlights(false);
+      // Pings share the CTU's sequence counter, so they count towards link stats too
+      OBC_TC_link_stats.onFrame(meta.seq, meta.tx_time_us, (uint32_t)esp_timer_get_time());
     }
+    return;
   }
 
-  // Main loop will still update context for other peripherals (sensors, telemetry, etc.)
+  // Decode wire frame (rejects wrong version/length instead of copying garbage)
+  telecommand_data_t tc;
+  telecommand_history_t history;
+  history.count = 0;
+  bool decoded = false;
+
+  switch (SN_Wire_GetFrameType(incoming_telecommand_data, len)) {
+    case SN_WIRE_FRAME_TC_C2:
+      decoded = SN_Wire_DecodeTelecommand(incoming_telecommand_data, len, tc, &meta);
+      break;
+    case SN_WIRE_FRAME_TC_C2R:
+      decoded = SN_Wire_DecodeTelecommandRedundant(incoming_telecommand_data, len, tc, history, &meta);
+      break;
+    default:
+      break;
+  }
+
+  if(decoded){
+    uint32_t rx_time_us = (uint32_t)esp_timer_get_time();
+    OBC_TC_link_stats.onFrame(meta.seq, meta.tx_time_us, rx_time_us);
+
+    // Replay, oldest first, any earlier telecommand this frame repeats that
+    // never arrived on its own. Fields not carried in the history are taken
+    // from the current frame.
+    for (uint8_t i = 0; i < history.count; i++) {
+      const telecommand_sample_t &sample = history.samples[i];
+      if (!acceptTelecommandSeq(sample.Seq)) continue;
+
+      telecommand_data_t replay = tc;
+      replay.Joystick_X = sample.Joystick_X;
+      replay.Joystick_Y = sample.Joystick_Y;
+      replay.flags = sample.flags;
+      queueTelecommand(replay, sample.Seq, sample.Tx_Time_us, rx_time_us, true);
+      OBC_TC_replayed_count++;
+    }
+
+    // Drop duplicates and frames overtaken by a newer one
+    if (!acceptTelecommandSeq(meta.seq)) return;
+
+    OBC_TC_last_received_data_type = TC_C2_DATA_MSG;
+    OBC_in_telecommand_data = tc;
+    queueTelecommand(OBC_in_telecommand_data, meta.seq, meta.tx_time_us, rx_time_us, false);
+    SN_TRACE_INSTANT("tc_queued", meta.seq);
+  }
+
+  // Motors and headlights are driven from the OBC control task (SN_OBC_StartControlTask),
+  // which consumes the mailbox at a fixed rate; nothing else runs on the WiFi task.
 }
 
 #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
@@ -470,29 +757,70 @@ void OnTelemetryReceive(const uint8_t * mac, const uint8_t *incoming_telemetry_d
   telemetry_packets_received++;  // Diagnostic counter
 
   wifi_pkt_rx_ctrl_t *rx_ctrl = (wifi_pkt_rx_ctrl_t *)incoming_telemetry_data;
-  int data_len = len - rx_ctrl->sig_len;
   xr4_system_context.CTU_RSSI = rx_ctrl->rssi;
 
-  uint8_t CTU_in_TM_msg_type;
+  uint32_t rx_time_us = (uint32_t)esp_timer_get_time();
+  sn_wire_meta_t meta;
+  bool decoded = false;
+
+  switch (SN_Wire_GetFrameType(incoming_telemetry_data, len)) {
+    case SN_WIRE_FRAME_TM_SUPER: {
+      uint8_t sections = SN_Wire_DecodeTelemetrySuperframe(incoming_telemetry_data, len,
+                                                           CTU_in_TM_GPS_data,
+                                                           CTU_in_TM_IMU_data,
+                                                           CTU_in_TM_HK_data,
+                                                           &meta);
+      if (sections != 0) {
+        CTU_TM_pending_sections.fetch_or(sections);
+        if (sections & SN_WIRE_SECTION_HK) CTU_TM_HK_received.store(true);
+        decoded = true;
+      }
+      break;
+    }
 
-  memcpy(&CTU_in_TM_msg_type, incoming_telemetry_data, sizeof(uint8_t));
+    case SN_WIRE_FRAME_TM_GPS:
+      if (SN_Wire_DecodeTelemetryGPS(incoming_telemetry_data, len, CTU_in_TM_GPS_data, &meta)) {
+        CTU_TM_last_received_data_type = TM_GPS_DATA_MSG;
+        CTU_TM_pending_sections.fetch_or(SN_WIRE_SECTION_GPS);
+        decoded = true;
+      }
+      break;
 
-  if(CTU_in_TM_msg_type == TM_GPS_DATA_MSG){
-    memcpy(&CTU_in_TM_GPS_data, incoming_telemetry_data, sizeof(telemetry_GPS_data_t));
-    CTU_TM_last_received_data_type = TM_GPS_DATA_MSG;
-    CTU_TM_received_data_ready = true;
-  }
-  else if(CTU_in_TM_msg_type == TM_IMU_DATA_MSG){
-    memcpy(&CTU_in_TM_IMU_data, incoming_telemetry_data, sizeof(telemetry_IMU_data_t));
-    CTU_TM_last_received_data_type = TM_IMU_DATA_MSG;
-    CTU_TM_received_data_ready = true;
+    case SN_WIRE_FRAME_TM_IMU:
+      if (SN_Wire_DecodeTelemetryIMU(incoming_telemetry_data, len, CTU_in_TM_IMU_data, &meta)) {
+        CTU_TM_last_received_data_type = TM_IMU_DATA_MSG;
+        CTU_TM_pending_sections.fetch_or(SN_WIRE_SECTION_IMU);
+        decoded = true;
+      }
+      break;
+
+    case SN_WIRE_FRAME_TM_HK:
+      if (SN_Wire_DecodeTelemetryHK(incoming_telemetry_data, len, CTU_in_TM_HK_data, &meta)) {
+        CTU_TM_last_received_data_type = TM_HK_DATA_MSG;
+        CTU_TM_pending_sections.fetch_or(SN_WIRE_SECTION_HK);
+        CTU_TM_HK_received.store(true);
+        decoded = true;
+      }
+      break;
+
+    case SN_WIRE_FRAME_TM_PONG: {
+      telemetry_pong_data_t pong;
+      if (SN_Wire_DecodePong(incoming_telemetry_data, len, pong, &meta)) {
+        // Both timestamps are on the CTU clock, so this is a true round trip
+        CTU_RTT_histogram.record(rx_time_us - pong.Ping_Tx_Time_us);
+        decoded = true;
+      }
+      break;
+    }
+
+    default:
+      // Unknown type or wire version mismatch - drop frame
+      break;
   }
-  else if(CTU_in_TM_msg_type == TM_HK_DATA_MSG){
-    memcpy(&CTU_in_TM_HK_data, incoming_telemetry_data, sizeof(telemetry_HK_data_t));
-    CTU_TM_last_received_data_type = TM_HK_DATA_MSG;
-    CTU_TM_received_data_ready = true;
+
+  if (decoded) {
+    CTU_TM_link_stats.onFrame(meta.seq, meta.tx_time_us, rx_time_us);
   }
-  
 }
 #endif
 // --------------------------------------------------------
@@ -522,5 +850,26 @@ uint32_t SN_ESPNOW_GetTelecommandPacketsSent() {
 uint32_t SN_ESPNOW_GetTelecommandSendFailures() {
   return telecommand_send_failures;
 }
+
+const LinkStats& SN_ESPNOW_GetTelemetryLinkStats() {
+  return CTU_TM_link_stats;
+}
+
+const LatencyHistogram& SN_ESPNOW_GetRoundTripLatency() {
+  return CTU_RTT_histogram;
+}
+
+uint16_t SN_ESPNOW_GetTelecommandLossPermille() {
+  // Measured by the OBC and reported back in HK telemetry
+  return CTU_in_TM_HK_data.TC_Loss_Permille;
+}
+
+const telemetry_HK_data_t& SN_ESPNOW_GetOBCHousekeeping() {
+  return CTU_in_TM_HK_data;
+}
+
+bool SN_ESPNOW_HasOBCHousekeeping() {
+  return CTU_TM_HK_received.load();
+}
 #endif
 // --------------------------------------------------------
\ No newline at end of file
@@ -4,64 +4,29 @@
 #include <SN_XR_Board_Types.h>
 #include <SN_Common.h>
 
-typedef enum {
-    TM_GPS_DATA_MSG = 0x10,     // GPS data
-    TM_IMU_DATA_MSG = 0x20,     // IMU data
-    TM_HK_DATA_MSG = 0x30,      // Housekeeping data
-} telemetry_message_type_id_t;
-
-typedef enum {
-    TC_C2_DATA_MSG = 0x11,      // Control & Commands data
-} telecommand_message_type_id_t;
-
-// Create telemetry data structures to hold telemetry data (OBC --> CTU) 
-// instances of these structs are used by:
-//  * CTU (when receiving TM from OBC): CTU_in
-//  * OBC (when sending TM to CTU): OBC_out
-typedef struct telemetry_GPS_data {
-    uint8_t msg_type = TM_GPS_DATA_MSG;
-    double GPS_lat;
-    double GPS_lon;
-    double GPS_time;
-    
-    bool GPS_fix;
-} telemetry_GPS_data_t;
-
-typedef struct telemetry_IMU_data {
-    uint8_t msg_type = TM_IMU_DATA_MSG;
-    
-    // Orientation data (tilt-compensated, intuitive for operators)
-    float Heading_Degrees;      // Compass heading 0-360°
-    char Heading_Cardinal[3];   // Cardinal direction (N, NE, E, SE, S, SW, W, NW)
-    float Pitch_Degrees;        // Pitch angle (nose up/down)
-    float Roll_Degrees;         // Roll angle (left/right tilt)
-} telemetry_IMU_data_t;
-
-typedef struct telemetry_HK_data {
-    uint8_t msg_type = TM_HK_DATA_MSG;
-    float Main_Bus_V;
-    float Main_Bus_I;
-    float Bus_5V;           // 5V rail voltage
-    float Bus_3V3;          // 3.3V rail voltage
-    float temp;
-    int16_t OBC_RSSI;
-} telemetry_HK_data_t;
-
-// Create a struct_message to hold telecommand data (CTU --> OBC)
-// instances used by:
-//  * OBC (when receiving TC from CTU)
-//  * CTU (when sending TC to OBC)
-typedef struct telecommand_data {
-    uint8_t msg_type = TC_C2_DATA_MSG;
-    uint16_t Command;
-    uint16_t Joystick_X;
-    uint16_t Joystick_Y;
-    uint16_t Encoder_Pos;
-    uint16_t flags;         // Bytes structure (8-bit data): | Emergency_Stop | Armed | Button_A | Button_B | Button_C | Button_D | Headlights_On | Buzzer |
-    int16_t CTU_RSSI;       // RSSI value in dBm (negative, e.g., -30 to -90)
-} telecommand_data_t;
-
-// bool OBC_TC_received_data_ready;
+#include <SN_ESPNOW_Messages.h>
+#include <SN_ESPNOW_Wire.h>
+#include <SN_LinkStats.h>
+
+// Telemetry transmit mode (can be overridden in platformio.ini build_flags):
+//  1 = one superframe per send carrying every due GPS/IMU/HK section
+//  0 = legacy round-robin, one separate frame per message type per call
+#ifndef SN_ESPNOW_TM_SUPERFRAME
+#define SN_ESPNOW_TM_SUPERFRAME 1
+#endif
+
+// Telecommand redundancy: number of previous telecommands (0..TELECOMMAND_HISTORY_MAX)
+// repeated in every TC frame so the OBC can recover lost ones. 0 sends plain TC frames.
+// Only the CTU setting matters; the OBC always accepts both frame types.
+#ifndef SN_ESPNOW_TC_REDUNDANCY
+#define SN_ESPNOW_TC_REDUNDANCY 2
+#endif
+
+// Interval between round-trip latency probes sent by the CTU (0 disables them)
+#ifndef SN_ESPNOW_PING_INTERVAL_MS
+#define SN_ESPNOW_PING_INTERVAL_MS 200
+#endif
+
 // uint8_t OBC_TC_last_received_data_type;
 
 // bool CTU_TM_received_data_ready;
@@ -77,25 +42,46 @@ bool SN_ESPNOW_add_peer();
 
 void SN_ESPNOW_SendTelemetry();
 
+// TC_C2_DATA_MSG sends CTU_out_telecommand_data as it stands: build it with
+// SN_Telecommand_updateStruct (and run the send policy on it) first
 void SN_ESPNOW_SendTelecommand(uint8_t telecommand_type);
 
 void OnTelecommandReceive(const uint8_t * mac, const uint8_t *incoming_telecommand_data, int len);
 
 void OnTelemetryReceive(const uint8_t * mac, const uint8_t *incoming_telemetry_data, int len);
 
-void SN_Telemetry_updateContext(uint8_t CTU_TM_last_received_data_type);
+void SN_Telemetry_updateContext();
 
 void SN_Telemetry_updateStruct(xr4_system_context_t context);
 
-void SN_Telecommand_updateContext(const telecommand_data_t& OBC_in_telecommand_data);
+// Apply the newest telecommand from the mailbox to the system context.
+// Returns true if at least one telecommand arrived since the last call.
+bool SN_Telecommand_updateContext();
 
-void SN_Telemetry_updateStruct(xr4_system_context_t context);
+// Copy one telecommand's fields and flags into the system context
+void SN_Telecommand_applyToContext(const telecommand_data_t &tc);
 
 void SN_Telecommand_updateStruct(xr4_system_context_t context);
 
 // --- Helper for consistent cleanup ---
 void SN_ESPNOW_DeinitOnError();
 
+// --- Telecommand mailbox (OBC only) ---
+#if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
+// Pop every queued telecommand, leaving the newest in entry. Control task only.
+bool SN_ESPNOW_ConsumeTelecommand(telecommand_mailbox_entry_t &entry);
+// Pop the oldest queued telecommand, for consumers that need every sample. Control task only.
+bool SN_ESPNOW_PopTelecommand(telecommand_mailbox_entry_t &entry);
+// Switch flags of the newest telecommand received, even if its mailbox entry was dropped
+uint16_t SN_ESPNOW_GetLatestTelecommandFlags();
+uint32_t SN_ESPNOW_GetTelecommandMailboxOverflows();
+
+// --- Link statistics (OBC only): telecommands received from the CTU ---
+const LinkStats& SN_ESPNOW_GetTelecommandLinkStats();
+// Telecommands recovered from the history of redundant TC frames
+uint32_t SN_ESPNOW_GetTelecommandReplays();
+#endif
+
 // --- Connection status check (CTU only) ---
 #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 bool SN_ESPNOW_IsConnected();
@@ -104,4 +90,16 @@ bool SN_ESPNOW_IsConnected();
 uint32_t SN_ESPNOW_GetTelemetryPacketsReceived();
 uint32_t SN_ESPNOW_GetTelecommandPacketsSent();
 uint32_t SN_ESPNOW_GetTelecommandSendFailures();
+
+// --- Link statistics (CTU only) ---
+// Downlink: telemetry received from the OBC
+const LinkStats& SN_ESPNOW_GetTelemetryLinkStats();
+// Uplink: telecommand loss as measured by the OBC, reported in HK (0..1000)
+uint16_t SN_ESPNOW_GetTelecommandLossPermille();
+// Round-trip time of TC_PING_MSG probes, answered by the OBC with TM_PONG_MSG
+const LatencyHistogram& SN_ESPNOW_GetRoundTripLatency();
+// Latest HK telemetry from the OBC (includes its CPU load / stack / heap summary)
+const telemetry_HK_data_t& SN_ESPNOW_GetOBCHousekeeping();
+// False until the first HK telemetry has been decoded
+bool SN_ESPNOW_HasOBCHousekeeping();
 #endif
@@ -0,0 +1,112 @@
+#pragma once
+#include <stdint.h>
+
+// In-memory telemetry/telecommand message types shared by OBC and CTU.
+// Kept free of Arduino dependencies so the wire codec (SN_ESPNOW_Wire) can
+// also be compiled on a host machine.
+
+typedef enum {
+    TM_GPS_DATA_MSG = 0x10,     // GPS data
+    TM_IMU_DATA_MSG = 0x20,     // IMU data
+    TM_HK_DATA_MSG = 0x30,      // Housekeeping data
+    TM_PONG_MSG = 0x40,         // Round-trip latency probe reply
+} telemetry_message_type_id_t;
+
+typedef enum {
+    TC_C2_DATA_MSG = 0x11,      // Control & Commands data
+    TC_PING_MSG = 0x21,         // Round-trip latency probe (echoed by the OBC as TM_PONG_MSG)
+} telecommand_message_type_id_t;
+
+// Create telemetry data structures to hold telemetry data (OBC --> CTU) 
+// instances of these structs are used by:
+//  * CTU (when receiving TM from OBC): CTU_in
+//  * OBC (when sending TM to CTU): OBC_out
+typedef struct telemetry_GPS_data {
+    uint8_t msg_type = TM_GPS_DATA_MSG;
+    double GPS_lat;
+    double GPS_lon;
+    double GPS_time;
+    
+    bool GPS_fix;
+} telemetry_GPS_data_t;
+
+typedef struct telemetry_IMU_data {
+    uint8_t msg_type = TM_IMU_DATA_MSG;
+    
+    // Orientation data (tilt-compensated, intuitive for operators)
+    float Heading_Degrees;      // Compass heading 0-360°
+    char Heading_Cardinal[3];   // Cardinal direction (N, NE, E, SE, S, SW, W, NW)
+    float Pitch_Degrees;        // Pitch angle (nose up/down)
+    float Roll_Degrees;         // Roll angle (left/right tilt)
+} telemetry_IMU_data_t;
+
+typedef struct telemetry_HK_data {
+    uint8_t msg_type = TM_HK_DATA_MSG;
+    float Main_Bus_V;
+    float Main_Bus_I;
+    float Bus_5V;           // 5V rail voltage
+    float Bus_3V3;          // 3.3V rail voltage
+    float temp;
+    int16_t OBC_RSSI;
+    uint16_t TC_Loss_Permille;  // Telecommand loss rate measured on the OBC (0..1000)
+
+    // OBC runtime statistics (SN_RuntimeStats summary)
+    uint8_t CPU_Load_Core0;     // Percent, 0xFF = not measured
+    uint8_t CPU_Load_Core1;
+    uint16_t Min_Stack_Free;    // Bytes, least stack headroom of any task
+    uint16_t Heap_Free_KB;
+    uint16_t Heap_Min_Free_KB;
+    uint16_t Heap_Largest_KB;   // Largest free block
+} telemetry_HK_data_t;
+
+// Create a struct_message to hold telecommand data (CTU --> OBC)
+// instances used by:
+//  * OBC (when receiving TC from CTU)
+//  * CTU (when sending TC to OBC)
+typedef struct telecommand_data {
+    uint8_t msg_type = TC_C2_DATA_MSG;
+    uint16_t Command;
+    uint16_t Joystick_X;
+    uint16_t Joystick_Y;
+    uint16_t Encoder_Pos;
+    uint16_t flags;         // Bytes structure (8-bit data): | Emergency_Stop | Armed | Button_A | Button_B | Button_C | Button_D | Headlights_On | Buzzer |
+                            // Bit 8: Joystick_Settled (set by the CTU send policy, see SN_SendPolicy.h)
+    int16_t CTU_RSSI;       // RSSI value in dBm (negative, e.g., -30 to -90)
+} telecommand_data_t;
+
+// Reply to a TC_PING_MSG, echoing the ping's header so the CTU can compute
+// the round-trip time against its own clock
+typedef struct telemetry_pong_data {
+    uint8_t msg_type = TM_PONG_MSG;
+    uint16_t Ping_Seq;
+    uint32_t Ping_Tx_Time_us;
+} telemetry_pong_data_t;
+
+// Maximum number of earlier telecommands repeated in a redundant TC frame
+#define TELECOMMAND_HISTORY_MAX 4
+
+// Compact copy of an earlier telecommand (drive inputs and switches only),
+// repeated in later frames so the OBC can recover it if the original was lost
+typedef struct {
+    uint16_t Seq;           // Wire sequence number of the frame it was first sent in
+    uint32_t Tx_Time_us;    // Sender timestamp of that frame
+    uint16_t Joystick_X;
+    uint16_t Joystick_Y;
+    uint16_t flags;
+} telecommand_sample_t;
+
+typedef struct {
+    uint8_t count;          // Number of valid samples, oldest first
+    telecommand_sample_t samples[TELECOMMAND_HISTORY_MAX];
+} telecommand_history_t;
+
+// Decoded telecommand as handed from the ESP-NOW receive callback to the OBC
+// control task through the telecommand mailbox
+typedef struct {
+    uint32_t seq;           // Local receive sequence number, increments by 1 per accepted entry
+    uint32_t rx_time_us;    // Local esp_timer_get_time() (low 32 bits) when the frame was received
+    uint16_t tx_seq;        // Wire sequence number assigned by the CTU
+    uint32_t tx_time_us;    // CTU timestamp of the frame
+    bool replayed;          // Recovered from a later frame's history, not received directly
+    telecommand_data_t data;
+} telecommand_mailbox_entry_t;
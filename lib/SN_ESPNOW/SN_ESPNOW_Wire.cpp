@@ -0,0 +1,380 @@
+#include <SN_ESPNOW_Wire.h>
+#include <string.h>
+#include <math.h>
+
+// ----------------- Fixed-point helpers -----------------
+// Round to nearest and saturate, so out-of-range values clip instead of wrapping
+static int32_t toFixed(double value, double scale, int32_t min_val, int32_t max_val) {
+  double scaled = value * scale;
+  if (!(scaled == scaled)) return 0;  // NaN
+  if (scaled >= (double)max_val) return max_val;
+  if (scaled <= (double)min_val) return min_val;
+  return (int32_t)lround(scaled);
+}
+
+static size_t superframeLength(uint8_t section_mask) {
+  size_t len = sizeof(sn_wire_tm_super_prefix_t);
+  if (section_mask & SN_WIRE_SECTION_GPS) len += sizeof(sn_wire_gps_body_t);
+  if (section_mask & SN_WIRE_SECTION_IMU) len += sizeof(sn_wire_imu_body_t);
+  if (section_mask & SN_WIRE_SECTION_HK) len += sizeof(sn_wire_hk_body_t);
+  return len;
+}
+
+static void encodeHeader(sn_wire_frame_type_t type, const sn_wire_meta_t &meta, sn_wire_header_t &hdr) {
+  hdr.ver_type = SN_WIRE_HEADER(type);
+  hdr.seq = meta.seq;
+  hdr.tx_time_us = meta.tx_time_us;
+}
+
+static void decodeHeader(const sn_wire_header_t &hdr, sn_wire_meta_t *meta) {
+  if (meta == nullptr) return;
+  meta->seq = hdr.seq;
+  meta->tx_time_us = hdr.tx_time_us;
+}
+
+static bool checkFrame(const uint8_t *buf, size_t len, sn_wire_frame_type_t type, size_t frame_len) {
+  return len == frame_len && SN_Wire_GetFrameType(buf, len) == type;
+}
+// --------------------------------------------------------
+
+// ----------------- Body Encoders / Decoders -----------------
+static void encodeGPSBody(const telemetry_GPS_data_t &in, sn_wire_gps_body_t &body) {
+  body.lat_e7 = toFixed(in.GPS_lat, 1e7, -900000000, 900000000);
+  body.lon_e7 = toFixed(in.GPS_lon, 1e7, -1800000000, 1800000000);
+  body.time_cs = (uint32_t)toFixed(in.GPS_time, 100.0, 0, 8640000);
+  body.flags = in.GPS_fix ? SN_WIRE_GPS_FLAG_FIX : 0;
+}
+
+static void decodeGPSBody(const sn_wire_gps_body_t &body, telemetry_GPS_data_t &out) {
+  out.GPS_lat = body.lat_e7 / 1e7;
+  out.GPS_lon = body.lon_e7 / 1e7;
+  out.GPS_time = body.time_cs / 100.0;
+  out.GPS_fix = (body.flags & SN_WIRE_GPS_FLAG_FIX) != 0;
+}
+
+static void encodeIMUBody(const telemetry_IMU_data_t &in, sn_wire_imu_body_t &body) {
+  // Wrap heading into [0, 360) before scaling
+  float heading = fmodf(in.Heading_Degrees, 360.0f);
+  if (heading < 0.0f) heading += 360.0f;
+  int32_t heading_cdeg = toFixed(heading, 100.0, 0, 36000);
+  body.heading_cdeg = (uint16_t)(heading_cdeg >= 36000 ? 0 : heading_cdeg);
+  body.pitch_cdeg = (int16_t)toFixed(in.Pitch_Degrees, 100.0, INT16_MIN, INT16_MAX);
+  body.roll_cdeg = (int16_t)toFixed(in.Roll_Degrees, 100.0, INT16_MIN, INT16_MAX);
+  body.cardinal[0] = in.Heading_Cardinal[0];
+  body.cardinal[1] = in.Heading_Cardinal[0] != '\0' ? in.Heading_Cardinal[1] : '\0';
+}
+
+static void decodeIMUBody(const sn_wire_imu_body_t &body, telemetry_IMU_data_t &out) {
+  out.Heading_Degrees = body.heading_cdeg / 100.0f;
+  out.Pitch_Degrees = body.pitch_cdeg / 100.0f;
+  out.Roll_Degrees = body.roll_cdeg / 100.0f;
+  out.Heading_Cardinal[0] = body.cardinal[0];
+  out.Heading_Cardinal[1] = body.cardinal[1];
+  out.Heading_Cardinal[2] = '\0';
+}
+
+static void encodeHKBody(const telemetry_HK_data_t &in, sn_wire_hk_body_t &body) {
+  body.main_bus_mv = (uint16_t)toFixed(in.Main_Bus_V, 1000.0, 0, UINT16_MAX);
+  body.main_bus_ma = (int16_t)toFixed(in.Main_Bus_I, 1000.0, INT16_MIN, INT16_MAX);
+  body.bus_5v_mv = (uint16_t)toFixed(in.Bus_5V, 1000.0, 0, UINT16_MAX);
+  body.bus_3v3_mv = (uint16_t)toFixed(in.Bus_3V3, 1000.0, 0, UINT16_MAX);
+  body.temp_cdegc = (int16_t)toFixed(in.temp, 100.0, INT16_MIN, INT16_MAX);
+  body.obc_rssi = (int8_t)toFixed(in.OBC_RSSI, 1.0, INT8_MIN, INT8_MAX);
+  body.tc_loss_permille = in.TC_Loss_Permille > 1000 ? 1000 : in.TC_Loss_Permille;
+  body.cpu_load_core0 = in.CPU_Load_Core0;
+  body.cpu_load_core1 = in.CPU_Load_Core1;
+  body.min_stack_free = in.Min_Stack_Free;
+  body.heap_free_kb = in.Heap_Free_KB;
+  body.heap_min_free_kb = in.Heap_Min_Free_KB;
+  body.heap_largest_kb = in.Heap_Largest_KB;
+}
+
+static void decodeHKBody(const sn_wire_hk_body_t &body, telemetry_HK_data_t &out) {
+  out.Main_Bus_V = body.main_bus_mv / 1000.0f;
+  out.Main_Bus_I = body.main_bus_ma / 1000.0f;
+  out.Bus_5V = body.bus_5v_mv / 1000.0f;
+  out.Bus_3V3 = body.bus_3v3_mv / 1000.0f;
+  out.temp = body.temp_cdegc / 100.0f;
+  out.OBC_RSSI = body.obc_rssi;
+  out.TC_Loss_Permille = body.tc_loss_permille;
+  out.CPU_Load_Core0 = body.cpu_load_core0;
+  out.CPU_Load_Core1 = body.cpu_load_core1;
+  out.Min_Stack_Free = body.min_stack_free;
+  out.Heap_Free_KB = body.heap_free_kb;
+  out.Heap_Min_Free_KB = body.heap_min_free_kb;
+  out.Heap_Largest_KB = body.heap_largest_kb;
+}
+
+static void encodeTCBody(const telecommand_data_t &in, sn_wire_tc_body_t &body) {
+  body.command = in.Command;
+  body.joystick_x = in.Joystick_X;
+  body.joystick_y = in.Joystick_Y;
+  body.encoder_pos = in.Encoder_Pos;
+  body.flags = in.flags;
+  body.ctu_rssi = (int8_t)toFixed(in.CTU_RSSI, 1.0, INT8_MIN, INT8_MAX);
+}
+
+static void decodeTCBody(const sn_wire_tc_body_t &body, telecommand_data_t &out) {
+  out.Command = body.command;
+  out.Joystick_X = body.joystick_x;
+  out.Joystick_Y = body.joystick_y;
+  out.Encoder_Pos = body.encoder_pos;
+  out.flags = body.flags;
+  out.CTU_RSSI = body.ctu_rssi;
+}
+
+static void encodeTCSample(const telecommand_sample_t &in, uint32_t frame_tx_time_us, sn_wire_tc_sample_t &sample) {
+  uint32_t age_100us = (frame_tx_time_us - in.Tx_Time_us) / 100;
+  uint16_t x = in.Joystick_X & 0x0FFF;
+  uint16_t y = in.Joystick_Y & 0x0FFF;
+  sample.seq = in.Seq;
+  sample.age_100us = (uint16_t)(age_100us > UINT16_MAX ? UINT16_MAX : age_100us);
+  sample.joystick[0] = (uint8_t)(x & 0xFF);
+  sample.joystick[1] = (uint8_t)((x >> 8) | ((y & 0x0F) << 4));
+  sample.joystick[2] = (uint8_t)(y >> 4);
+  sample.flags = in.flags;
+}
+
+static void decodeTCSample(const sn_wire_tc_sample_t &sample, uint32_t frame_tx_time_us, telecommand_sample_t &out) {
+  out.Seq = sample.seq;
+  out.Tx_Time_us = frame_tx_time_us - (uint32_t)sample.age_100us * 100;
+  out.Joystick_X = (uint16_t)(sample.joystick[0] | ((sample.joystick[1] & 0x0F) << 8));
+  out.Joystick_Y = (uint16_t)((sample.joystick[1] >> 4) | (sample.joystick[2] << 4));
+  out.flags = sample.flags;
+}
+// --------------------------------------------------------
+
+// ----------------- Public API -----------------
+sn_wire_frame_type_t SN_Wire_GetFrameType(const uint8_t *buf, size_t len) {
+  if (buf == nullptr || len < sizeof(sn_wire_header_t)) return SN_WIRE_FRAME_INVALID;
+  if (SN_WIRE_HEADER_VERSION(buf[0]) != SN_WIRE_VERSION) return SN_WIRE_FRAME_INVALID;
+  return (sn_wire_frame_type_t)SN_WIRE_HEADER_TYPE(buf[0]);
+}
+
+size_t SN_Wire_EncodeTelemetryGPS(const telemetry_GPS_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  sn_wire_tm_gps_frame_t frame;
+  if (buf_len < sizeof(frame)) return 0;
+  encodeHeader(SN_WIRE_FRAME_TM_GPS, meta, frame.hdr);
+  encodeGPSBody(in, frame.body);
+  memcpy(buf, &frame, sizeof(frame));
+  return sizeof(frame);
+}
+
+size_t SN_Wire_EncodeTelemetryIMU(const telemetry_IMU_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  sn_wire_tm_imu_frame_t frame;
+  if (buf_len < sizeof(frame)) return 0;
+  encodeHeader(SN_WIRE_FRAME_TM_IMU, meta, frame.hdr);
+  encodeIMUBody(in, frame.body);
+  memcpy(buf, &frame, sizeof(frame));
+  return sizeof(frame);
+}
+
+size_t SN_Wire_EncodeTelemetryHK(const telemetry_HK_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  sn_wire_tm_hk_frame_t frame;
+  if (buf_len < sizeof(frame)) return 0;
+  encodeHeader(SN_WIRE_FRAME_TM_HK, meta, frame.hdr);
+  encodeHKBody(in, frame.body);
+  memcpy(buf, &frame, sizeof(frame));
+  return sizeof(frame);
+}
+
+size_t SN_Wire_EncodeTelecommand(const telecommand_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  sn_wire_tc_c2_frame_t frame;
+  if (buf_len < sizeof(frame)) return 0;
+  encodeHeader(SN_WIRE_FRAME_TC_C2, meta, frame.hdr);
+  encodeTCBody(in, frame.body);
+  memcpy(buf, &frame, sizeof(frame));
+  return sizeof(frame);
+}
+
+bool SN_Wire_DecodeTelemetryGPS(const uint8_t *buf, size_t len, telemetry_GPS_data_t &out, sn_wire_meta_t *meta) {
+  sn_wire_tm_gps_frame_t frame;
+  if (!checkFrame(buf, len, SN_WIRE_FRAME_TM_GPS, sizeof(frame))) return false;
+  memcpy(&frame, buf, sizeof(frame));
+  decodeHeader(frame.hdr, meta);
+  decodeGPSBody(frame.body, out);
+  return true;
+}
+
+bool SN_Wire_DecodeTelemetryIMU(const uint8_t *buf, size_t len, telemetry_IMU_data_t &out, sn_wire_meta_t *meta) {
+  sn_wire_tm_imu_frame_t frame;
+  if (!checkFrame(buf, len, SN_WIRE_FRAME_TM_IMU, sizeof(frame))) return false;
+  memcpy(&frame, buf, sizeof(frame));
+  decodeHeader(frame.hdr, meta);
+  decodeIMUBody(frame.body, out);
+  return true;
+}
+
+bool SN_Wire_DecodeTelemetryHK(const uint8_t *buf, size_t len, telemetry_HK_data_t &out, sn_wire_meta_t *meta) {
+  sn_wire_tm_hk_frame_t frame;
+  if (!checkFrame(buf, len, SN_WIRE_FRAME_TM_HK, sizeof(frame))) return false;
+  memcpy(&frame, buf, sizeof(frame));
+  decodeHeader(frame.hdr, meta);
+  decodeHKBody(frame.body, out);
+  return true;
+}
+
+bool SN_Wire_DecodeTelecommand(const uint8_t *buf, size_t len, telecommand_data_t &out, sn_wire_meta_t *meta) {
+  sn_wire_tc_c2_frame_t frame;
+  if (!checkFrame(buf, len, SN_WIRE_FRAME_TC_C2, sizeof(frame))) return false;
+  memcpy(&frame, buf, sizeof(frame));
+  decodeHeader(frame.hdr, meta);
+  decodeTCBody(frame.body, out);
+  return true;
+}
+
+size_t SN_Wire_EncodeTelecommandRedundant(const telecommand_data_t &in, const telecommand_history_t &history,
+                                          const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  uint8_t count = history.count > TELECOMMAND_HISTORY_MAX ? TELECOMMAND_HISTORY_MAX : history.count;
+  size_t frame_len = sizeof(sn_wire_tc_c2r_prefix_t) + count * sizeof(sn_wire_tc_sample_t);
+  if (buf_len < frame_len) return 0;
+
+  sn_wire_tc_c2r_prefix_t prefix;
+  encodeHeader(SN_WIRE_FRAME_TC_C2R, meta, prefix.hdr);
+  encodeTCBody(in, prefix.body);
+  prefix.history_count = count;
+  memcpy(buf, &prefix, sizeof(prefix));
+  size_t offset = sizeof(prefix);
+
+  // Keep the newest samples if the history holds more than fits
+  for (uint8_t i = history.count - count; i < history.count; i++) {
+    sn_wire_tc_sample_t sample;
+    encodeTCSample(history.samples[i], meta.tx_time_us, sample);
+    memcpy(buf + offset, &sample, sizeof(sample));
+    offset += sizeof(sample);
+  }
+  return offset;
+}
+
+bool SN_Wire_DecodeTelecommandRedundant(const uint8_t *buf, size_t len, telecommand_data_t &out,
+                                        telecommand_history_t &history, sn_wire_meta_t *meta) {
+  if (SN_Wire_GetFrameType(buf, len) != SN_WIRE_FRAME_TC_C2R) return false;
+  if (len < sizeof(sn_wire_tc_c2r_prefix_t)) return false;
+
+  sn_wire_tc_c2r_prefix_t prefix;
+  memcpy(&prefix, buf, sizeof(prefix));
+  if (prefix.history_count > TELECOMMAND_HISTORY_MAX) return false;
+  if (len != sizeof(prefix) + prefix.history_count * sizeof(sn_wire_tc_sample_t)) return false;
+
+  decodeHeader(prefix.hdr, meta);
+  decodeTCBody(prefix.body, out);
+  history.count = prefix.history_count;
+  size_t offset = sizeof(prefix);
+  for (uint8_t i = 0; i < history.count; i++) {
+    sn_wire_tc_sample_t sample;
+    memcpy(&sample, buf + offset, sizeof(sample));
+    decodeTCSample(sample, prefix.hdr.tx_time_us, history.samples[i]);
+    offset += sizeof(sample);
+  }
+  return true;
+}
+
+size_t SN_Wire_EncodePing(const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  sn_wire_tc_ping_frame_t frame;
+  if (buf_len < sizeof(frame)) return 0;
+  encodeHeader(SN_WIRE_FRAME_TC_PING, meta, frame.hdr);
+  memcpy(buf, &frame, sizeof(frame));
+  return sizeof(frame);
+}
+
+bool SN_Wire_DecodePing(const uint8_t *buf, size_t len, sn_wire_meta_t *meta) {
+  sn_wire_tc_ping_frame_t frame;
+  if (!checkFrame(buf, len, SN_WIRE_FRAME_TC_PING, sizeof(frame))) return false;
+  memcpy(&frame, buf, sizeof(frame));
+  decodeHeader(frame.hdr, meta);
+  return true;
+}
+
+size_t SN_Wire_EncodePong(const telemetry_pong_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len) {
+  sn_wire_tm_pong_frame_t frame;
+  if (buf_len < sizeof(frame)) return 0;
+  encodeHeader(SN_WIRE_FRAME_TM_PONG, meta, frame.hdr);
+  frame.body.ping_seq = in.Ping_Seq;
+  frame.body.ping_tx_time_us = in.Ping_Tx_Time_us;
+  memcpy(buf, &frame, sizeof(frame));
+  return sizeof(frame);
+}
+
+bool SN_Wire_DecodePong(const uint8_t *buf, size_t len, telemetry_pong_data_t &out, sn_wire_meta_t *meta) {
+  sn_wire_tm_pong_frame_t frame;
+  if (!checkFrame(buf, len, SN_WIRE_FRAME_TM_PONG, sizeof(frame))) return false;
+  memcpy(&frame, buf, sizeof(frame));
+  decodeHeader(frame.hdr, meta);
+  out.Ping_Seq = frame.body.ping_seq;
+  out.Ping_Tx_Time_us = frame.body.ping_tx_time_us;
+  return true;
+}
+
+size_t SN_Wire_EncodeTelemetrySuperframe(uint8_t section_mask,
+                                         const telemetry_GPS_data_t &gps,
+                                         const telemetry_IMU_data_t &imu,
+                                         const telemetry_HK_data_t &hk,
+                                         const sn_wire_meta_t &meta,
+                                         uint8_t *buf, size_t buf_len) {
+  section_mask &= SN_WIRE_SECTION_ALL;
+  if (section_mask == 0 || buf_len < superframeLength(section_mask)) return 0;
+
+  sn_wire_tm_super_prefix_t prefix;
+  encodeHeader(SN_WIRE_FRAME_TM_SUPER, meta, prefix.hdr);
+  prefix.sections = section_mask;
+  memcpy(buf, &prefix, sizeof(prefix));
+  size_t offset = sizeof(prefix);
+
+  if (section_mask & SN_WIRE_SECTION_GPS) {
+    sn_wire_gps_body_t body;
+    encodeGPSBody(gps, body);
+    memcpy(buf + offset, &body, sizeof(body));
+    offset += sizeof(body);
+  }
+  if (section_mask & SN_WIRE_SECTION_IMU) {
+    sn_wire_imu_body_t body;
+    encodeIMUBody(imu, body);
+    memcpy(buf + offset, &body, sizeof(body));
+    offset += sizeof(body);
+  }
+  if (section_mask & SN_WIRE_SECTION_HK) {
+    sn_wire_hk_body_t body;
+    encodeHKBody(hk, body);
+    memcpy(buf + offset, &body, sizeof(body));
+    offset += sizeof(body);
+  }
+  return offset;
+}
+
+uint8_t SN_Wire_DecodeTelemetrySuperframe(const uint8_t *buf, size_t len,
+                                          telemetry_GPS_data_t &gps,
+                                          telemetry_IMU_data_t &imu,
+                                          telemetry_HK_data_t &hk,
+                                          sn_wire_meta_t *meta) {
+  if (SN_Wire_GetFrameType(buf, len) != SN_WIRE_FRAME_TM_SUPER) return 0;
+  if (len < sizeof(sn_wire_tm_super_prefix_t)) return 0;
+
+  sn_wire_tm_super_prefix_t prefix;
+  memcpy(&prefix, buf, sizeof(prefix));
+  uint8_t section_mask = prefix.sections;
+  if (section_mask == 0 || (section_mask & ~SN_WIRE_SECTION_ALL) != 0) return 0;
+  if (len != superframeLength(section_mask)) return 0;
+  decodeHeader(prefix.hdr, meta);
+  size_t offset = sizeof(prefix);
+
+  if (section_mask & SN_WIRE_SECTION_GPS) {
+    sn_wire_gps_body_t body;
+    memcpy(&body, buf + offset, sizeof(body));
+    decodeGPSBody(body, gps);
+    offset += sizeof(body);
+  }
+  if (section_mask & SN_WIRE_SECTION_IMU) {
+    sn_wire_imu_body_t body;
+    memcpy(&body, buf + offset, sizeof(body));
+    decodeIMUBody(body, imu);
+    offset += sizeof(body);
+  }
+  if (section_mask & SN_WIRE_SECTION_HK) {
+    sn_wire_hk_body_t body;
+    memcpy(&body, buf + offset, sizeof(body));
+    decodeHKBody(body, hk);
+    offset += sizeof(body);
+  }
+  return section_mask;
+}
+// --------------------------------------------------------
@@ -0,0 +1,259 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <SN_ESPNOW_Messages.h>
+
+// ============================================================================
+// ESP-NOW WIRE FORMAT (OBC <--> CTU)
+// ============================================================================
+// Frames are sent as explicitly packed byte layouts instead of raw struct
+// memory, so there is no compiler padding on the air and both ends agree on
+// the exact size of every frame.
+//
+// Every frame starts with a 7-byte header:
+//   | version (bits 7..4) | frame type (bits 3..0) | seq (u16) | tx_time_us (u32) |
+// seq is a rolling per-sender frame counter (one counter per link direction)
+// and tx_time_us is the low 32 bits of the sender's esp_timer_get_time() when
+// the frame was built. The receiver uses both for loss/reorder/jitter stats.
+//
+// Multi-byte fields are little-endian (native byte order of the ESP32).
+// Fixed-point scaling is used where a float/double carries more precision
+// than the sensor delivers:
+//   - GPS lat/lon: 1e-7 degrees (int32), ~1 cm resolution
+//   - GPS time:    centiseconds since midnight (uint32)
+//   - Angles:      0.01 degrees (int16 / uint16)
+//   - Voltages:    millivolts (uint16), current: milliamps (int16)
+//   - Temperature: 0.01 degC (int16)
+//   - Heap:        KiB (uint16)
+//
+// Frame sizes (bytes), previously raw struct sizes in brackets:
+//   TM GPS 20 [40], TM IMU 15 [20], TM HK 30 [38], TC C2 18 [14]
+//   TC PING 7, TM PONG 13
+//   TC C2R 19 + 9 per history sample (max 55)
+//
+// Redundant telecommand (TC_C2R) is a TC C2 frame followed by up to
+// TELECOMMAND_HISTORY_MAX compact copies of the previous telecommands:
+//   | header | TC body | count | [history sample] x count |
+// Samples are oldest first. Each keeps its original sequence number and its
+// age relative to this frame's timestamp in 100 us units.
+//
+// Telemetry superframe (TM_SUPER) packs any combination of the GPS, IMU and
+// HK bodies into a single ESP-NOW payload:
+//   | header | section mask | [GPS body] | [IMU body] | [HK body] |
+// Bodies appear in mask-bit order; absent sections take no space.
+// ============================================================================
+
+#define SN_WIRE_VERSION 5           // 5: 16-bit flags in TC history samples too (4: in the TC body)
+
+#define SN_WIRE_HEADER(type)          ((uint8_t)((SN_WIRE_VERSION << 4) | ((type) & 0x0F)))
+#define SN_WIRE_HEADER_VERSION(hdr)   ((uint8_t)((hdr) >> 4))
+#define SN_WIRE_HEADER_TYPE(hdr)      ((uint8_t)((hdr) & 0x0F))
+
+// Frame types carried in the low nibble of the header byte
+typedef enum : uint8_t {
+    SN_WIRE_FRAME_INVALID = 0x0,
+    SN_WIRE_FRAME_TM_GPS  = 0x1,
+    SN_WIRE_FRAME_TM_IMU  = 0x2,
+    SN_WIRE_FRAME_TM_HK   = 0x3,
+    SN_WIRE_FRAME_TC_C2   = 0x4,
+    SN_WIRE_FRAME_TM_SUPER = 0x5,
+    SN_WIRE_FRAME_TC_PING = 0x6,
+    SN_WIRE_FRAME_TM_PONG = 0x7,
+    SN_WIRE_FRAME_TC_C2R  = 0x8,
+} sn_wire_frame_type_t;
+
+// Superframe section mask bits
+#define SN_WIRE_SECTION_GPS 0x01
+#define SN_WIRE_SECTION_IMU 0x02
+#define SN_WIRE_SECTION_HK  0x04
+#define SN_WIRE_SECTION_ALL (SN_WIRE_SECTION_GPS | SN_WIRE_SECTION_IMU | SN_WIRE_SECTION_HK)
+
+// GPS body flag bits
+#define SN_WIRE_GPS_FLAG_FIX 0x01
+
+typedef struct __attribute__((packed)) {
+    uint8_t ver_type;           // SN_WIRE_HEADER(frame type)
+    uint16_t seq;               // Rolling per-sender frame counter
+    uint32_t tx_time_us;        // Sender timestamp, low 32 bits of esp_timer_get_time()
+} sn_wire_header_t;
+
+// Per-frame link metadata carried in the header, filled by the sender and
+// returned to the receiver by the decoders
+typedef struct {
+    uint16_t seq;
+    uint32_t tx_time_us;
+} sn_wire_meta_t;
+
+typedef struct __attribute__((packed)) {
+    int32_t lat_e7;             // Latitude, 1e-7 deg
+    int32_t lon_e7;             // Longitude, 1e-7 deg
+    uint32_t time_cs;           // GPS time of day, centiseconds
+    uint8_t flags;              // SN_WIRE_GPS_FLAG_*
+} sn_wire_gps_body_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t heading_cdeg;      // 0..35999
+    int16_t pitch_cdeg;
+    int16_t roll_cdeg;
+    char cardinal[2];           // Not NUL-terminated on the wire
+} sn_wire_imu_body_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t main_bus_mv;
+    int16_t main_bus_ma;
+    uint16_t bus_5v_mv;
+    uint16_t bus_3v3_mv;
+    int16_t temp_cdegc;
+    int8_t obc_rssi;            // dBm
+    uint16_t tc_loss_permille;  // Telecommand loss seen by the OBC, 0..1000
+    uint8_t cpu_load_core0;     // Percent, 0xFF = not measured
+    uint8_t cpu_load_core1;
+    uint16_t min_stack_free;    // Bytes
+    uint16_t heap_free_kb;
+    uint16_t heap_min_free_kb;
+    uint16_t heap_largest_kb;
+} sn_wire_hk_body_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t command;
+    uint16_t joystick_x;        // Raw 12-bit ADC value
+    uint16_t joystick_y;        // Raw 12-bit ADC value
+    uint16_t encoder_pos;
+    uint16_t flags;             // Same bit layout as telecommand_data_t::flags
+    int8_t ctu_rssi;            // dBm
+} sn_wire_tc_body_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t seq;               // Sequence number of the frame the sample was first sent in
+    uint16_t age_100us;         // Frame tx_time_us minus sample tx time, 100 us units (saturates)
+    uint8_t joystick[3];        // Two 12-bit ADC values: X in bits 0..11, Y in bits 12..23
+    uint16_t flags;             // Same bit layout as telecommand_data_t::flags (incl. settled bit)
+} sn_wire_tc_sample_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t ping_seq;          // Header seq of the ping being answered
+    uint32_t ping_tx_time_us;   // Header timestamp of that ping (CTU clock)
+} sn_wire_pong_body_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    sn_wire_gps_body_t body;
+} sn_wire_tm_gps_frame_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    sn_wire_imu_body_t body;
+} sn_wire_tm_imu_frame_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    sn_wire_hk_body_t body;
+} sn_wire_tm_hk_frame_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    sn_wire_tc_body_t body;
+} sn_wire_tc_c2_frame_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    uint8_t sections;           // SN_WIRE_SECTION_* mask
+} sn_wire_tm_super_prefix_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    sn_wire_tc_body_t body;
+    uint8_t history_count;      // Number of sn_wire_tc_sample_t that follow
+} sn_wire_tc_c2r_prefix_t;
+
+// A ping is a bare header: its seq and tx_time_us are what gets echoed
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+} sn_wire_tc_ping_frame_t;
+
+typedef struct __attribute__((packed)) {
+    sn_wire_header_t hdr;
+    sn_wire_pong_body_t body;
+} sn_wire_tm_pong_frame_t;
+
+static_assert(sizeof(sn_wire_header_t) == 7, "wire header must be 7 bytes");
+static_assert(sizeof(sn_wire_gps_body_t) == 13, "unexpected GPS body size");
+static_assert(sizeof(sn_wire_imu_body_t) == 8, "unexpected IMU body size");
+static_assert(sizeof(sn_wire_hk_body_t) == 23, "unexpected HK body size");
+static_assert(sizeof(sn_wire_tc_body_t) == 11, "unexpected TC body size");
+static_assert(sizeof(sn_wire_tm_gps_frame_t) == 20, "unexpected GPS frame size");
+static_assert(sizeof(sn_wire_tm_imu_frame_t) == 15, "unexpected IMU frame size");
+static_assert(sizeof(sn_wire_tm_hk_frame_t) == 30, "unexpected HK frame size");
+static_assert(sizeof(sn_wire_tc_c2_frame_t) == 18, "unexpected TC frame size");
+static_assert(sizeof(sn_wire_tm_super_prefix_t) == 8, "unexpected superframe prefix size");
+static_assert(sizeof(sn_wire_tc_ping_frame_t) == 7, "unexpected ping frame size");
+static_assert(sizeof(sn_wire_tm_pong_frame_t) == 13, "unexpected pong frame size");
+static_assert(sizeof(sn_wire_tc_sample_t) == 9, "unexpected TC history sample size");
+static_assert(sizeof(sn_wire_tc_c2r_prefix_t) == 19, "unexpected redundant TC prefix size");
+
+#define SN_WIRE_SUPERFRAME_MAX_LEN (sizeof(sn_wire_tm_super_prefix_t) + sizeof(sn_wire_gps_body_t) + \
+                                    sizeof(sn_wire_imu_body_t) + sizeof(sn_wire_hk_body_t))
+static_assert(SN_WIRE_SUPERFRAME_MAX_LEN == 52, "unexpected superframe size");
+
+#define SN_WIRE_TC_C2R_MAX_LEN (sizeof(sn_wire_tc_c2r_prefix_t) + TELECOMMAND_HISTORY_MAX * sizeof(sn_wire_tc_sample_t))
+static_assert(SN_WIRE_TC_C2R_MAX_LEN == 55, "unexpected redundant TC frame size");
+
+// Largest frame this codec produces (ESP-NOW payload limit is 250 bytes)
+#define SN_WIRE_MAX_FRAME_LEN (SN_WIRE_TC_C2R_MAX_LEN > SN_WIRE_SUPERFRAME_MAX_LEN ? \
+                               SN_WIRE_TC_C2R_MAX_LEN : SN_WIRE_SUPERFRAME_MAX_LEN)
+static_assert(SN_WIRE_MAX_FRAME_LEN <= 250, "frame exceeds ESP-NOW payload limit");
+
+/**
+ * Validate the header of a received frame.
+ * Returns the frame type, or SN_WIRE_FRAME_INVALID if the buffer is empty or
+ * was produced by a different wire version.
+ */
+sn_wire_frame_type_t SN_Wire_GetFrameType(const uint8_t *buf, size_t len);
+
+// Encoders return the number of bytes written, or 0 if buf_len is too small.
+size_t SN_Wire_EncodeTelemetryGPS(const telemetry_GPS_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+size_t SN_Wire_EncodeTelemetryIMU(const telemetry_IMU_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+size_t SN_Wire_EncodeTelemetryHK(const telemetry_HK_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+size_t SN_Wire_EncodeTelecommand(const telecommand_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+
+// Decoders return false (and leave out untouched) on a header or length mismatch.
+// If meta is non-null it receives the frame's sequence number and timestamp.
+bool SN_Wire_DecodeTelemetryGPS(const uint8_t *buf, size_t len, telemetry_GPS_data_t &out, sn_wire_meta_t *meta = nullptr);
+bool SN_Wire_DecodeTelemetryIMU(const uint8_t *buf, size_t len, telemetry_IMU_data_t &out, sn_wire_meta_t *meta = nullptr);
+bool SN_Wire_DecodeTelemetryHK(const uint8_t *buf, size_t len, telemetry_HK_data_t &out, sn_wire_meta_t *meta = nullptr);
+bool SN_Wire_DecodeTelecommand(const uint8_t *buf, size_t len, telecommand_data_t &out, sn_wire_meta_t *meta = nullptr);
+
+// Redundant telecommand: the current telecommand plus up to
+// TELECOMMAND_HISTORY_MAX earlier samples (history.count beyond that is clipped)
+size_t SN_Wire_EncodeTelecommandRedundant(const telecommand_data_t &in, const telecommand_history_t &history,
+                                          const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+bool SN_Wire_DecodeTelecommandRedundant(const uint8_t *buf, size_t len, telecommand_data_t &out,
+                                        telecommand_history_t &history, sn_wire_meta_t *meta = nullptr);
+
+// Round-trip latency probe (CTU ping --> OBC pong)
+size_t SN_Wire_EncodePing(const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+bool SN_Wire_DecodePing(const uint8_t *buf, size_t len, sn_wire_meta_t *meta);
+size_t SN_Wire_EncodePong(const telemetry_pong_data_t &in, const sn_wire_meta_t &meta, uint8_t *buf, size_t buf_len);
+bool SN_Wire_DecodePong(const uint8_t *buf, size_t len, telemetry_pong_data_t &out, sn_wire_meta_t *meta = nullptr);
+
+/**
+ * Encode a telemetry superframe containing the sections selected in
+ * section_mask (SN_WIRE_SECTION_*). Returns bytes written, or 0 if the mask
+ * is empty or buf_len is too small.
+ */
+size_t SN_Wire_EncodeTelemetrySuperframe(uint8_t section_mask,
+                                         const telemetry_GPS_data_t &gps,
+                                         const telemetry_IMU_data_t &imu,
+                                         const telemetry_HK_data_t &hk,
+                                         const sn_wire_meta_t &meta,
+                                         uint8_t *buf, size_t buf_len);
+
+/**
+ * Decode a telemetry superframe. Only the sections present in the frame are
+ * written. Returns the mask of decoded sections, or 0 on a malformed frame.
+ */
+uint8_t SN_Wire_DecodeTelemetrySuperframe(const uint8_t *buf, size_t len,
+                                          telemetry_GPS_data_t &gps,
+                                          telemetry_IMU_data_t &imu,
+                                          telemetry_HK_data_t &hk,
+                                          sn_wire_meta_t *meta = nullptr);
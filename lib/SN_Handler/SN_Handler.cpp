@@ -7,22 +7,34 @@
 #include <SN_Joystick.h>
 #include <SN_XR_Board_Types.h>
 #include <SN_Motors.h>
+#include <SN_Profiler.h>
+#include <SN_Trace.h>
+#include <SN_RuntimeStats.h>
+#include <SN_UART_SLIP.h>
 
 #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 #include <SN_Switches.h>
 #include <SN_LCD.h>
+#include <SN_SendPolicy.h>
+#include <SN_DriveMixer.h>      // Joystick neutral/deadband shared with the OBC mixer
 #elif SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
 #include <SN_Sensors.h>
+#include <SN_DriveControl.h>
+#include <SN_DriveMixer.h>
+#include <SN_VelocityControl.h>
+#include <SN_BatteryCompensator.h>
 #endif
 
 #include <stdint.h>
 #include <stdbool.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_attr.h"
+#include "esp_timer.h"
 
 #include "driver/mcpwm.h"
 #include "soc/mcpwm_periph.h"
@@ -68,11 +80,12 @@ void sensorReadingTask(void *parameter) {
   logMessage(false, "SensorTask", "Background sensor task started on core %d", xPortGetCoreID());
   
   TickType_t xLastWakeTime = xTaskGetTickCount();
-  const TickType_t xFrequency = pdMS_TO_TICKS(200); // 5Hz update rate (200ms) - Reduced for lower latency
+  const TickType_t xFrequency = pdMS_TO_TICKS(SN_SENSOR_TASK_PERIOD_MS); // 5Hz update rate (200ms) - Reduced for lower latency
   
   while (true) {
     // Wait for the next cycle (prevents tight loop)
     vTaskDelayUntil(&xLastWakeTime, xFrequency);
+    SN_TRACE_SCOPE("sensors");
     
     // ========================================================================
     // READ ALL I2C SENSORS HERE TO AVOID BUS CONTENTION
@@ -98,6 +111,9 @@ void sensorReadingTask(void *parameter) {
     
     // Read IMU and compute orientation data
     #if SN_USE_IMU == 1
+    #if SN_USE_MAGNETOMETER == 1 && SN_MPU_FUSION_9DOF == 1
+    read_MAG();  // Read first: read_MPU() fuses this sample with the newest IMU sample
+    #endif
     read_MPU();  // Update MPU sensor readings (MPU6050 on I2C)
     
     // Extract pitch and roll angles (in degrees) from MPU
@@ -108,7 +124,11 @@ void sensorReadingTask(void *parameter) {
     xr4_system_context.Pitch_Degrees = pitch_deg;
     xr4_system_context.Roll_Degrees = roll_deg;
     
-    #if SN_USE_MAGNETOMETER == 1
+    #if SN_USE_MAGNETOMETER == 1 && SN_MPU_FUSION_9DOF == 1
+      // 9-DOF fusion - heading comes from the filter (tilt-compensated, gyro-smoothed)
+      xr4_system_context.Heading_Degrees = mpu_sensor.heading_degrees;
+      SN_Sensors_HeadingToCardinal(mpu_sensor.heading_degrees, xr4_system_context.Heading_Cardinal);
+    #elif SN_USE_MAGNETOMETER == 1
       // Read magnetometer data (QMC5883L on I2C)
       read_MAG();
       
@@ -179,6 +199,140 @@ void SN_OBC_StartBackgroundSensorTask() {
   logMessage(false, "SensorTask", "All sensors disabled - background task not created");
   #endif
 }
+
+// ============================================================================
+// FIXED-RATE CONTROL TASK
+// ============================================================================
+// Consumes telecommands from the ESP-NOW mailbox, runs the link watchdog and
+// updates the motors at SN_CONTROL_LOOP_HZ, independent of packet arrival
+// times. Runs on SN_CONTROL_TASK_CORE at SN_CONTROL_TASK_PRIORITY so neither
+// the Arduino loop (LCD/LED/telemetry work) nor the WiFi task can delay it.
+// ============================================================================
+
+static_assert(configTICK_RATE_HZ % SN_CONTROL_LOOP_HZ == 0, "SN_CONTROL_LOOP_HZ must divide the FreeRTOS tick rate");
+
+#define CONTROL_LINK_TIMEOUT_MS 2000    // Stop motors if no telecommand for this long
+
+static TaskHandle_t controlTaskHandle = NULL;
+
+static control_loop_stats_t control_loop_stats = {0, 0, 0, 0, 1000000UL / SN_CONTROL_LOOP_HZ};
+static LatencyHistogram control_loop_jitter;
+
+// Joystick samples are blended/extrapolated between telecommands (see SN_DriveControl.h)
+static CommandInterpolator joystick_interpolator({
+  (cmd_interp_mode_t)SN_TC_INTERP_MODE,
+  SN_TC_PLAYOUT_DELAY_US,
+  SN_TC_MAX_EXTRAPOLATION_US,
+  SN_TC_MAX_SAMPLE_GAP_US,
+  SN_MIXER_X_NEUTRAL,
+  SN_MIXER_Y_NEUTRAL
+});
+
+void SN_OBC_ControlStep() {
+  // Link watchdog: Check if we're receiving telecommands
+  static unsigned long lastTelecommandTime = 0;
+
+  // Feed every telecommand queued by the OnTelecommandReceive() callback to the
+  // interpolator, and apply the newest one to the OBC context
+  telecommand_mailbox_entry_t entry;
+  bool received = false;
+  while (SN_ESPNOW_PopTelecommand(entry)) {
+    joystick_interpolator.addSample(entry.tx_time_us, entry.rx_time_us,
+                                    entry.data.Joystick_X, entry.data.Joystick_Y, !entry.replayed,
+                                    get_flag(entry.data.flags, JOYSTICK_SETTLED_BIT));
+    received = true;
+  }
+  if (received) {
+    SN_TRACE_INSTANT("tc_apply", entry.tx_seq);
+    // E-STOP/ARM from the newest frame, even if a full mailbox dropped its entry
+    entry.data.flags = SN_ESPNOW_GetLatestTelecommandFlags();
+    SN_Telecommand_applyToContext(entry.data);
+    lastTelecommandTime = millis();
+  }
+
+  // If no telecommand for 2 seconds, enter safe mode
+  bool link_lost = lastTelecommandTime > 0 && (millis() - lastTelecommandTime > CONTROL_LINK_TIMEOUT_MS);
+
+  // Only drive in the operational states; everything else (init, error,
+  // reboot, and EMERGENCY_STOP even before the context flag is applied)
+  // holds the motors stopped. This task is the only motor writer: the state
+  // machine's entry actions leave stopping to this check.
+  uint8_t state = xr4_system_context.system_state;
+  bool drive_allowed = state == XR4_STATE_WAITING_FOR_ARM ||
+                       state == XR4_STATE_ARMED;
+
+  if (link_lost || !drive_allowed) {
+    if (received) SN_TRACE_INSTANT("motors_stop", state);
+    SN_Motors_Stop(); // Safety: stop motors if no communication
+    SN_OBC_ResetVelocityControl();
+    return;
+  }
+
+  uint16_t joystick_x = xr4_system_context.Joystick_X;
+  uint16_t joystick_y = xr4_system_context.Joystick_Y;
+  joystick_interpolator.evaluate((uint32_t)esp_timer_get_time(), joystick_x, joystick_y);
+
+  // Trace only the steps that act on a new telecommand (joystick-to-PWM path)
+  if (received) SN_TRACE_BEGIN("drive");
+  SN_OBC_DrivingHandler(joystick_x, joystick_y);
+  if (received) SN_TRACE_END("drive");
+}
+
+static void controlTask(void *parameter) {
+  logMessage(false, "ControlTask", "Control task started on core %d at %d Hz", xPortGetCoreID(), SN_CONTROL_LOOP_HZ);
+
+  const TickType_t xFrequency = configTICK_RATE_HZ / SN_CONTROL_LOOP_HZ;
+  const uint32_t period_us = control_loop_stats.period_us;
+  TickType_t xLastWakeTime = xTaskGetTickCount();
+  int64_t last_wake_us = 0;
+
+  while (true) {
+    vTaskDelayUntil(&xLastWakeTime, xFrequency);
+
+    int64_t wake_us = esp_timer_get_time();
+    if (last_wake_us != 0) {
+      int64_t interval_us = wake_us - last_wake_us;
+      int64_t deviation_us = interval_us - (int64_t)period_us;
+      control_loop_jitter.record((uint32_t)(deviation_us < 0 ? -deviation_us : deviation_us));
+    }
+    last_wake_us = wake_us;
+
+    SN_OBC_ControlStep();
+
+    uint32_t exec_us = (uint32_t)(esp_timer_get_time() - wake_us);
+    control_loop_stats.cycles++;
+    control_loop_stats.last_exec_us = exec_us;
+    if (exec_us > control_loop_stats.max_exec_us) control_loop_stats.max_exec_us = exec_us;
+    if (exec_us > period_us) control_loop_stats.overruns++;
+  }
+}
+
+// Start the fixed-rate control task
+void SN_OBC_StartControlTask() {
+  BaseType_t result = xTaskCreatePinnedToCore(
+    controlTask,                // Task function
+    "ControlTask",              // Name
+    4096,                       // Stack size (bytes)
+    NULL,                       // Parameters
+    SN_CONTROL_TASK_PRIORITY,   // Priority (above loop, below WiFi)
+    &controlTaskHandle,         // Task handle
+    SN_CONTROL_TASK_CORE        // Core 1 (WiFi task runs on core 0)
+  );
+
+  if (result == pdPASS) {
+    logMessage(false, "ControlTask", "Control task created on Core %d", SN_CONTROL_TASK_CORE);
+  } else {
+    logMessage(true, "ControlTask", "Failed to create control task!");
+  }
+}
+
+control_loop_stats_t SN_OBC_GetControlLoopStats() {
+  return control_loop_stats;
+}
+
+const LatencyHistogram& SN_OBC_GetControlLoopJitter() {
+  return control_loop_jitter;
+}
 #endif // SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
 
 
@@ -196,39 +350,157 @@ extern uint8_t CTU_TM_last_received_data_type;
 uint8_t joystick_test_x = 0;
 uint8_t joystick_test_y = 0;
 
+// Event-driven telecommand transmission (see SN_SendPolicy.h)
+static const tc_send_policy_config_t tc_send_policy_config = {
+  TC_SEND_MIN_GAP_MS,
+  TC_SEND_HEARTBEAT_MS,
+  TC_SEND_JOYSTICK_THRESHOLD,
+  (1 << EMERGENCY_STOP_BIT) | (1 << ARMED_BIT),   // Safety edges go out immediately
+  TC_SEND_SETTLE_MS,
+  TC_SEND_JOYSTICK_STILL_THRESHOLD,
+  SN_MIXER_X_NEUTRAL,
+  SN_MIXER_Y_NEUTRAL,
+  SN_MIXER_X_DEADBAND < SN_MIXER_Y_DEADBAND ? SN_MIXER_X_DEADBAND : SN_MIXER_Y_DEADBAND,
+  (1 << JOYSTICK_SETTLED_BIT)                     // Trailing frame: OBC holds the final position
+};
+static TelecommandSendPolicy tc_send_policy(tc_send_policy_config);
+
+static const char* const handler_stage_names[CTU_STAGE_COUNT] = {
+  "switches", "telemetry_update", "control_inputs", "tc_build", "tc_send", "lcd", "total"
+};
+static StageProfiler handler_profiler(handler_stage_names, CTU_STAGE_COUNT, 240);
+
 #elif SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
 
-extern telecommand_data_t OBC_in_telecommand_data;
-extern bool OBC_TC_received_data_ready;
 extern uint8_t OBC_TC_last_received_data_type;
 
+static const char* const handler_stage_names[OBC_STAGE_COUNT] = {
+  "execute_cmds", "stats_log", "read_sensors", "tm_build", "tm_send", "total"
+};
+static StageProfiler handler_profiler(handler_stage_names, OBC_STAGE_COUNT, 240);
+
+#endif
+
+static void printConsoleLine(const char* line) {
+  printf("%s\n", line);
+}
+
+// prof [dump|reset]
+static void profilerCommand(int argc, char** argv) {
+  if (argc < 2 || strcmp(argv[1], "dump") == 0) {
+    handler_profiler.dump(printConsoleLine);
+  } else if (strcmp(argv[1], "reset") == 0) {
+    handler_profiler.reset();
+    printf("Profiler reset\n");
+  } else {
+    printf("Usage: prof [dump|reset]\n");
+  }
+}
+
+// trace [dump|clear]
+static void traceCommand(int argc, char** argv) {
+  if (argc < 2 || strcmp(argv[1], "dump") == 0) {
+    SN_Trace_Dump(printConsoleLine);
+  } else if (strcmp(argv[1], "clear") == 0) {
+    SN_Trace_Clear();
+    printf("Trace cleared\n");
+  } else {
+    printf("Usage: trace [dump|clear]\n");
+  }
+}
+
+// stats: per-task CPU share and stack headroom, heap
+static void runtimeStatsCommand(int argc, char** argv) {
+  SN_RuntimeStats_Print(printConsoleLine);
+}
+
+#if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32 && SN_USE_IMU == 1
+// imubench: NVS lookups vs cached MPU calibration
+static void imuBenchCommand(int argc, char** argv) {
+  SN_Sensors_BenchmarkMPUCalibration(printConsoleLine);
+}
+
+// imucal [start|status]: bias calibration, rover still and level
+static void imuCalibrationCommand(int argc, char** argv) {
+  static const char* const status_names[] = { "idle", "pending", "done", "rejected (rover moved)", "failed" };
+  if (argc < 2 || strcmp(argv[1], "status") == 0) {
+    printf("IMU calibration: %s\n", status_names[SN_Sensors_GetMPUCalibrationStatus()]);
+  } else if (strcmp(argv[1], "start") == 0) {
+    SN_Sensors_RequestMPUCalibration();
+    printf("IMU calibration requested - keep the rover still for ~%u s\n",
+           (unsigned)((SN_MPU_CALIBRATION_SAMPLES + SN_MPU_CALIBRATION_RATE_HZ - 1) / SN_MPU_CALIBRATION_RATE_HZ));
+  } else {
+    printf("Usage: imucal [start|status]\n");
+  }
+}
+#endif
+
+void SN_Handler_InitDiagnostics() {
+  handler_profiler.setTicksPerUs(getCpuFrequencyMhz());
+  serial_console_register_command("prof", profilerCommand, "Main handler stage timing: prof [dump|reset]");
+  serial_console_register_command("trace", traceCommand, "Event trace (tools/trace2chrome.py): trace [dump|clear]");
+  serial_console_register_command("stats", runtimeStatsCommand, "Task CPU load, stack headroom and heap");
+#if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32 && SN_USE_IMU == 1
+  serial_console_register_command("imubench", imuBenchCommand, "Time MPU calibration lookup: NVS vs RAM cache");
+  serial_console_register_command("imucal", imuCalibrationCommand, "IMU bias calibration: imucal [start|status]");
 #endif
+}
 
 #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 
 void SN_CTU_MainHandler(){
+  SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_TOTAL);
+
   // Update switch states (includes debouncing)
-  SN_Switches_Update();
+  {
+    SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_SWITCHES);
+    SN_Switches_Update();
+  }
   
   // CTU Handler
-  SN_Telemetry_updateContext(CTU_TM_last_received_data_type);
+  {
+    SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_TELEMETRY_UPDATE);
+    SN_Telemetry_updateContext();
+  }
 
-  SN_CTU_ControlInputsHandler();
+  {
+    SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_CONTROL_INPUTS);
+    SN_CTU_ControlInputsHandler();
+  }
 
-  SN_Telecommand_updateStruct(xr4_system_context);
+  {
+    SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_TELECOMMAND_BUILD);
+    SN_Telecommand_updateStruct(xr4_system_context);
+  }
 
-  // Telecommand rate limiting (50Hz = 20ms interval)
-  // Prevents ESP-NOW channel flooding and maintains low latency
-  static unsigned long last_tc_send_time = 0;
-  const unsigned long TC_SEND_INTERVAL_MS = 20;  // 50Hz max rate
-  
-  if (millis() - last_tc_send_time >= TC_SEND_INTERVAL_MS) {
-    SN_ESPNOW_SendTelecommand(TC_C2_DATA_MSG);
-    last_tc_send_time = millis();
+  {
+    SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_TELECOMMAND_SEND);
+
+    // Send on safety edges / input changes / joystick movement / the stick
+    // settling, otherwise a heartbeat every TC_SEND_HEARTBEAT_MS, never
+    // closer than TC_SEND_MIN_GAP_MS
+    uint32_t now_ms = millis();
+    tc_send_reason_t tc_send_reason = tc_send_policy.evaluate(CTU_out_telecommand_data, now_ms);
+    if (tc_send_reason != TC_SEND_NONE) {
+      SN_ESPNOW_SendTelecommand(TC_C2_DATA_MSG);
+      tc_send_policy.onSent(CTU_out_telecommand_data, now_ms, tc_send_reason);
+    }
+
+#if SN_ESPNOW_PING_INTERVAL_MS > 0
+    // Round-trip latency probe (result shown on the LCD diagnostics page)
+    static unsigned long last_ping_time = 0;
+    if (millis() - last_ping_time >= SN_ESPNOW_PING_INTERVAL_MS) {
+      SN_ESPNOW_SendTelecommand(TC_PING_MSG);
+      last_ping_time = millis();
+    }
+#endif
   }
   
   // Update LCD display (non-blocking, updates at configured interval)
-  SN_LCD_Update(&xr4_system_context);
+  {
+    SN_PROFILE_STAGE(handler_profiler, CTU_STAGE_LCD);
+    SN_LCD_Update(&xr4_system_context);
+  }
 
 }
 
@@ -307,49 +579,151 @@ uint8_t SN_CTU_read_Emergency_Stop() {
 #elif SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
 
 void SN_OBC_ExecuteCommands() {
-  // Execute HIGH PRIORITY commands received from CTU
-  if (xr4_system_context.Emergency_Stop) {
-    xr4_system_context.system_state = XR4_STATE_EMERGENCY_STOP;
-  } else if (xr4_system_context.Armed && xr4_system_context.system_state != XR4_STATE_ARMED) {
-    logMessage(true, "SN_OBC_ExecuteCommands", "Rover ARMED. Switching to ARMED state.");
-    xr4_system_context.system_state = XR4_STATE_ARMED;
-  } else if (!xr4_system_context.Armed && xr4_system_context.system_state != XR4_STATE_WAITING_FOR_ARM) {
-    xr4_system_context.system_state = XR4_STATE_WAITING_FOR_ARM;
-  }
+  // HIGH PRIORITY commands (E-STOP, ARM) are turned into state machine
+  // events by loop() in main.cpp
 
   // Execute LOW PRIORITY commands received from CTU
-  SN_StatusPanel__ControlHeadlights(xr4_system_context.Headlights_On);
+  // Headlights only on change: each update takes the LED mutex and pushes the whole strip
+  static bool headlights_applied = false;
+  static bool headlights_state = false;
+  if (!headlights_applied || xr4_system_context.Headlights_On != headlights_state) {
+    headlights_state = xr4_system_context.Headlights_On;
+    headlights_applied = true;
+    SN_StatusPanel__ControlHeadlights(headlights_state);
+  }
   // add handling for COMMAND & COMM_MODE
 }
 
+// ============================================================================
+// CLOSED-LOOP VELOCITY CONTROL (SN_VELOCITY_CONTROL_MODE, see SN_VelocityControl.h)
+// ============================================================================
+#if SN_VELOCITY_CONTROL_MODE != 0
+
+static_assert(SN_VELOCITY_CONTROL_MODE == 1 || SN_VELOCITY_CONTROL_MODE == 2, "unknown SN_VELOCITY_CONTROL_MODE");
+
+static const velocity_pid_config_t velocity_pid_config = {
+  SN_VELOCITY_KP, SN_VELOCITY_KI, SN_VELOCITY_KFF, SN_VELOCITY_I_LIMIT, 100.0f
+};
+static VelocityController left_velocity(velocity_pid_config);
+static VelocityController right_velocity(velocity_pid_config);
+
+#if SN_VELOCITY_CONTROL_MODE == 1
+// Cumulative wheel encoder counts. The tree has no encoder driver yet: this
+// weak default reports "no counts", so mode 1 builds and drives open loop
+// until a driver that defines the strong symbol is linked in.
+__attribute__((weak)) bool SN_WheelEncoders_GetCounts(int32_t *left, int32_t *right) {
+  (void)left;
+  (void)right;
+  return false;
+}
+
+static EncoderSpeedFeedback wheel_feedback(SN_ENCODER_COUNTS_PER_S_FULL);
+#elif SN_VELOCITY_CONTROL_MODE == 2
+static CurrentYawSpeedEstimator wheel_feedback({
+  SN_ESTIMATOR_NOMINAL_BUS_V, SN_ESTIMATOR_AMPS_PER_PCT, SN_ESTIMATOR_IDLE_CURRENT_A, SN_ESTIMATOR_FULL_YAW_DPS
+});
+
+// Bus V/I and the yaw rate only change once per sensor task period, so the
+// estimate is refreshed at that rate (with the ramped duty averaged over the
+// period) and held in between
+static const uint32_t estimator_period_ticks =
+  (SN_SENSOR_TASK_PERIOD_MS * SN_CONTROL_LOOP_HZ + 999) / 1000;
+static uint32_t estimator_ticks = 0;
+static float estimator_left_duty_sum = 0.0f;
+static float estimator_right_duty_sum = 0.0f;
+static wheel_speed_t estimated_speed = {0.0f, 0.0f, false};
+#endif
+
+static wheel_speed_t readWheelSpeed(float dt_s) {
+#if SN_VELOCITY_CONTROL_MODE == 1
+  int32_t left_count, right_count;
+  if (!SN_WheelEncoders_GetCounts(&left_count, &right_count)) {
+    wheel_speed_t none = {0.0f, 0.0f, false};
+    return none;
+  }
+  return wheel_feedback.update(left_count, right_count, dt_s);
+#elif SN_VELOCITY_CONTROL_MODE == 2
+  // Duty the motors ran at during the last tick, after the slew limiter
+  int16_t left_duty, right_duty;
+  SN_Motors_GetAppliedSpeeds(&left_duty, &right_duty);
+  estimator_left_duty_sum += left_duty;
+  estimator_right_duty_sum += right_duty;
+  if (++estimator_ticks < estimator_period_ticks) return estimated_speed;
+
+  #if SN_USE_IMU == 1
+  float yaw_rate_dps = mpu_sensor.yaw_rate_dps;
+  #else
+  float yaw_rate_dps = 0.0f;  // Rotation unobserved without the IMU
+  #endif
+  estimated_speed = wheel_feedback.update(estimator_left_duty_sum / estimator_ticks,
+                                          estimator_right_duty_sum / estimator_ticks,
+                                          xr4_system_context.Main_Bus_V, xr4_system_context.Main_Bus_I, yaw_rate_dps);
+  estimator_ticks = 0;
+  estimator_left_duty_sum = 0.0f;
+  estimator_right_duty_sum = 0.0f;
+  return estimated_speed;
+#endif
+}
+
+// Turn wheel speed setpoints (percent) into duties; open loop if there is no feedback
+static drive_mix_t velocityControl(drive_mix_t setpoint, float dt_s) {
+  wheel_speed_t measured = readWheelSpeed(dt_s);
+  if (!measured.valid) return setpoint;
+
+  drive_mix_t duty;
+  duty.left = (int16_t)lroundf(left_velocity.update(setpoint.left, measured.left, dt_s));
+  duty.right = (int16_t)lroundf(right_velocity.update(setpoint.right, measured.right, dt_s));
+  return duty;
+}
+#endif // SN_VELOCITY_CONTROL_MODE != 0
+
+#if SN_BATTERY_COMP_ENABLED
+// Open-loop duty scaled by nominal / filtered Main_Bus_V (see SN_BatteryCompensator.h)
+static BatteryCompensator battery_compensator({
+  SN_BATTERY_COMP_NOMINAL_V, SN_BATTERY_COMP_MIN_GAIN, SN_BATTERY_COMP_MAX_GAIN,
+  SN_BATTERY_COMP_TAU_S, SN_BATTERY_COMP_MIN_VALID_V
+});
+#endif
+
+void SN_OBC_ResetVelocityControl() {
+#if SN_VELOCITY_CONTROL_MODE != 0
+  left_velocity.reset();
+  right_velocity.reset();
+  wheel_feedback.reset();
+#if SN_VELOCITY_CONTROL_MODE == 2
+  estimator_ticks = 0;
+  estimator_left_duty_sum = 0.0f;
+  estimator_right_duty_sum = 0.0f;
+  estimated_speed = {0.0f, 0.0f, false};
+#endif
+#endif
+}
+
 void 
-SN_OBC_DrivingHandler() {
+SN_OBC_DrivingHandler(uint16_t joystick_x, uint16_t joystick_y) {
   if(!xr4_system_context.Emergency_Stop && xr4_system_context.Armed) {
-    // Inline joystick mapping for zero-latency motor response
     // X-axis is Horizontal Axis of Joystick i.e. Left/Right (steering)
     // Y-axis is Vertical Joystick axis i.e. Forward/Backward (throttle)
-    int16_t raw_x = (int16_t)OBC_in_telecommand_data.Joystick_X - 2117;
-    int16_t steering = (abs(raw_x) < 50) ? 0 : (int16_t)(((int32_t)OBC_in_telecommand_data.Joystick_X * 200) / 4095) - 100;
-    
-    int16_t raw_y = (int16_t)OBC_in_telecommand_data.Joystick_Y - 2000;
-    int16_t throttle = (abs(raw_y) < 50) ? 0 : (int16_t)(((int32_t)OBC_in_telecommand_data.Joystick_Y * 200) / 4095) - 100;
-    
-  
-    // Differential drive calculation
-    int16_t leftSpeed = - steering - throttle;
-    int16_t rightSpeed = - steering + throttle;
-    
-    // Clamp to valid range
-    if (leftSpeed > 100) leftSpeed = 100;
-    else if (leftSpeed < -100) leftSpeed = -100;
-    if (rightSpeed > 100) rightSpeed = 100;
-    else if (rightSpeed < -100) rightSpeed = -100;
-    
-    // Drive motors IMMEDIATELY - no waiting for main loop!
-    SN_Motors_Drive(leftSpeed, rightSpeed);
+    // Table lookup + saturation-aware differential mix (see SN_DriveMixer.h)
+    drive_mix_t mix = SN_DriveMixer_Mix(joystick_x, joystick_y);
+    const float dt_s = 1.0f / SN_CONTROL_LOOP_HZ;
+
+#if SN_VELOCITY_CONTROL_MODE != 0
+    // Mixer output is a wheel speed setpoint; the velocity loops pick the duty
+    // (their feedback already absorbs battery sag)
+    mix = velocityControl(mix, dt_s);
+#elif SN_BATTERY_COMP_ENABLED
+    // Open loop: compensate the duty for the current pack voltage
+    battery_compensator.updateVoltage(xr4_system_context.Main_Bus_V, dt_s);
+    mix = battery_compensator.apply(mix);
+#endif
+
+    // Called once per control task cycle; the ramp advances one period per call
+    SN_Motors_DriveRamped(mix.left, mix.right, dt_s);
   } else {
-    // Safety: Stop motors if ESTOP or disarmed
-    SN_Motors_Drive(0, 0);
+    // Safety: Stop motors immediately (bypasses the ramp) if ESTOP or disarmed
+    SN_Motors_Stop();
+    SN_OBC_ResetVelocityControl();
   }
 }
 
@@ -372,42 +746,63 @@ void SN_OBC_ReadSensors() {
 
 // OBC Handler
 void SN_OBC_MainHandler(){
-  // Watchdog: Check if we're receiving telecommands
-  static unsigned long lastTelecommandTime = 0;
-  static bool watchdogActive = false;
-  
-  if (OBC_TC_received_data_ready) {
-    lastTelecommandTime = millis();
-    watchdogActive = false;
-  }
-  
-  // If no telecommand for 2 seconds, enter safe mode
-  if (millis() - lastTelecommandTime > 2000 && lastTelecommandTime > 0) {
-    if (!watchdogActive) {
-      watchdogActive = true;
-    }
-    SN_Motors_Stop(); // Safety: stop motors if no communication
-  }
+  // Telecommand intake, link watchdog and motor updates run in the control task
+  // (SN_OBC_StartControlTask); the loop only acts on the resulting context.
 
-  // Update OBC context with received telecommand data, which is received from CTU and assigned to OBC_in_telecommand_data using OnTelecommandReceive() callback
-  SN_Telecommand_updateContext(OBC_in_telecommand_data); 
+  SN_PROFILE_STAGE(handler_profiler, OBC_STAGE_TOTAL);
 
   // Execute telecommands received from CTU
-  SN_OBC_ExecuteCommands();
+  {
+    SN_PROFILE_STAGE(handler_profiler, OBC_STAGE_EXECUTE_COMMANDS);
+    SN_OBC_ExecuteCommands();
+  }
 
-  // Execute driving commands received from CTU (only if not in watchdog safe mode)
-  if (!watchdogActive) {
-    //SN_OBC_DrivingHandler();
+  // Periodic control loop timing report
+  static unsigned long lastControlStatsLog = 0;
+  if (millis() - lastControlStatsLog >= 10000) {
+    SN_PROFILE_STAGE(handler_profiler, OBC_STAGE_STATS_LOG);
+    lastControlStatsLog = millis();
+    control_loop_stats_t stats = SN_OBC_GetControlLoopStats();
+    const LatencyHistogram &jitter = SN_OBC_GetControlLoopJitter();
+    logMessage(false, "ControlTask", "cycles=%lu overruns=%lu exec=%lu/%luus jitter p50=%lu p99=%lu max=%luus",
+               (unsigned long)stats.cycles, (unsigned long)stats.overruns,
+               (unsigned long)stats.last_exec_us, (unsigned long)stats.max_exec_us,
+               (unsigned long)jitter.percentileUs(50), (unsigned long)jitter.percentileUs(99),
+               (unsigned long)jitter.maxUs());
+
+    motor_driver_stats_t motor_stats = SN_Motors_GetDriverStats();
+    logMessage(false, "Motors", "commands=%lu skipped=%lu duty_only=%lu dir_changes=%lu driver_calls=%lu",
+               (unsigned long)motor_stats.commands, (unsigned long)motor_stats.skipped,
+               (unsigned long)motor_stats.duty_updates, (unsigned long)motor_stats.direction_changes,
+               (unsigned long)motor_stats.driver_calls);
+
+    motor_commit_stats_t commit_stats = SN_Motors_GetCommitStats();
+    // 64-bit: cycles * 1000 overflows 32 bits past ~18 ms at 240 MHz
+    uint64_t cpu_mhz = getCpuFrequencyMhz();
+    logMessage(false, "Motors", "commits=%lu window=%llu/%lluns (last/max) timer sync=%lluns",
+               (unsigned long)commit_stats.commits,
+               (unsigned long long)((uint64_t)commit_stats.last_window_cycles * 1000 / cpu_mhz),
+               (unsigned long long)((uint64_t)commit_stats.max_window_cycles * 1000 / cpu_mhz),
+               (unsigned long long)((uint64_t)commit_stats.sync_window_cycles * 1000 / cpu_mhz));
   }
 
   // Read sensors and update context
-  SN_OBC_ReadSensors();
+  {
+    SN_PROFILE_STAGE(handler_profiler, OBC_STAGE_READ_SENSORS);
+    SN_OBC_ReadSensors();
+  }
 
   // Update outgoing telemetry data struct using the updated context
-  SN_Telemetry_updateStruct(xr4_system_context);
+  {
+    SN_PROFILE_STAGE(handler_profiler, OBC_STAGE_TELEMETRY_BUILD);
+    SN_Telemetry_updateStruct(xr4_system_context);
+  }
 
   // Send telemetry (has built-in rotation and timing control)
-  SN_ESPNOW_SendTelemetry();
+  {
+    SN_PROFILE_STAGE(handler_profiler, OBC_STAGE_TELEMETRY_SEND);
+    SN_ESPNOW_SendTelemetry();
+  }
 }
 
 
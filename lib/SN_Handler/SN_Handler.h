@@ -1,3 +1,7 @@
+#pragma once
+#include <stdint.h>
+#include <SN_LinkStats.h>
+
 
 void SN_OBC_MainHandler();
 
@@ -7,15 +11,81 @@ void SN_OBC_TurnOnHeadlights();
 
 void SN_OBC_TurnOffHeadlights();
 
-void SN_OBC_DrivingHandler();
+// Map raw joystick ADC values to differential drive speeds and drive the motors
+void SN_OBC_DrivingHandler(uint16_t joystick_x, uint16_t joystick_y);
+
+// Clear velocity loop integrators and feedback filters (called whenever the motors are stopped)
+void SN_OBC_ResetVelocityControl();
 
 void SN_OBC_ReadSensors();
 
 // Zero-latency background sensor reading using FreeRTOS task
 void SN_OBC_StartBackgroundSensorTask();
 
+#ifndef SN_SENSOR_TASK_PERIOD_MS
+#define SN_SENSOR_TASK_PERIOD_MS 200    // Bus voltage/current and IMU refresh (5 Hz)
+#endif
+
+// Fixed-rate motor control task (consumes telecommands, runs link watchdog, drives motors)
+#ifndef SN_CONTROL_LOOP_HZ
+#define SN_CONTROL_LOOP_HZ 250          // Must divide the FreeRTOS tick rate (1000 Hz)
+#endif
+
+#ifndef SN_CONTROL_TASK_PRIORITY
+#define SN_CONTROL_TASK_PRIORITY 10     // Above the Arduino loop (1), below the WiFi task (23)
+#endif
+
+#ifndef SN_CONTROL_TASK_CORE
+#define SN_CONTROL_TASK_CORE 1          // Away from the WiFi task on core 0
+#endif
+
+typedef struct {
+    uint32_t cycles;            // Control steps executed
+    uint32_t overruns;          // Steps whose work took longer than one period
+    uint32_t last_exec_us;      // Work time of the latest step
+    uint32_t max_exec_us;       // Longest work time seen
+    uint32_t period_us;         // Nominal period (1e6 / SN_CONTROL_LOOP_HZ)
+} control_loop_stats_t;
+
+void SN_OBC_StartControlTask();
+
+// One control step: consume telecommands, watchdog, drive motors (called by the control task)
+void SN_OBC_ControlStep();
+
+control_loop_stats_t SN_OBC_GetControlLoopStats();
+
+// Histogram of |actual wake interval - nominal period| in microseconds
+const LatencyHistogram& SN_OBC_GetControlLoopJitter();
+
 void SN_CTU_MainHandler();
 
+// Main handler stage profiler (see SN_Profiler.h); stage ids index the
+// profiler of the board being built
+enum {
+    OBC_STAGE_EXECUTE_COMMANDS,
+    OBC_STAGE_STATS_LOG,
+    OBC_STAGE_READ_SENSORS,
+    OBC_STAGE_TELEMETRY_BUILD,
+    OBC_STAGE_TELEMETRY_SEND,
+    OBC_STAGE_TOTAL,
+    OBC_STAGE_COUNT
+};
+
+enum {
+    CTU_STAGE_SWITCHES,
+    CTU_STAGE_TELEMETRY_UPDATE,
+    CTU_STAGE_CONTROL_INPUTS,
+    CTU_STAGE_TELECOMMAND_BUILD,
+    CTU_STAGE_TELECOMMAND_SEND,
+    CTU_STAGE_LCD,
+    CTU_STAGE_TOTAL,
+    CTU_STAGE_COUNT
+};
+
+// Set the profiler counter rate and register the "prof", "trace", "stats"
+// and (OBC) "imubench" serial console commands
+void SN_Handler_InitDiagnostics();
+
 void SN_CTU_ControlInputsHandler();
 
 uint8_t SN_CTU_get_OBC_Communication_Mode();
@@ -33,6 +103,7 @@ uint8_t SN_CTU_read_Emergency_Stop();
 #define BUTTON_D_BIT 2
 #define HEADLIGHTS_ON_BIT 1
 #define BUZZER_BIT 0
+#define JOYSTICK_SETTLED_BIT 8  // Stick at rest or centred: the OBC holds instead of extrapolating
 
 // Function to set a specific flag in the variable
 void set_flag(uint16_t *flags, uint8_t bit_position, bool value);
@@ -241,30 +241,4 @@ CTU_InputStates_t SN_CTU_ReadInputStates() {
 #endif // SN_JOYSTICK_H
 #endif // SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 
-// ----- Joystick Mapping Function (Used on OBC side) -----
-#if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-// Map the raw ADC values to a range of -100 to 100
-JoystickMappedValues_t SN_Joystick_OBC_MapADCValues(uint16_t joystick_x_adc_val, uint16_t joystick_y_adc_val) {
-    JoystickMappedValues_t mapped;
-
-    // Apply deadband around neutral position
-    const int DEADBAND = 50; // ADC units around neutral position
-    
-    // X-axis (forward/backward) mapping with deadband
-    if (abs((int)joystick_x_adc_val - JOYSTICK_X_NEUTRAL) < DEADBAND) {
-        mapped.joystick_x_mapped_val = 0;
-    } else {
-        mapped.joystick_x_mapped_val = map(joystick_x_adc_val, JOYSTICK_MIN, JOYSTICK_MAX, -100, 100);
-    }
-
-    // Y-axis (left/right) mapping with deadband
-    if (abs((int)joystick_y_adc_val - JOYSTICK_Y_NEUTRAL) < DEADBAND) {
-        mapped.joystick_y_mapped_val = 0;
-    } else {
-        mapped.joystick_y_mapped_val = map(joystick_y_adc_val, JOYSTICK_MIN, JOYSTICK_MAX, -100, 100);
-    }
-
-    return mapped;
-}
-#endif
   
\ No newline at end of file
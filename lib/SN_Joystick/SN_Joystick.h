@@ -71,13 +71,4 @@ typedef struct CTU_InputStates {
 JoystickRawADCValues_t SN_Joystick_ReadRawADCValues();
 CTU_InputStates_t SN_CTU_ReadInputStates();
 
-#elif SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-
-typedef struct JoystickMappedValues {
-    int16_t joystick_x_mapped_val = 0;
-    int16_t joystick_y_mapped_val = 0;
-} JoystickMappedValues_t;
-
-JoystickMappedValues_t SN_Joystick_OBC_MapADCValues(uint16_t joystick_x_adc_val, uint16_t joystick_y_adc_val);
-
 #endif
\ No newline at end of file
@@ -128,6 +128,16 @@ void printRightAlign(int row, const char* text) {
     lcd.print(text);
 }
 
+/**
+ * Print text from column 0, padding with spaces to clear the rest of the row
+ */
+void printPaddedRow(int row, const char* text) {
+    char buffer[LCD_COLUMNS + 1];
+    snprintf(buffer, sizeof(buffer), "%-*.*s", LCD_COLUMNS, LCD_COLUMNS, text);
+    lcd.setCursor(0, row);
+    lcd.print(buffer);
+}
+
 /**
  * Format voltage for display (e.g., "12.34V")
  */
@@ -387,7 +397,7 @@ void renderSensorsPage(xr4_system_context_t* ctx) {
  * Row 0: "JoyX:1856 JoyY:1880" (Joystick raw values)
  * Row 1: "Hdlt:OFF  Sw:A     " (Headlights + Switch state)
  * Row 2: "Temp:25.3°C         " (Temperature)
- * Row 3: "                    " (Reserved/empty)
+ * Row 3: "OBC 12/34% S380 H98k" (OBC core loads, min stack, free heap)
  */
 void renderControlPage(xr4_system_context_t* ctx) {
     // Row 0: Joystick X & Y (no title, more space)
@@ -422,37 +432,60 @@ void renderControlPage(xr4_system_context_t* ctx) {
     printTemperature(5, 2, ctx->temp);
     lcd.print("          ");  // Clear remainder
     
-    // Row 3: Reserved/empty
-    lcd.setCursor(0, 3);
-    lcd.print("                    ");  // Clear entire row
+    // Row 3: OBC runtime statistics from HK telemetry, "--" until the first HK frame
+    // C<core0>/<core1> load %, S<least free stack> bytes, H<free heap> kB;
+    // worst case "C100/100 S9999 H999k" is exactly LCD_COLUMNS wide
+    char row[LCD_COLUMNS + 1];
+    if (!SN_ESPNOW_HasOBCHousekeeping()) {
+        printPaddedRow(3, "C--/-- S-- H--");
+        return;
+    }
+    const telemetry_HK_data_t &hk = SN_ESPNOW_GetOBCHousekeeping();
+    char load0[4], load1[4];
+    if (hk.CPU_Load_Core0 == 0xFF) strcpy(load0, "--"); else snprintf(load0, sizeof(load0), "%u", (unsigned)hk.CPU_Load_Core0);
+    if (hk.CPU_Load_Core1 == 0xFF) strcpy(load1, "--"); else snprintf(load1, sizeof(load1), "%u", (unsigned)hk.CPU_Load_Core1);
+    unsigned stack = hk.Min_Stack_Free > 9999 ? 9999 : hk.Min_Stack_Free;
+    unsigned heap_kb = hk.Heap_Free_KB > 999 ? 999 : hk.Heap_Free_KB;
+    snprintf(row, sizeof(row), "C%s/%s S%u H%uk", load0, load1, stack, heap_kb);
+    printPaddedRow(3, row);
 }
 
 void renderDiagnosticsPage() {
-    // Row 0: Title
-    lcd.setCursor(0, 0);
-    lcd.print("  << DIAGNOSTICS >> ");
-    
-    // Row 1: Telemetry packets received
-    lcd.setCursor(0, 1);
-    lcd.print("RX: ");
-    lcd.print(SN_ESPNOW_GetTelemetryPacketsReceived());
-    lcd.print("     ");  // Clear remainder
-    
-    // Row 2: Telecommand packets sent and failures
-    lcd.setCursor(0, 2);
-    lcd.print("TX: ");
-    lcd.print(SN_ESPNOW_GetTelecommandPacketsSent());
-    lcd.print(" Fail: ");
-    lcd.print(SN_ESPNOW_GetTelecommandSendFailures());
-    lcd.print("     ");  // Clear remainder
-    
-    // Row 3: Uptime in minutes
-    lcd.setCursor(0, 3);
-    lcd.print("Uptime: ");
-    unsigned long uptime_minutes = millis() / 60000;
-    lcd.print(uptime_minutes);
-    lcd.print(" min");
-    lcd.print("          ");  // Clear remainder
+    const LinkStats &tm = SN_ESPNOW_GetTelemetryLinkStats();
+    const LatencyHistogram &rtt = SN_ESPNOW_GetRoundTripLatency();
+    char row[LCD_COLUMNS + 1];
+
+    // Row 0: Title with downlink jitter and duplicate count
+    snprintf(row, sizeof(row), "DIAG J:%luus D:%lu",
+             (unsigned long)tm.jitterUs(),
+             (unsigned long)tm.duplicates());
+    printPaddedRow(0, row);
+    
+    // Row 1: Telemetry received, downlink loss (%) and longest loss burst
+    snprintf(row, sizeof(row), "RX:%lu L:%.1f%% B:%lu",
+             (unsigned long)SN_ESPNOW_GetTelemetryPacketsReceived(),
+             tm.lossPermille() / 10.0f,
+             (unsigned long)tm.maxBurstLoss());
+    printPaddedRow(1, row);
+    
+    // Row 2: Telecommands sent, send failures and uplink loss reported by the OBC
+    snprintf(row, sizeof(row), "TX:%lu F:%lu U:%.1f%%",
+             (unsigned long)SN_ESPNOW_GetTelecommandPacketsSent(),
+             (unsigned long)SN_ESPNOW_GetTelecommandSendFailures(),
+             SN_ESPNOW_GetTelecommandLossPermille() / 10.0f);
+    printPaddedRow(2, row);
+    
+    // Row 3: Round-trip time p50/p95/p99/max in milliseconds
+    if (rtt.count() == 0) {
+        printPaddedRow(3, "RTT --");
+    } else {
+        snprintf(row, sizeof(row), "RTT %.1f/%.1f/%.1f/%.0f",
+                 rtt.percentileUs(50) / 1000.0f,
+                 rtt.percentileUs(95) / 1000.0f,
+                 rtt.percentileUs(99) / 1000.0f,
+                 rtt.maxUs() / 1000.0f);
+        printPaddedRow(3, row);
+    }
 }
 
 // ========================================
@@ -0,0 +1,191 @@
+#include <SN_LinkStats.h>
+#include <string.h>
+
+// Upper bounds (exclusive) of the jitter histogram buckets in microseconds
+static const uint32_t jitter_bucket_upper_us[LINK_STATS_JITTER_BUCKETS] = {
+    250, 500, 1000, 2000, 5000, 10000, 20000, UINT32_MAX
+};
+
+LinkStats::LinkStats() {
+    reset();
+}
+
+void LinkStats::reset() {
+    initialised_ = false;
+    highest_seq_ = 0;
+    history_ = 0;
+    have_transit_ = false;
+    last_transit_us_ = 0;
+    jitter_us_x16_ = 0;
+    received_ = 0;
+    lost_ = 0;
+    duplicates_ = 0;
+    reordered_ = 0;
+    resyncs_ = 0;
+    max_burst_loss_ = 0;
+    last_burst_loss_ = 0;
+    last_rx_time_us_ = 0;
+    memset(jitter_hist_, 0, sizeof(jitter_hist_));
+}
+
+void LinkStats::restart(uint16_t seq) {
+    initialised_ = true;
+    highest_seq_ = seq;
+    history_ = 1;
+    have_transit_ = false;  // Sender clock may have restarted as well
+}
+
+void LinkStats::onFrame(uint16_t seq, uint32_t tx_time_us, uint32_t rx_time_us) {
+    last_rx_time_us_ = rx_time_us;
+
+    if (!initialised_) {
+        restart(seq);
+        received_++;
+        updateJitter(tx_time_us, rx_time_us);
+        return;
+    }
+
+    // Signed distance from the highest sequence number seen, modulo 2^16
+    int32_t delta = (int16_t)(uint16_t)(seq - highest_seq_);
+
+    if (delta > 0 && delta <= MAX_SEQ_JUMP) {
+        // In order (possibly after a gap)
+        uint32_t gap = (uint32_t)(delta - 1);
+        if (gap > 0) {
+            lost_ += gap;
+            last_burst_loss_ = gap;
+            if (gap > max_burst_loss_) max_burst_loss_ = gap;
+        }
+        history_ = (delta >= HISTORY_WINDOW) ? 1 : ((history_ << delta) | 1);
+        highest_seq_ = seq;
+    } else if (delta <= 0 && delta > -HISTORY_WINDOW) {
+        // Already-seen or late frame inside the history window
+        uint32_t bit = 1UL << (uint32_t)(-delta);
+        if (history_ & bit) {
+            duplicates_++;
+            return;
+        }
+        history_ |= bit;
+        reordered_++;
+        if (lost_ > 0) lost_--;     // It was counted as lost when the gap opened
+    } else if (delta <= 0 && delta > -MAX_SEQ_JUMP) {
+        // Too old to tell a duplicate from a reorder; drop it from the stats
+        duplicates_++;
+        return;
+    } else {
+        // Large jump either way: sender restarted its counter
+        resyncs_++;
+        restart(seq);
+    }
+
+    received_++;
+    updateJitter(tx_time_us, rx_time_us);
+}
+
+void LinkStats::updateJitter(uint32_t tx_time_us, uint32_t rx_time_us) {
+    // Relative transit time; the unknown clock offset cancels in the difference
+    uint32_t transit = rx_time_us - tx_time_us;
+    if (!have_transit_) {
+        have_transit_ = true;
+        last_transit_us_ = transit;
+        return;
+    }
+
+    int32_t d = (int32_t)(transit - last_transit_us_);
+    last_transit_us_ = transit;
+    uint32_t abs_d = (d < 0) ? (uint32_t)(-(int64_t)d) : (uint32_t)d;
+
+    // J += (|D| - J) / 16, kept scaled by 16 to stay in integers. A single
+    // outlier (e.g. the sender stalling) is capped so it cannot overflow J.
+    uint32_t sample = (abs_d > MAX_JITTER_SAMPLE_US) ? MAX_JITTER_SAMPLE_US : abs_d;
+    jitter_us_x16_ += sample - (jitter_us_x16_ >> 4);
+
+    for (uint8_t i = 0; i < LINK_STATS_JITTER_BUCKETS; i++) {
+        if (abs_d < jitter_bucket_upper_us[i] || i == LINK_STATS_JITTER_BUCKETS - 1) {
+            jitter_hist_[i]++;
+            break;
+        }
+    }
+}
+
+uint16_t LinkStats::lossPermille() const {
+    uint32_t expected = received_ + lost_;
+    if (expected == 0) return 0;
+    return (uint16_t)(((uint64_t)lost_ * 1000 + expected / 2) / expected);
+}
+
+uint32_t LinkStats::jitterBucket(uint8_t index) const {
+    return index < LINK_STATS_JITTER_BUCKETS ? jitter_hist_[index] : 0;
+}
+
+uint32_t LinkStats::jitterBucketUpperUs(uint8_t index) {
+    return index < LINK_STATS_JITTER_BUCKETS ? jitter_bucket_upper_us[index] : UINT32_MAX;
+}
+
+// ----------------- LatencyHistogram -----------------
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    memset(buckets_, 0, sizeof(buckets_));
+    count_ = 0;
+    min_us_ = UINT32_MAX;
+    max_us_ = 0;
+    sum_us_ = 0;
+}
+
+// Values below 2^SUB_BUCKET_BITS map 1:1; above that, each power of two
+// 2^e gets SUB_BUCKETS equal-width buckets selected by the bits below the MSB
+uint16_t LatencyHistogram::bucketIndex(uint32_t value_us) {
+    if (value_us > LATENCY_HIST_MAX_US) value_us = LATENCY_HIST_MAX_US;
+    if (value_us < LATENCY_HIST_SUB_BUCKETS) return (uint16_t)value_us;
+
+    uint8_t exponent = 31 - __builtin_clz(value_us);
+    uint8_t shift = exponent - LATENCY_HIST_SUB_BUCKET_BITS;
+    uint32_t sub = (value_us >> shift) & (LATENCY_HIST_SUB_BUCKETS - 1);
+    return (uint16_t)(LATENCY_HIST_SUB_BUCKETS * (shift + 1) + sub);
+}
+
+uint32_t LatencyHistogram::bucketLowerUs(uint16_t index) {
+    if (index < LATENCY_HIST_SUB_BUCKETS) return index;
+    uint8_t shift = index / LATENCY_HIST_SUB_BUCKETS - 1;
+    uint32_t sub = index % LATENCY_HIST_SUB_BUCKETS;
+    return (LATENCY_HIST_SUB_BUCKETS + sub) << shift;
+}
+
+uint32_t LatencyHistogram::bucketUpperUs(uint16_t index) {
+    return (index + 1 < LATENCY_HIST_BUCKETS) ? bucketLowerUs(index + 1) - 1 : LATENCY_HIST_MAX_US;
+}
+
+void LatencyHistogram::record(uint32_t latency_us) {
+    buckets_[bucketIndex(latency_us)]++;
+    count_++;
+    sum_us_ += latency_us;
+    if (latency_us < min_us_) min_us_ = latency_us;
+    if (latency_us > max_us_) max_us_ = latency_us;
+}
+
+uint32_t LatencyHistogram::percentileUs(float percent) const {
+    uint32_t total = count_;
+    if (total == 0) return 0;
+    if (percent <= 0.0f) return minUs();
+    if (percent >= 100.0f) return max_us_;
+
+    // Rank of the requested sample (1-based, rounded up)
+    uint32_t rank = (uint32_t)((percent / 100.0f) * total + 0.999f);
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            // Report the bucket midpoint, clamped to the exact observed range
+            uint32_t mid = bucketLowerUs(i) + (bucketUpperUs(i) - bucketLowerUs(i)) / 2;
+            if (mid > max_us_) mid = max_us_;
+            if (mid < min_us_) mid = min_us_;
+            return mid;
+        }
+    }
+    return max_us_;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// LINK STATISTICS (one instance per receive direction)
+// ============================================================================
+// Fed with the sequence number and sender timestamp of every frame that
+// arrives on a link, and derives:
+//   - loss: gaps in the 16-bit rolling sequence; a late frame that fills a
+//     gap is taken back off the loss count and counted as reordered
+//   - burst loss: length of the longest run of consecutive missing frames
+//   - duplicates: frames whose sequence number was already seen
+//   - jitter: RFC 3550 style interarrival jitter estimate plus a histogram of
+//     the per-frame transit-time variation |D|
+//
+// The sender and receiver clocks are not synchronised; only differences of
+// transit times are used, so the constant clock offset cancels out.
+//
+// onFrame() is called from the ESP-NOW receive callback, getters from the
+// main loop. Each counter is a 32-bit value and reads are atomic on the
+// ESP32, so a getter may be one frame behind another but never torn.
+//
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+#define LINK_STATS_JITTER_BUCKETS 8
+
+class LinkStats {
+public:
+    LinkStats();
+
+    // Forget all history and counters
+    void reset();
+
+    /**
+     * Account for one received frame.
+     * seq:        sequence number from the frame header
+     * tx_time_us: sender timestamp from the frame header
+     * rx_time_us: local receive timestamp (low 32 bits of esp_timer_get_time())
+     */
+    void onFrame(uint16_t seq, uint32_t tx_time_us, uint32_t rx_time_us);
+
+    uint32_t received() const { return received_; }         // Unique frames accepted
+    uint32_t lost() const { return lost_; }
+    uint32_t duplicates() const { return duplicates_; }
+    uint32_t reordered() const { return reordered_; }
+    uint32_t resyncs() const { return resyncs_; }           // Sequence jumps treated as a sender restart
+    uint32_t maxBurstLoss() const { return max_burst_loss_; }
+    uint32_t lastBurstLoss() const { return last_burst_loss_; }
+    uint32_t lastRxTimeUs() const { return last_rx_time_us_; }
+
+    // Loss rate over the whole session, in permille (0..1000)
+    uint16_t lossPermille() const;
+
+    // Smoothed interarrival jitter estimate in microseconds
+    uint32_t jitterUs() const { return jitter_us_x16_ >> 4; }
+
+    // Histogram of |D| per frame; bucket i counts values below
+    // jitterBucketUpperUs(i), the last bucket is open-ended
+    uint32_t jitterBucket(uint8_t index) const;
+    static uint32_t jitterBucketUpperUs(uint8_t index);
+
+private:
+    // Width of the window used to tell duplicates from late (reordered) frames
+    static const int32_t HISTORY_WINDOW = 32;
+    // Sequence jumps larger than this are treated as a sender restart
+    static const int32_t MAX_SEQ_JUMP = 3000;
+    // Cap on a single |D| sample fed into the jitter estimate
+    static const uint32_t MAX_JITTER_SAMPLE_US = 1000000;
+
+    void restart(uint16_t seq);
+    void updateJitter(uint32_t tx_time_us, uint32_t rx_time_us);
+
+    bool initialised_;
+    uint16_t highest_seq_;
+    uint32_t history_;          // Bit n set: frame (highest_seq_ - n) was received
+
+    bool have_transit_;
+    uint32_t last_transit_us_;
+    uint32_t jitter_us_x16_;    // Jitter estimate scaled by 16 (RFC 3550 gain of 1/16)
+
+    uint32_t received_;
+    uint32_t lost_;
+    uint32_t duplicates_;
+    uint32_t reordered_;
+    uint32_t resyncs_;
+    uint32_t max_burst_loss_;
+    uint32_t last_burst_loss_;
+    uint32_t last_rx_time_us_;
+    uint32_t jitter_hist_[LINK_STATS_JITTER_BUCKETS];
+};
+
+// ============================================================================
+// LATENCY HISTOGRAM (streaming percentile estimator)
+// ============================================================================
+// Fixed-memory log-linear histogram of latency samples in microseconds.
+// Each power of two is split into LATENCY_HIST_SUB_BUCKETS linear
+// sub-buckets, so a reported percentile is within 1/8 (12.5 %) of the true
+// value over the whole range 1 us .. LATENCY_HIST_MAX_US. Larger samples
+// land in the top bucket; min/max/mean are tracked exactly.
+//
+// record() is called from the ESP-NOW receive callback and the getters from
+// the main loop. A percentile read while a sample is being recorded may be
+// off by that one sample, which is fine for display purposes.
+// ============================================================================
+
+#define LATENCY_HIST_SUB_BUCKET_BITS 3
+#define LATENCY_HIST_SUB_BUCKETS (1 << LATENCY_HIST_SUB_BUCKET_BITS)
+#define LATENCY_HIST_MAX_EXPONENT 24                // 2^24 us ~ 16.8 s
+#define LATENCY_HIST_MAX_US ((1UL << LATENCY_HIST_MAX_EXPONENT) - 1)
+#define LATENCY_HIST_BUCKETS (LATENCY_HIST_SUB_BUCKETS * (LATENCY_HIST_MAX_EXPONENT - LATENCY_HIST_SUB_BUCKET_BITS + 1))
+
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void reset();
+    void record(uint32_t latency_us);
+
+    uint32_t count() const { return count_; }
+    uint32_t minUs() const { return count_ ? min_us_ : 0; }
+    uint32_t maxUs() const { return max_us_; }
+    uint32_t meanUs() const { return count_ ? (uint32_t)(sum_us_ / count_) : 0; }
+
+    // Estimated latency below which `percent` % of samples fall (0 if empty)
+    uint32_t percentileUs(float percent) const;
+
+private:
+    static uint16_t bucketIndex(uint32_t value_us);
+    static uint32_t bucketLowerUs(uint16_t index);
+    static uint32_t bucketUpperUs(uint16_t index);
+
+    uint32_t buckets_[LATENCY_HIST_BUCKETS];
+    uint32_t count_;
+    uint32_t min_us_;
+    uint32_t max_us_;
+    uint64_t sum_us_;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ============================================================================
+// LOCK-FREE SINGLE-PRODUCER / SINGLE-CONSUMER QUEUE
+// ============================================================================
+// Fixed-capacity ring buffer for handing data from exactly one producer
+// context (e.g. the ESP-NOW receive callback on the WiFi task) to exactly one
+// consumer context (e.g. the OBC main loop) without locks or disabling
+// interrupts.
+//
+// The producer owns head_, the consumer owns tail_. A slot is written before
+// head_ is published with release ordering, and the consumer reads head_ with
+// acquire ordering, so a popped element is never seen half-written.
+//
+// One slot is always left empty to tell "full" from "empty", so the queue
+// holds at most N - 1 elements. N must be a power of two.
+//
+// A full queue rejects the new item; the producer cannot reclaim the oldest
+// slot without racing the consumer's copy of it. State that must never be
+// lost (e.g. the newest E-STOP/ARM flags) is kept beside the queue in a
+// single atomic word by the producer.
+//
+// Kept free of Arduino/FreeRTOS dependencies so it can be built on the host.
+// ============================================================================
+
+template <typename T, size_t N>
+class SN_SPSC_Queue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SN_SPSC_Queue capacity must be a power of two");
+
+public:
+    SN_SPSC_Queue() : head_(0), tail_(0), overflows_(0) {}
+
+    /**
+     * Producer side. Copies item into the queue.
+     * Returns false (and counts an overflow) if the queue is full; the new item
+     * is dropped and the queued ones are kept.
+     */
+    bool push(const T &item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) & MASK;
+        if (next == tail_.load(std::memory_order_acquire)) {
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[head] = item;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side. Moves the oldest item into out.
+     * Returns false if the queue is empty (out is left untouched).
+     */
+    bool pop(T &out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = slots_[tail];
+        tail_.store((tail + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called from either side while the other is active
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return (head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire)) & MASK;
+    }
+
+    static constexpr size_t capacity() { return N - 1; }
+
+    // Number of pushes rejected because the queue was full
+    uint32_t overflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MASK = N - 1;
+
+    T slots_[N];
+    std::atomic<size_t> head_;      // Next slot to write (producer)
+    std::atomic<size_t> tail_;      // Next slot to read (consumer)
+    std::atomic<uint32_t> overflows_;
+};
@@ -6,7 +6,7 @@
 Motor::Motor(mcpwm_unit_t unit, mcpwm_timer_t timer)
     : unit(unit), timer(timer) {}
 
-void Motor::initPWM(uint32_t frequency) {
+void Motor::initPWMImpl(uint32_t frequency) {
     mcpwm_config_t config = {
         .frequency = frequency,
         .cmpr_a = 0,    // Start with 0% duty cycle
@@ -19,66 +19,53 @@ void Motor::initPWM(uint32_t frequency) {
     // Explicitly ensure both outputs are LOW after init
     mcpwm_set_signal_low(unit, timer, MCPWM_OPR_A);
     mcpwm_set_signal_low(unit, timer, MCPWM_OPR_B);
+    appliedDirection = DIR_STOPPED;
+    appliedDuty = 0.0f;
 }
 
-void Motor::driveForward(float dutyPercent) {
-    mcpwm_set_signal_low(unit, timer, MCPWM_OPR_B);
-    mcpwm_set_duty(unit, timer, MCPWM_OPR_A, dutyPercent);
-    mcpwm_set_duty_type(unit, timer, MCPWM_OPR_A, MCPWM_DUTY_MODE_0);
-}
+void Motor::drive(Direction direction, mcpwm_generator_t active, mcpwm_generator_t idle, float dutyPercent) {
+    driverStats.commands++;
 
-void Motor::driveBackward(float dutyPercent) {
-    mcpwm_set_signal_low(unit, timer, MCPWM_OPR_A);
-    mcpwm_set_duty(unit, timer, MCPWM_OPR_B, dutyPercent);
-    mcpwm_set_duty_type(unit, timer, MCPWM_OPR_B, MCPWM_DUTY_MODE_0);
+    if (appliedDirection == direction) {
+        if (appliedDuty == dutyPercent) {
+            driverStats.skipped++;
+            return;
+        }
+        // Same direction: the generator actions are already set, only move the comparator
+        mcpwm_set_duty(unit, timer, active, dutyPercent);
+        driverStats.driver_calls += 1;
+        driverStats.duty_updates++;
+    } else {
+        mcpwm_set_signal_low(unit, timer, idle);
+        mcpwm_set_duty(unit, timer, active, dutyPercent);
+        mcpwm_set_duty_type(unit, timer, active, MCPWM_DUTY_MODE_0);
+        driverStats.driver_calls += 3;
+        driverStats.direction_changes++;
+        appliedDirection = direction;
+    }
+    appliedDuty = dutyPercent;
 }
 
-void Motor::stop() {
-    mcpwm_set_signal_low(unit, timer, MCPWM_OPR_A);
-    mcpwm_set_signal_low(unit, timer, MCPWM_OPR_B);
+void Motor::driveForwardImpl(float dutyPercent) {
+    drive(DIR_FORWARD, MCPWM_OPR_A, MCPWM_OPR_B, dutyPercent);
 }
 
-MotorGroup::MotorGroup(IMotor& motor1, IMotor& motor2)
-    : m1(motor1), m2(motor2) {}
-
-void MotorGroup::init(uint32_t frequency) {
-    m1.initPWM(frequency);
-    m2.initPWM(frequency);
+void Motor::driveBackwardImpl(float dutyPercent) {
+    drive(DIR_BACKWARD, MCPWM_OPR_B, MCPWM_OPR_A, dutyPercent);
 }
 
-void MotorGroup::drive(int16_t speedPercent) {
-    // Clamp speed to valid range [-100, 100]
-    if (speedPercent > 100) speedPercent = 100;
-    if (speedPercent < -100) speedPercent = -100;
-    
-    if (speedPercent > 0) {
-        m1.driveForward(speedPercent);
-        m2.driveForward(speedPercent);
-    } else if (speedPercent < 0) {
-        m1.driveBackward(-speedPercent);
-        m2.driveBackward(-speedPercent);
-    } else {
-        stop();
-    }
-    currentSpeed = speedPercent;
-}
-
-void MotorGroup::driveWithRamp(int16_t targetSpeed, uint32_t stepDelayMs, int16_t stepSize) {
-    while (currentSpeed != targetSpeed) {
-        if (abs(currentSpeed - targetSpeed) < stepSize) {
-            currentSpeed = targetSpeed;
-        } else {
-            currentSpeed += (targetSpeed > currentSpeed) ? stepSize : -stepSize;
-        }
-        drive(currentSpeed);
-        vTaskDelay(pdMS_TO_TICKS(stepDelayMs));
+void Motor::stopImpl() {
+    driverStats.commands++;
+    if (appliedDirection == DIR_STOPPED) {
+        driverStats.skipped++;
+        return;
     }
-}
-
-void MotorGroup::stop() {
-    m1.stop();
-    m2.stop();
-    currentSpeed = 0;
+    mcpwm_set_signal_low(unit, timer, MCPWM_OPR_A);
+    mcpwm_set_signal_low(unit, timer, MCPWM_OPR_B);
+    driverStats.driver_calls += 2;
+    driverStats.direction_changes++;
+    appliedDirection = DIR_STOPPED;
+    appliedDuty = 0.0f;
 }
 
 void MotorGPIO::init() {
@@ -9,15 +9,10 @@
 
 #include "soc/mcpwm_periph.h"
 
+#include "MotorBase.h"
 
-// ------ Pin Definitions --------
 
-// PWM Frequency Configuration for Motor Control
-// Lower frequency (1-5kHz) = Higher torque, more power delivery, audible whine
-// Medium frequency (10-20kHz) = Balanced performance, mostly silent
-// Higher frequency (25-40kHz) = Smooth operation, lower efficiency
-// Recommendation: Start with 10kHz for maximum speed, adjust based on performance
-#define MOTOR_PWM_FREQUENCY 10000  // Default: 10kHz for high power delivery
+// ------ Pin Definitions --------
 
 // Motor 1 - Left Front
 #define M1_LF_PWM0A_OUT 32   //Set GPIO 32 as PWM0A
@@ -40,46 +35,38 @@
 
 // ------ Class Definitions --------
 
-class IMotor {
-public:
-    virtual void initPWM(uint32_t frequency = MOTOR_PWM_FREQUENCY) = 0;
-    virtual void driveForward(float dutyPercent) = 0;
-    virtual void driveBackward(float dutyPercent) = 0;
-    virtual void stop() = 0;
-    virtual ~IMotor() = default;
-};
-
-class Motor : public IMotor {
+// MCPWM backend (see MotorBase.h for the interface).
+// Caches the applied direction and duty and only touches the MCPWM driver on
+// change: a new duty in the same direction only rewrites the comparator,
+// a new direction also reconfigures the generators.
+class Motor : public MotorBase<Motor> {
 public:
     Motor(mcpwm_unit_t unit, mcpwm_timer_t timer);
 
-    void initPWM(uint32_t frequency = MOTOR_PWM_FREQUENCY) override;
-    void driveForward(float dutyPercent) override;
-    void driveBackward(float dutyPercent) override;
-    void stop() override;
+    const motor_driver_stats_t& stats() const { return driverStats; }
 
 private:
-    mcpwm_unit_t unit;
-    mcpwm_timer_t timer;
-};
+    friend class MotorBase<Motor>;
 
-class MotorGroup {
-public:
-    MotorGroup(IMotor& motor1, IMotor& motor2);
+    void initPWMImpl(uint32_t frequency);
+    void driveForwardImpl(float dutyPercent);
+    void driveBackwardImpl(float dutyPercent);
+    void stopImpl();
 
-    void init(uint32_t frequency = MOTOR_PWM_FREQUENCY);
-    void drive(int16_t speedPercent);
-    void stop();
+    enum Direction : uint8_t { DIR_UNKNOWN, DIR_STOPPED, DIR_FORWARD, DIR_BACKWARD };
 
-    // Acceleration profile
-    void driveWithRamp(int16_t targetSpeed, uint32_t stepDelayMs = 10, int16_t stepSize = 5);
+    mcpwm_unit_t unit;
+    mcpwm_timer_t timer;
 
-private:
-    IMotor& m1;
-    IMotor& m2;
-    int16_t currentSpeed = 0;
+    Direction appliedDirection = DIR_UNKNOWN;
+    float appliedDuty = 0.0f;
+    motor_driver_stats_t driverStats = {};
+
+    void drive(Direction direction, mcpwm_generator_t active, mcpwm_generator_t idle, float dutyPercent);
 };
 
+typedef MotorGroupT<Motor> MotorGroup;
+
 class MotorGPIO {
 public:
     static void init(); // Initializes all motor GPIOs
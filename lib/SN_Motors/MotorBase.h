@@ -0,0 +1,137 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+#include "SlewRateLimiter.h"
+
+// ============================================================================
+// STATIC-DISPATCH MOTOR STACK
+// ============================================================================
+// MotorBase<Derived> is the motor interface, resolved at compile time (CRTP):
+// a backend derives from MotorBase<Backend> and provides
+//   initPWMImpl(frequency), driveForwardImpl(duty), driveBackwardImpl(duty),
+//   stopImpl()
+// MotorGroupT<MotorT> drives two motors of the same backend as one side of
+// the rover. It holds the motors by concrete type, so the whole drive path
+// can be inlined; there are no virtual calls on the ESP32.
+//
+// Backends:
+//   Motor    (Motor.h)    - ESP32 MCPWM, used by SN_Motors
+//   SimMotor (SimMotor.h) - host simulation, records a duty/direction timeline
+//
+// Kept free of Arduino/ESP-IDF dependencies so it can be built on the host.
+// ============================================================================
+
+// PWM Frequency Configuration for Motor Control
+// Lower frequency (1-5kHz) = Higher torque, more power delivery, audible whine
+// Medium frequency (10-20kHz) = Balanced performance, mostly silent
+// Higher frequency (25-40kHz) = Smooth operation, lower efficiency
+// Recommendation: Start with 10kHz for maximum speed, adjust based on performance
+#ifndef MOTOR_PWM_FREQUENCY
+#define MOTOR_PWM_FREQUENCY 10000  // Default: 10kHz for high power delivery
+#endif
+
+// Driver call accounting for one or more motors
+typedef struct {
+    uint32_t commands;          // driveForward/driveBackward/stop calls
+    uint32_t skipped;           // Commands that matched the applied output (no driver call)
+    uint32_t duty_updates;      // Same direction, comparator-only update
+    uint32_t direction_changes; // Full generator reconfiguration
+    uint32_t driver_calls;      // Driver calls issued
+} motor_driver_stats_t;
+
+template <typename Derived>
+class MotorBase {
+public:
+    void initPWM(uint32_t frequency = MOTOR_PWM_FREQUENCY) { self().initPWMImpl(frequency); }
+    void driveForward(float dutyPercent) { self().driveForwardImpl(dutyPercent); }
+    void driveBackward(float dutyPercent) { self().driveBackwardImpl(dutyPercent); }
+    void stop() { self().stopImpl(); }
+
+protected:
+    MotorBase() = default;
+    ~MotorBase() = default;
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+template <typename MotorT>
+class MotorGroupT {
+public:
+    MotorGroupT(MotorT& motor1, MotorT& motor2)
+        : m1(motor1), m2(motor2) {}
+
+    void init(uint32_t frequency = MOTOR_PWM_FREQUENCY) {
+        m1.initPWM(frequency);
+        m2.initPWM(frequency);
+    }
+
+    // Apply speedPercent immediately (the ramp continues from here)
+    void drive(int16_t speedPercent) {
+        stage(speedPercent);
+        commit();
+    }
+
+    // Stop immediately, bypassing the ramp
+    void stop() {
+        stageStop();
+        commit();
+    }
+
+    // Acceleration profile: advance one control tick of dt_s seconds towards
+    // targetSpeed within the ramp limits. Non-blocking, call once per tick.
+    void driveRamped(int16_t targetSpeed, float dt_s) {
+        stageRamped(targetSpeed, dt_s);
+        commit();
+    }
+    void setRampLimits(const slew_limits_t& limits) { ramp.setLimits(limits); }
+
+    // Batched update: stage*() only works out the next speed, commit() writes
+    // it to the motors. Lets several groups be committed back to back.
+    void stage(int16_t speedPercent) {
+        speedPercent = clamp(speedPercent);
+        ramp.reset(speedPercent);
+        stagedSpeed = speedPercent;
+    }
+
+    void stageRamped(int16_t targetSpeed, float dt_s) {
+        stagedSpeed = (int16_t)lroundf(ramp.step(clamp(targetSpeed), dt_s));
+    }
+
+    void stageStop() {
+        ramp.reset(0);
+        stagedSpeed = 0;
+    }
+
+    void commit() {
+        int16_t speedPercent = stagedSpeed;
+        if (speedPercent > 0) {
+            m1.driveForward(speedPercent);
+            m2.driveForward(speedPercent);
+        } else if (speedPercent < 0) {
+            m1.driveBackward(-speedPercent);
+            m2.driveBackward(-speedPercent);
+        } else {
+            m1.stop();
+            m2.stop();
+        }
+        currentSpeed = speedPercent;
+    }
+
+    int16_t speed() const { return currentSpeed; }
+
+private:
+    MotorT& m1;
+    MotorT& m2;
+    int16_t currentSpeed = 0;
+    int16_t stagedSpeed = 0;
+    SlewRateLimiter ramp{{MOTOR_RAMP_ACCEL_PCT_PER_S, MOTOR_RAMP_DECEL_PCT_PER_S, MOTOR_RAMP_JERK_PCT_PER_S2}};
+
+    // Clamp speed to valid range [-100, 100]
+    static int16_t clamp(int16_t speedPercent) {
+        if (speedPercent > 100) return 100;
+        if (speedPercent < -100) return -100;
+        return speedPercent;
+    }
+};
@@ -10,23 +10,116 @@ Motor rightRear(MCPWM_UNIT_1, MCPWM_TIMER_1);
 MotorGroup leftMotors(leftFront, leftRear);
 MotorGroup rightMotors(rightFront, rightRear);
 
+// ----------------------------------------------------------------------------
+// Synchronised four-motor updates
+// ----------------------------------------------------------------------------
+// The legacy MCPWM driver writes duty values to the comparator shadow
+// registers, which the hardware loads when the timer counts through zero
+// (TEZ). If all four timers run in phase, every duty written between two TEZ
+// events takes effect on the same period boundary.
+//  - Phase: SN_Motors_Init soft-syncs all four timers back to back with
+//    interrupts off. Both units run from the same clock with the same period,
+//    so they stay in phase afterwards.
+//  - Commit: both groups are staged first, then written together inside one
+//    critical section so nothing can be scheduled between the left and right
+//    writes. The window is measured in CPU cycles; as long as it is short
+//    against the PWM period (100 us at 10 kHz) the writes share a boundary
+//    except when one happens to fall inside the window.
+// Direction changes force the generator outputs directly and are not
+// shadowed; they happen at most once per reversal.
+
+static portMUX_TYPE motorCommitMux = portMUX_INITIALIZER_UNLOCKED;
+static motor_commit_stats_t commitStats = {};
+
+static void alignPwmTimers() {
+    const mcpwm_unit_t units[] = { MCPWM_UNIT_0, MCPWM_UNIT_1 };
+    const mcpwm_timer_t timers[] = { MCPWM_TIMER_0, MCPWM_TIMER_1 };
+
+    mcpwm_sync_config_t sync_conf = {
+        .sync_sig = MCPWM_SELECT_NO_INPUT,  // Software sync only
+        .timer_val = 0,                     // Restart from the beginning of the period
+        .count_direction = MCPWM_TIMER_DIRECTION_UP,
+    };
+    for (mcpwm_unit_t unit : units) {
+        for (mcpwm_timer_t timer : timers) {
+            mcpwm_sync_configure(unit, timer, &sync_conf);
+        }
+    }
+
+    uint32_t start = ESP.getCycleCount();
+    portENTER_CRITICAL(&motorCommitMux);
+    for (mcpwm_unit_t unit : units) {
+        for (mcpwm_timer_t timer : timers) {
+            mcpwm_timer_trigger_soft_sync(unit, timer);
+        }
+    }
+    portEXIT_CRITICAL(&motorCommitMux);
+    commitStats.sync_window_cycles = ESP.getCycleCount() - start;
+}
+
+static void commitStaged() {
+    uint32_t start = ESP.getCycleCount();
+    portENTER_CRITICAL(&motorCommitMux);
+    leftMotors.commit();
+    rightMotors.commit();
+    portEXIT_CRITICAL(&motorCommitMux);
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    commitStats.commits++;
+    commitStats.last_window_cycles = cycles;
+    if (cycles > commitStats.max_window_cycles) commitStats.max_window_cycles = cycles;
+}
+
 void SN_Motors_Init() {
     MotorGPIO::init();
     leftMotors.init();
     rightMotors.init();
+    alignPwmTimers();
     // Ensure motors start in stopped state
     leftMotors.stop();
     rightMotors.stop();
-    logMessage(true, "SN_Motors_Init", "Motors initialized and stopped");
+    logMessage(true, "SN_Motors_Init", "Motors initialized and stopped (PWM timers aligned in %lu cycles)",
+               (unsigned long)commitStats.sync_window_cycles);
 }
 
 void SN_Motors_Drive(int16_t leftSpeed, int16_t rightSpeed) {
     // Direct drive - no logging for maximum responsiveness
-    leftMotors.drive(leftSpeed);
-    rightMotors.drive(rightSpeed);
+    leftMotors.stage(leftSpeed);
+    rightMotors.stage(rightSpeed);
+    commitStaged();
+}
+
+void SN_Motors_DriveRamped(int16_t leftSpeed, int16_t rightSpeed, float dt_s) {
+    leftMotors.stageRamped(leftSpeed, dt_s);
+    rightMotors.stageRamped(rightSpeed, dt_s);
+    commitStaged();
 }
 
 void SN_Motors_Stop() {
-    leftMotors.stop();
-    rightMotors.stop();
+    leftMotors.stageStop();
+    rightMotors.stageStop();
+    commitStaged();
+}
+
+void SN_Motors_GetAppliedSpeeds(int16_t *leftSpeed, int16_t *rightSpeed) {
+    *leftSpeed = leftMotors.speed();
+    *rightSpeed = rightMotors.speed();
+}
+
+motor_commit_stats_t SN_Motors_GetCommitStats() {
+    return commitStats;
+}
+
+motor_driver_stats_t SN_Motors_GetDriverStats() {
+    motor_driver_stats_t total = {};
+    const Motor* motors[] = { &leftFront, &leftRear, &rightFront, &rightRear };
+    for (const Motor* motor : motors) {
+        const motor_driver_stats_t& s = motor->stats();
+        total.commands += s.commands;
+        total.skipped += s.skipped;
+        total.duty_updates += s.duty_updates;
+        total.direction_changes += s.direction_changes;
+        total.driver_calls += s.driver_calls;
+    }
+    return total;
 }
\ No newline at end of file
@@ -1,12 +1,32 @@
 #pragma once
 #include <Arduino.h>
+#include "Motor.h"
 
 
 
 // ------ Function Prototypes --------
+// After SN_Motors_Init() the OBC control task is the only caller: the motor
+// caches, ramps and staged duties are not locked against a second task.
 void SN_Motors_Init();
 void SN_Motors_Drive(int16_t leftSpeed, int16_t rightSpeed);
+// One control tick of dt_s seconds towards the target speeds, within the ramp limits
+void SN_Motors_DriveRamped(int16_t leftSpeed, int16_t rightSpeed, float dt_s);
 void SN_Motors_Stop();
+// Speeds written by the last commit (after the ramp), percent
+void SN_Motors_GetAppliedSpeeds(int16_t *leftSpeed, int16_t *rightSpeed);
+
+// Driver call accounting summed over all four motors
+motor_driver_stats_t SN_Motors_GetDriverStats();
+
+// Timing of the synchronised four-motor commit, in CPU cycles
+typedef struct {
+    uint32_t commits;               // Drive/DriveRamped/Stop commits
+    uint32_t last_window_cycles;    // Time from first to last motor write
+    uint32_t max_window_cycles;
+    uint32_t sync_window_cycles;    // Spread of the init-time PWM timer soft sync
+} motor_commit_stats_t;
+
+motor_commit_stats_t SN_Motors_GetCommitStats();
 
 
 
@@ -0,0 +1,107 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "MotorBase.h"
+
+// ============================================================================
+// HOST SIMULATION MOTOR BACKEND
+// ============================================================================
+// Drop-in for Motor (same MotorBase interface) that records what the drive
+// path asks of the hardware instead of touching MCPWM:
+//   - timeline(): every change of direction or duty, stamped with the time
+//     of the shared SimClock
+//   - stats():    the same driver call accounting as Motor, using the same
+//     change detection, so a host run shows how many MCPWM calls the
+//     firmware would make
+//
+//   SimClock clock;
+//   SimMotor lf(clock), lr(clock);
+//   MotorGroupT<SimMotor> left(lf, lr);
+//   left.driveRamped(100, 0.004f); clock.advance(4000); ...
+//
+// Not used by the firmware; header-only so it costs nothing on the ESP32.
+// ============================================================================
+
+struct SimClock {
+    uint64_t now_us = 0;
+    void advance(uint64_t us) { now_us += us; }
+};
+
+class SimMotor : public MotorBase<SimMotor> {
+public:
+    enum Direction : uint8_t { DIR_UNKNOWN, DIR_STOPPED, DIR_FORWARD, DIR_BACKWARD };
+
+    struct Event {
+        uint64_t time_us;
+        Direction direction;
+        float duty;             // Percent, 0 while stopped
+    };
+
+    explicit SimMotor(const SimClock& clock) : clock(clock) {}
+
+    const std::vector<Event>& timeline() const { return events; }
+    const motor_driver_stats_t& stats() const { return driverStats; }
+    uint32_t frequency() const { return pwmFrequency; }
+
+    Direction direction() const { return appliedDirection; }
+    float duty() const { return appliedDuty; }
+
+    // Signed duty in percent: positive forward, negative backward
+    float signedDuty() const {
+        return appliedDirection == DIR_BACKWARD ? -appliedDuty : appliedDuty;
+    }
+
+    void clearTimeline() { events.clear(); }
+
+private:
+    friend class MotorBase<SimMotor>;
+
+    void initPWMImpl(uint32_t frequencyHz) {
+        pwmFrequency = frequencyHz;
+        apply(DIR_STOPPED, 0.0f, 0);    // Motor does not count init either
+    }
+
+    void driveForwardImpl(float dutyPercent) { command(DIR_FORWARD, dutyPercent); }
+    void driveBackwardImpl(float dutyPercent) { command(DIR_BACKWARD, dutyPercent); }
+
+    void stopImpl() {
+        driverStats.commands++;
+        if (appliedDirection == DIR_STOPPED) {
+            driverStats.skipped++;
+            return;
+        }
+        driverStats.direction_changes++;
+        apply(DIR_STOPPED, 0.0f, 2);
+    }
+
+    // Mirrors Motor::drive: same change detection and driver call cost
+    void command(Direction direction, float dutyPercent) {
+        driverStats.commands++;
+        if (appliedDirection == direction) {
+            if (appliedDuty == dutyPercent) {
+                driverStats.skipped++;
+                return;
+            }
+            driverStats.duty_updates++;
+            apply(direction, dutyPercent, 1);
+        } else {
+            driverStats.direction_changes++;
+            apply(direction, dutyPercent, 3);
+        }
+    }
+
+    void apply(Direction direction, float dutyPercent, uint32_t driverCalls) {
+        driverStats.driver_calls += driverCalls;
+        appliedDirection = direction;
+        appliedDuty = dutyPercent;
+        events.push_back({clock.now_us, direction, dutyPercent});
+    }
+
+    const SimClock& clock;
+    uint32_t pwmFrequency = 0;
+    Direction appliedDirection = DIR_UNKNOWN;
+    float appliedDuty = 0.0f;
+    motor_driver_stats_t driverStats = {};
+    std::vector<Event> events;
+};
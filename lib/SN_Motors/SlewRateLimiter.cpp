@@ -0,0 +1,65 @@
+#include "SlewRateLimiter.h"
+#include <math.h>
+
+SlewRateLimiter::SlewRateLimiter(const slew_limits_t &limits)
+    : limits_(limits), value_(0.0f), rate_(0.0f) {}
+
+void SlewRateLimiter::reset(float value) {
+    value_ = value;
+    rate_ = 0.0f;
+}
+
+float SlewRateLimiter::step(float target, float dt_s) {
+    if (dt_s <= 0.0f) {
+        return value_;
+    }
+
+    float err = target - value_;
+    if (err == 0.0f && rate_ == 0.0f) {
+        return value_;
+    }
+
+    // Moving away from zero accelerates; towards (or through) zero decelerates.
+    // A reversal is limited to reaching zero on this tick.
+    bool accelerating = (value_ == 0.0f) || ((err > 0.0f) == (value_ > 0.0f));
+    float limit = accelerating ? limits_.accel_pct_per_s : limits_.decel_pct_per_s;
+    float goal = target;
+    if (!accelerating && ((target > 0.0f) != (value_ > 0.0f)) && target != 0.0f) {
+        goal = 0.0f;
+        err = -value_;
+    }
+
+    // Desired rate: reach the goal this tick if allowed, capped by the limit
+    float desired = err / dt_s;
+    if (limit > 0.0f) {
+        if (desired > limit) desired = limit;
+        else if (desired < -limit) desired = -limit;
+    }
+
+    float jerk = limits_.jerk_pct_per_s2;
+    if (jerk > 0.0f) {
+        // Brake the rate early enough to arrive without overshoot
+        float brake = sqrtf(2.0f * jerk * fabsf(err));
+        if (desired > brake) desired = brake;
+        else if (desired < -brake) desired = -brake;
+
+        float max_change = jerk * dt_s;
+        float change = desired - rate_;
+        if (change > max_change) change = max_change;
+        else if (change < -max_change) change = -max_change;
+        rate_ += change;
+    } else {
+        rate_ = desired;
+    }
+
+    float next = value_ + rate_ * dt_s;
+
+    // Never step past the goal
+    if ((err >= 0.0f && next >= goal) || (err <= 0.0f && next <= goal)) {
+        next = goal;
+        rate_ = 0.0f;
+    }
+
+    value_ = next;
+    return value_;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+// ============================================================================
+// SLEW-RATE / JERK LIMITER (one per drive side)
+// ============================================================================
+// Non-blocking replacement for the old MotorGroup::driveWithRamp loop: the
+// caller hands in the target speed once per control tick and gets back the
+// speed to apply for this tick.
+//   - accel_pct_per_s: limit while |speed| grows
+//   - decel_pct_per_s: limit while |speed| shrinks (a reversal first
+//                      decelerates to 0, then accelerates the other way)
+//   - jerk_pct_per_s2: limit on the change of the rate itself
+// A limit of 0 disables that limit.
+// reset() sets the output immediately, bypassing all limits (E-STOP, stop).
+//
+// Speeds are in percent (-100..100). Kept free of Arduino dependencies so
+// it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef MOTOR_RAMP_ACCEL_PCT_PER_S
+#define MOTOR_RAMP_ACCEL_PCT_PER_S 500.0f   // 0 -> 100 % in 200 ms (old driveWithRamp: 5 % / 10 ms)
+#endif
+
+#ifndef MOTOR_RAMP_DECEL_PCT_PER_S
+#define MOTOR_RAMP_DECEL_PCT_PER_S 1000.0f  // 100 -> 0 % in 100 ms
+#endif
+
+#ifndef MOTOR_RAMP_JERK_PCT_PER_S2
+#define MOTOR_RAMP_JERK_PCT_PER_S2 0.0f     // Disabled
+#endif
+
+typedef struct {
+    float accel_pct_per_s;
+    float decel_pct_per_s;
+    float jerk_pct_per_s2;
+} slew_limits_t;
+
+class SlewRateLimiter {
+public:
+    explicit SlewRateLimiter(const slew_limits_t &limits);
+
+    void setLimits(const slew_limits_t &limits) { limits_ = limits; }
+    const slew_limits_t &limits() const { return limits_; }
+
+    // Advance one tick of dt_s seconds towards target and return the new output
+    float step(float target, float dt_s);
+
+    // Jump to value immediately and forget the current rate
+    void reset(float value = 0.0f);
+
+    float output() const { return value_; }
+    float rate() const { return rate_; }
+
+private:
+    slew_limits_t limits_;
+    float value_;
+    float rate_;        // %/s applied in the last step
+};
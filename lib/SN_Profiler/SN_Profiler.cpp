@@ -0,0 +1,58 @@
+#include <SN_Profiler.h>
+#include <stdio.h>
+
+StageProfiler::StageProfiler(const char *const *names, uint8_t stage_count, uint32_t ticks_per_us)
+    : names_(names),
+      stage_count_(stage_count < PROFILER_MAX_STAGES ? stage_count : PROFILER_MAX_STAGES),
+      ticks_per_us_(ticks_per_us ? ticks_per_us : 1),
+      reset_requested_(false) {
+}
+
+void StageProfiler::clear() {
+    for (uint8_t i = 0; i < stage_count_; i++) {
+        stages_[i].reset();
+    }
+    reset_requested_ = false;
+}
+
+void StageProfiler::record(uint8_t stage, uint32_t ticks) {
+    if (reset_requested_) clear();
+    if (stage >= stage_count_) return;
+
+    // 32-bit only: a 64-bit division is a library call on the ESP32
+    uint32_t scaled = (ticks < UINT32_MAX / PROFILER_SUBDIV)
+                      ? ticks * PROFILER_SUBDIV / ticks_per_us_
+                      : ticks / ticks_per_us_ * PROFILER_SUBDIV;
+    stages_[stage].record(scaled);
+}
+
+const char *StageProfiler::stageName(uint8_t stage) const {
+    return (stage < stage_count_ && names_[stage] != nullptr) ? names_[stage] : "?";
+}
+
+// 1/8 us -> "123.4"
+static void formatUs(char *out, size_t size, uint32_t value) {
+    uint32_t tenths = (uint32_t)(((uint64_t)value * 10 + PROFILER_SUBDIV / 2) / PROFILER_SUBDIV);
+    snprintf(out, size, "%lu.%lu", (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+}
+
+void StageProfiler::dump(profiler_print_t print) const {
+    char line[128];
+    char min_s[16], mean_s[16], p50_s[16], p99_s[16], max_s[16];
+
+    snprintf(line, sizeof(line), "%-16s %8s %10s %10s %10s %10s %10s",
+             "stage", "count", "min_us", "mean_us", "p50_us", "p99_us", "max_us");
+    print(line);
+
+    for (uint8_t i = 0; i < stage_count_; i++) {
+        const LatencyHistogram &h = stages_[i];
+        formatUs(min_s, sizeof(min_s), h.minUs());
+        formatUs(mean_s, sizeof(mean_s), h.meanUs());
+        formatUs(p50_s, sizeof(p50_s), h.percentileUs(50));
+        formatUs(p99_s, sizeof(p99_s), h.percentileUs(99));
+        formatUs(max_s, sizeof(max_s), h.maxUs());
+        snprintf(line, sizeof(line), "%-16s %8lu %10s %10s %10s %10s %10s",
+                 stageName(i), (unsigned long)h.count(), min_s, mean_s, p50_s, p99_s, max_s);
+        print(line);
+    }
+}
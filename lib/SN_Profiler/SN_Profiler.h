@@ -0,0 +1,115 @@
+#pragma once
+#include <stdint.h>
+#include <SN_LinkStats.h>
+
+// ============================================================================
+// PER-STAGE LOOP PROFILER
+// ============================================================================
+// Times the fixed stages of a handler with scoped probes:
+//
+//   {
+//       SN_PROFILE_STAGE(profiler, OBC_STAGE_READ_SENSORS);
+//       SN_OBC_ReadSensors();
+//   }
+//
+// A probe reads the CPU cycle counter (CCOUNT) on the target and
+// std::chrono::steady_clock (nanoseconds) on the host when it is created and
+// when it goes out of scope. Per stage it keeps count, min, mean and max and
+// a log-linear histogram (LatencyHistogram) for percentiles. Durations are
+// stored in 1/8 us so sub-microsecond stages still resolve; the histogram
+// covers up to ~2 s, longer samples land in its top bucket (max stays exact).
+//
+// Cost per probe is two counter reads, one 32-bit division and the
+// histogram update (a few dozen cycles on the target, under 1 % of a
+// handler pass that does any I/O).
+//
+// CCOUNT is per core: a probe must start and end on the same core, which
+// holds for tasks pinned to one core (loopTask). record() must only be
+// called from one task; dump() may run in another (a value can be one
+// sample behind) and reset() only raises a flag that the recording task
+// acts on at its next sample.
+//
+// Build with -D SN_PROFILER_ENABLED=0 to compile the probes out.
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_PROFILER_ENABLED
+#define SN_PROFILER_ENABLED 1
+#endif
+
+#define PROFILER_MAX_STAGES 8
+#define PROFILER_SUBDIV 8           // Stored resolution: 1/8 us
+
+#if defined(ARDUINO)
+#include "hal/cpu_hal.h"
+static inline uint32_t SN_Profiler_Ticks() { return cpu_hal_get_cycle_count(); }
+#else
+#include <chrono>
+static inline uint32_t SN_Profiler_Ticks() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// Receives one formatted line (without newline) per call
+typedef void (*profiler_print_t)(const char *line);
+
+class StageProfiler {
+public:
+    /**
+     * names:        one name per stage, indexed by stage id (kept by pointer)
+     * stage_count:  at most PROFILER_MAX_STAGES
+     * ticks_per_us: counter rate, CPU MHz on the target, 1000 on the host
+     */
+    StageProfiler(const char *const *names, uint8_t stage_count, uint32_t ticks_per_us);
+
+    void setTicksPerUs(uint32_t ticks_per_us) { ticks_per_us_ = ticks_per_us ? ticks_per_us : 1; }
+
+    void record(uint8_t stage, uint32_t ticks);
+
+    // Clear all stages before the next record()
+    void reset() { reset_requested_ = true; }
+
+    uint8_t stageCount() const { return stage_count_; }
+    const char *stageName(uint8_t stage) const;
+
+    // Statistics in 1/PROFILER_SUBDIV us
+    const LatencyHistogram &stage(uint8_t stage) const { return stages_[stage < stage_count_ ? stage : 0]; }
+
+    // One line per stage: count, min / mean / p50 / p99 / max in us
+    void dump(profiler_print_t print) const;
+
+private:
+    void clear();
+
+    const char *const *names_;
+    uint8_t stage_count_;
+    uint32_t ticks_per_us_;
+    volatile bool reset_requested_;
+    LatencyHistogram stages_[PROFILER_MAX_STAGES];
+};
+
+class ProfileProbe {
+public:
+    ProfileProbe(StageProfiler &profiler, uint8_t stage)
+        : profiler_(profiler), stage_(stage), start_(SN_Profiler_Ticks()) {}
+    ~ProfileProbe() { profiler_.record(stage_, SN_Profiler_Ticks() - start_); }
+
+    ProfileProbe(const ProfileProbe &) = delete;
+    ProfileProbe &operator=(const ProfileProbe &) = delete;
+
+private:
+    StageProfiler &profiler_;
+    uint8_t stage_;
+    uint32_t start_;
+};
+
+#define SN_PROFILE_CONCAT_(a, b) a##b
+#define SN_PROFILE_CONCAT(a, b) SN_PROFILE_CONCAT_(a, b)
+
+#if SN_PROFILER_ENABLED
+#define SN_PROFILE_STAGE(profiler, stage) ProfileProbe SN_PROFILE_CONCAT(profile_probe_, __LINE__)(profiler, stage)
+#else
+#define SN_PROFILE_STAGE(profiler, stage) do {} while (0)
+#endif
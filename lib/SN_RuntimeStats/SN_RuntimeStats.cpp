@@ -0,0 +1,261 @@
+#include <Arduino.h>
+#include <SN_RuntimeStats.h>
+#include <SN_Logger.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_freertos_hooks.h"
+#include "esp_heap_caps.h"
+
+static runtime_stats_t stats_latest = {};           // Copied under stats_lock
+static runtime_stats_summary_t stats_summary = {
+  { RUNTIME_STATS_UNKNOWN, RUNTIME_STATS_UNKNOWN }, 0, 0, 0, 0, 0
+};
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t last_sample_ms = 0;
+static bool sampled_once = false;
+
+#if configUSE_TRACE_FACILITY == 1
+static TaskStatus_t task_status[RUNTIME_STATS_MAX_TASKS];
+static bool task_overflow_logged = false;
+#endif
+
+#if configGENERATE_RUN_TIME_STATS == 1
+// Run-time counters of the previous sample, matched by task handle
+static TaskHandle_t prev_handles[RUNTIME_STATS_MAX_TASKS];
+static uint32_t prev_counters[RUNTIME_STATS_MAX_TASKS];
+static UBaseType_t prev_count = 0;
+static uint32_t prev_total_runtime = 0;
+#else
+// Tick sampling: each core's tick hook records which task it interrupted.
+// The counts per task handle are swapped out once per interval.
+typedef struct {
+  TaskHandle_t handles[RUNTIME_STATS_MAX_TASKS];
+  uint32_t counts[RUNTIME_STATS_MAX_TASKS];
+  uint8_t used;
+  uint32_t total;             // Ticks sampled, including tasks that did not fit the table
+} tick_samples_t;
+
+static tick_samples_t tick_samples[portNUM_PROCESSORS];
+static tick_samples_t tick_snapshot[portNUM_PROCESSORS];   // Last interval, loop task only
+static portMUX_TYPE tick_lock[portNUM_PROCESSORS];
+
+static inline void IRAM_ATTR sampleTick(int core) {
+  TaskHandle_t current = xTaskGetCurrentTaskHandleForCPU(core);
+  tick_samples_t &samples = tick_samples[core];
+  portENTER_CRITICAL_ISR(&tick_lock[core]);
+  samples.total++;
+  uint8_t i = 0;
+  while (i < samples.used && samples.handles[i] != current) i++;
+  if (i == samples.used && i < RUNTIME_STATS_MAX_TASKS) {
+    samples.handles[i] = current;
+    samples.counts[i] = 0;
+    samples.used++;
+  }
+  if (i < samples.used) samples.counts[i]++;
+  portEXIT_CRITICAL_ISR(&tick_lock[core]);
+}
+
+static void IRAM_ATTR tickHookCore0() { sampleTick(0); }
+#if portNUM_PROCESSORS > 1
+static void IRAM_ATTR tickHookCore1() { sampleTick(1); }
+#endif
+#endif
+
+bool SN_RuntimeStats_Init() {
+#if configGENERATE_RUN_TIME_STATS == 1
+  logMessage(false, "RuntimeStats", "Using FreeRTOS run-time counters");
+  return true;
+#else
+  for (int core = 0; core < portNUM_PROCESSORS; core++) portMUX_INITIALIZE(&tick_lock[core]);
+  bool ok = esp_register_freertos_tick_hook_for_cpu(tickHookCore0, 0) == ESP_OK;
+#if portNUM_PROCESSORS > 1
+  ok = ok && esp_register_freertos_tick_hook_for_cpu(tickHookCore1, 1) == ESP_OK;
+#endif
+  if (!ok) {
+    logMessage(true, "RuntimeStats", "Failed to register tick hooks - CPU load unavailable");
+  } else {
+    logMessage(false, "RuntimeStats", "Run-time counters disabled in sdkconfig - CPU load sampled at the tick");
+  }
+  return ok;
+#endif
+}
+
+#if configGENERATE_RUN_TIME_STATS != 1
+// Swap out the tick samples of the interval that just ended
+static void takeTickSnapshot() {
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    portENTER_CRITICAL(&tick_lock[core]);
+    tick_snapshot[core] = tick_samples[core];
+    tick_samples[core].used = 0;
+    tick_samples[core].total = 0;
+    portEXIT_CRITICAL(&tick_lock[core]);
+  }
+}
+
+// Share of one core over the last interval, or RUNTIME_STATS_UNKNOWN
+static uint8_t tickShare(TaskHandle_t handle) {
+  uint32_t ticks = 0, interval_ticks = 0;
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    const tick_samples_t &samples = tick_snapshot[core];
+    if (samples.total > interval_ticks) interval_ticks = samples.total;
+    for (uint8_t i = 0; i < samples.used; i++) {
+      if (samples.handles[i] == handle) ticks += samples.counts[i];
+    }
+  }
+  if (interval_ticks == 0) return RUNTIME_STATS_UNKNOWN;
+  uint32_t pct = (uint32_t)((uint64_t)ticks * 100 / interval_ticks);
+  return (uint8_t)(pct > 100 ? 100 : pct);
+}
+
+static void sampleTickLoad(runtime_stats_t &sample) {
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    const tick_samples_t &samples = tick_snapshot[core];
+    if (samples.total == 0) continue;
+    TaskHandle_t idle = xTaskGetIdleTaskHandleForCPU(core);
+    uint32_t idle_ticks = 0;
+    for (uint8_t i = 0; i < samples.used; i++) {
+      if (samples.handles[i] == idle) idle_ticks = samples.counts[i];
+    }
+    sample.summary.cpu_load_pct[core] = (uint8_t)((uint64_t)(samples.total - idle_ticks) * 100 / samples.total);
+  }
+}
+#endif
+
+#if configUSE_TRACE_FACILITY == 1
+static void sampleTasks(runtime_stats_t &sample) {
+  uint32_t total_runtime = 0;
+  UBaseType_t count = uxTaskGetSystemState(task_status, RUNTIME_STATS_MAX_TASKS, &total_runtime);
+  if (count == 0 && !task_overflow_logged) {
+    logMessage(true, "RuntimeStats", "More than %d tasks - raise RUNTIME_STATS_MAX_TASKS", RUNTIME_STATS_MAX_TASKS);
+    task_overflow_logged = true;
+  }
+
+#if configGENERATE_RUN_TIME_STATS == 1
+  uint32_t total_delta = total_runtime - prev_total_runtime;
+  bool have_previous = prev_total_runtime != 0 && total_delta > 0;
+#endif
+
+  sample.task_count = (uint8_t)count;
+  sample.summary.min_stack_free = UINT32_MAX;
+  for (UBaseType_t i = 0; i < count; i++) {
+    const TaskStatus_t &status = task_status[i];
+    runtime_task_stats_t &task = sample.tasks[i];
+
+    strncpy(task.name, status.pcTaskName, RUNTIME_STATS_NAME_LEN - 1);
+    task.name[RUNTIME_STATS_NAME_LEN - 1] = '\0';
+    BaseType_t affinity = xTaskGetAffinity(status.xHandle);
+    task.core = (affinity == tskNO_AFFINITY) ? RUNTIME_STATS_NO_AFFINITY : (uint8_t)affinity;
+    task.priority = (uint8_t)status.uxCurrentPriority;
+    task.stack_free_min = status.usStackHighWaterMark;    // Bytes on ESP-IDF
+    task.cpu_pct = RUNTIME_STATS_UNKNOWN;
+
+#if configGENERATE_RUN_TIME_STATS == 1
+    if (have_previous) {
+      for (UBaseType_t j = 0; j < prev_count; j++) {
+        if (prev_handles[j] != status.xHandle) continue;
+        uint32_t delta = status.ulRunTimeCounter - prev_counters[j];
+        uint32_t pct = (uint32_t)((uint64_t)delta * 100 / total_delta);
+        task.cpu_pct = (uint8_t)(pct > 100 ? 100 : pct);
+        break;
+      }
+      for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (status.xHandle == xTaskGetIdleTaskHandleForCPU(core) && task.cpu_pct != RUNTIME_STATS_UNKNOWN) {
+          sample.summary.cpu_load_pct[core] = (uint8_t)(100 - task.cpu_pct);
+        }
+      }
+    }
+    prev_handles[i] = status.xHandle;
+    prev_counters[i] = status.ulRunTimeCounter;
+#else
+    task.cpu_pct = tickShare(status.xHandle);
+#endif
+
+    if (task.stack_free_min < sample.summary.min_stack_free) {
+      sample.summary.min_stack_free = task.stack_free_min;
+      sample.summary.min_stack_task = (uint8_t)i;
+    }
+  }
+  if (count == 0) sample.summary.min_stack_free = 0;
+
+#if configGENERATE_RUN_TIME_STATS == 1
+  prev_count = count;
+  prev_total_runtime = total_runtime;
+#endif
+}
+#endif
+
+void SN_RuntimeStats_Update() {
+  uint32_t now_ms = millis();
+  if (sampled_once && now_ms - last_sample_ms < SN_RUNTIME_STATS_INTERVAL_MS) return;
+  last_sample_ms = now_ms;
+
+  static runtime_stats_t sample;    // Kept off the loop task stack
+  memset(&sample, 0, sizeof(sample));
+  sample.sample_time_ms = now_ms;
+  for (int core = 0; core < 2; core++) sample.summary.cpu_load_pct[core] = RUNTIME_STATS_UNKNOWN;
+
+#if configGENERATE_RUN_TIME_STATS != 1
+  takeTickSnapshot();
+  sampleTickLoad(sample);
+#endif
+#if configUSE_TRACE_FACILITY == 1
+  sampleTasks(sample);
+#endif
+
+  sample.summary.heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  sample.summary.heap_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  sample.summary.heap_largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+
+  stats_summary = sample.summary;
+  portENTER_CRITICAL(&stats_lock);
+  stats_latest = sample;
+  portEXIT_CRITICAL(&stats_lock);
+  sampled_once = true;
+}
+
+const runtime_stats_summary_t &SN_RuntimeStats_GetSummary() {
+  return stats_summary;
+}
+
+void SN_RuntimeStats_Get(runtime_stats_t &out) {
+  portENTER_CRITICAL(&stats_lock);
+  out = stats_latest;
+  portEXIT_CRITICAL(&stats_lock);
+}
+
+// "45" or "--"
+static const char* formatPct(char *buf, size_t size, uint8_t pct) {
+  if (pct == RUNTIME_STATS_UNKNOWN) return "--";
+  snprintf(buf, size, "%u", (unsigned)pct);
+  return buf;
+}
+
+void SN_RuntimeStats_Print(runtime_stats_print_t print) {
+  static runtime_stats_t copy;
+  SN_RuntimeStats_Get(copy);
+
+  char line[96];
+  char pct0[8], pct1[8], pct[8];
+  snprintf(line, sizeof(line), "cpu core0 %s%% core1 %s%%  heap free %lu min %lu largest %lu",
+           formatPct(pct0, sizeof(pct0), copy.summary.cpu_load_pct[0]),
+           formatPct(pct1, sizeof(pct1), copy.summary.cpu_load_pct[1]),
+           (unsigned long)copy.summary.heap_free, (unsigned long)copy.summary.heap_min_free,
+           (unsigned long)copy.summary.heap_largest_block);
+  print(line);
+
+  snprintf(line, sizeof(line), "%-16s %4s %4s %4s %10s", "task", "core", "prio", "cpu%", "stack_free");
+  print(line);
+  for (uint8_t i = 0; i < copy.task_count; i++) {
+    const runtime_task_stats_t &task = copy.tasks[i];
+    char core[4];
+    if (task.core == RUNTIME_STATS_NO_AFFINITY) strcpy(core, "*");
+    else snprintf(core, sizeof(core), "%u", (unsigned)task.core);
+    snprintf(line, sizeof(line), "%-16s %4s %4u %4s %10lu", task.name, core, (unsigned)task.priority,
+             formatPct(pct, sizeof(pct), task.cpu_pct), (unsigned long)task.stack_free_min);
+    print(line);
+  }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+
+// ============================================================================
+// RUNTIME STATISTICS (CPU load, task stacks, heap)
+// ============================================================================
+// Sampled every SN_RUNTIME_STATS_INTERVAL_MS from loop():
+//   - CPU load per core and per task (see "CPU time source" below)
+//   - stack high-water mark (least free stack ever seen) per task
+//   - free / minimum-ever-free heap and the largest free block
+//
+// CPU time source:
+//   - configGENERATE_RUN_TIME_STATS == 1: per-task run-time counter deltas;
+//     core load is 100 % minus the share of that core's IDLE task
+//   - otherwise (the prebuilt Arduino sdkconfig): a tick hook on each core
+//     records the task it interrupted. A task's share is its ticks over the
+//     interval's ticks, and core load is 100 % minus the IDLE task's share.
+//     This is statistical: 1000 samples per core per second at the default
+//     tick rate, and a task that wakes on a tick and finishes before the
+//     next one is under-counted. The idle tasks still execute WAITI.
+//
+// A compact summary goes into the HK telemetry (telemetry_HK_data_t); the
+// full per-task table is printed by the "stats" serial console command.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_RUNTIME_STATS_INTERVAL_MS
+#define SN_RUNTIME_STATS_INTERVAL_MS 1000
+#endif
+
+#define RUNTIME_STATS_MAX_TASKS 24
+#define RUNTIME_STATS_NAME_LEN 16
+#define RUNTIME_STATS_UNKNOWN 0xFF          // CPU share / load not measured
+#define RUNTIME_STATS_NO_AFFINITY 0xFF      // Task may run on either core
+
+typedef struct {
+    char name[RUNTIME_STATS_NAME_LEN];
+    uint8_t core;               // Pinned core or RUNTIME_STATS_NO_AFFINITY
+    uint8_t priority;
+    uint8_t cpu_pct;            // Share of one core over the last interval, or RUNTIME_STATS_UNKNOWN
+    uint32_t stack_free_min;    // Bytes, high-water mark
+} runtime_task_stats_t;
+
+typedef struct {
+    uint8_t cpu_load_pct[2];    // Per core, or RUNTIME_STATS_UNKNOWN before the first interval
+    uint32_t min_stack_free;    // Smallest stack_free_min over all tasks
+    uint8_t min_stack_task;     // Index into the full table of that task
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    uint32_t heap_largest_block;
+} runtime_stats_summary_t;
+
+typedef struct {
+    uint32_t sample_time_ms;
+    runtime_stats_summary_t summary;
+    uint8_t task_count;
+    runtime_task_stats_t tasks[RUNTIME_STATS_MAX_TASKS];
+} runtime_stats_t;
+
+// Receives one formatted line (without newline) per call
+typedef void (*runtime_stats_print_t)(const char *line);
+
+// Install the tick hooks (when run-time counters are not available)
+bool SN_RuntimeStats_Init();
+
+// Call every loop pass; samples once per SN_RUNTIME_STATS_INTERVAL_MS
+void SN_RuntimeStats_Update();
+
+// Latest summary (same task as SN_RuntimeStats_Update)
+const runtime_stats_summary_t &SN_RuntimeStats_GetSummary();
+
+// Copy of the latest full sample (any task)
+void SN_RuntimeStats_Get(runtime_stats_t &out);
+
+// Full per-task table (any task)
+void SN_RuntimeStats_Print(runtime_stats_print_t print);
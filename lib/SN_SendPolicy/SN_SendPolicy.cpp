@@ -0,0 +1,83 @@
+#include <SN_SendPolicy.h>
+#include <string.h>
+
+static uint16_t absDiff(uint16_t a, uint16_t b) {
+    return (a > b) ? (a - b) : (b - a);
+}
+
+TelecommandSendPolicy::TelecommandSendPolicy(const tc_send_policy_config_t &config)
+    : config_(config), has_sent_(false), last_sent_ms_(0),
+      has_rest_(false), rest_x_(0), rest_y_(0), rest_since_ms_(0) {
+    last_sent_ = telecommand_data_t();
+    memset(sent_count_, 0, sizeof(sent_count_));
+}
+
+tc_send_reason_t TelecommandSendPolicy::evaluate(telecommand_data_t &tc, uint32_t now_ms) {
+    // Restart the rest timer whenever the stick moves beyond the noise band
+    if (!has_rest_ ||
+        absDiff(tc.Joystick_X, rest_x_) > config_.joystick_still_threshold ||
+        absDiff(tc.Joystick_Y, rest_y_) > config_.joystick_still_threshold) {
+        has_rest_ = true;
+        rest_x_ = tc.Joystick_X;
+        rest_y_ = tc.Joystick_Y;
+        rest_since_ms_ = now_ms;
+    }
+
+    bool centred = absDiff(tc.Joystick_X, config_.neutral_x) <= config_.neutral_deadband &&
+                   absDiff(tc.Joystick_Y, config_.neutral_y) <= config_.neutral_deadband;
+    bool settled = centred || (now_ms - rest_since_ms_ >= config_.settle_ms);
+    if (settled) {
+        tc.flags |= config_.settled_flag_mask;
+    } else {
+        tc.flags &= ~config_.settled_flag_mask;
+    }
+
+    // Nothing sent yet: announce ourselves straight away
+    if (!has_sent_) {
+        return TC_SEND_HEARTBEAT;
+    }
+
+    // The settled flag has its own rule below; on its own it is not an input change
+    uint16_t changed_flags = (tc.flags ^ last_sent_.flags) & ~config_.settled_flag_mask;
+    if (changed_flags & config_.safety_flags_mask) {
+        return TC_SEND_SAFETY_EDGE;
+    }
+
+    uint32_t elapsed_ms = now_ms - last_sent_ms_;
+    if (elapsed_ms < config_.min_gap_ms) {
+        return TC_SEND_NONE;
+    }
+
+    if (changed_flags != 0 || tc.Command != last_sent_.Command || tc.Encoder_Pos != last_sent_.Encoder_Pos) {
+        return TC_SEND_INPUT_CHANGE;
+    }
+
+    if (absDiff(tc.Joystick_X, last_sent_.Joystick_X) >= config_.joystick_delta_threshold ||
+        absDiff(tc.Joystick_Y, last_sent_.Joystick_Y) >= config_.joystick_delta_threshold) {
+        return TC_SEND_JOYSTICK_DELTA;
+    }
+
+    // Trailing frame: the OBC has only seen the stick moving so far
+    if (config_.settled_flag_mask != 0 && settled && !(last_sent_.flags & config_.settled_flag_mask)) {
+        return TC_SEND_SETTLED;
+    }
+
+    if (elapsed_ms >= config_.heartbeat_ms) {
+        return TC_SEND_HEARTBEAT;
+    }
+
+    return TC_SEND_NONE;
+}
+
+void TelecommandSendPolicy::onSent(const telecommand_data_t &tc, uint32_t now_ms, tc_send_reason_t reason) {
+    has_sent_ = true;
+    last_sent_ms_ = now_ms;
+    last_sent_ = tc;
+    if (reason < TC_SEND_REASON_COUNT) {
+        sent_count_[reason]++;
+    }
+}
+
+uint32_t TelecommandSendPolicy::sentCount(tc_send_reason_t reason) const {
+    return (reason < TC_SEND_REASON_COUNT) ? sent_count_[reason] : 0;
+}
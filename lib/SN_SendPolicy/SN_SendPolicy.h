@@ -0,0 +1,103 @@
+#pragma once
+#include <stdint.h>
+#include <SN_ESPNOW_Messages.h>
+
+// ============================================================================
+// TELECOMMAND SEND POLICY (CTU)
+// ============================================================================
+// Decides, once per CTU loop pass, whether the current telecommand should go
+// out now instead of on a fixed 50 Hz clock:
+//   - safety edge:    any change of a flag in safety_flags_mask (E-STOP, ARM)
+//                     is sent immediately, ignoring the minimum gap
+//   - input change:   other flags, command or encoder position changed
+//   - joystick delta: either axis moved by joystick_delta_threshold ADC
+//                     counts or more since the last transmitted value
+//   - settled:        one trailing frame once the stick has rested (moved no
+//                     more than joystick_still_threshold) for settle_ms, or
+//                     as soon as it is back in the neutral deadband, so the
+//                     final position does not wait for the next heartbeat
+//   - heartbeat:      nothing changed for heartbeat_ms, so the OBC link
+//                     watchdog and statistics still see traffic
+// Apart from safety edges, frames are never closer than min_gap_ms.
+//
+// evaluate() also sets settled_flag_mask in the telecommand while the stick
+// rests or is centred, and clears it once it moves. The OBC holds the newest
+// joystick sample of a settled frame instead of extrapolating it, so silence
+// after a settled frame means "hold", not "frame late".
+//
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef TC_SEND_MIN_GAP_MS
+#define TC_SEND_MIN_GAP_MS 5
+#endif
+
+#ifndef TC_SEND_HEARTBEAT_MS
+#define TC_SEND_HEARTBEAT_MS 100
+#endif
+
+#ifndef TC_SEND_JOYSTICK_THRESHOLD
+#define TC_SEND_JOYSTICK_THRESHOLD 24       // ADC counts out of 4095
+#endif
+
+#ifndef TC_SEND_SETTLE_MS
+#define TC_SEND_SETTLE_MS 20
+#endif
+
+#ifndef TC_SEND_JOYSTICK_STILL_THRESHOLD
+#define TC_SEND_JOYSTICK_STILL_THRESHOLD 8  // ADC counts of noise tolerated while resting
+#endif
+
+typedef enum {
+    TC_SEND_NONE = 0,
+    TC_SEND_SAFETY_EDGE,
+    TC_SEND_INPUT_CHANGE,
+    TC_SEND_JOYSTICK_DELTA,
+    TC_SEND_SETTLED,
+    TC_SEND_HEARTBEAT,
+    TC_SEND_REASON_COUNT
+} tc_send_reason_t;
+
+typedef struct {
+    uint32_t min_gap_ms;
+    uint32_t heartbeat_ms;
+    uint16_t joystick_delta_threshold;
+    uint16_t safety_flags_mask;         // telecommand_data_t::flags bits that bypass min_gap_ms
+    uint32_t settle_ms;
+    uint16_t joystick_still_threshold;
+    uint16_t neutral_x;                 // Centred stick, ADC counts
+    uint16_t neutral_y;
+    uint16_t neutral_deadband;          // Counts either side of neutral that count as centred
+    uint16_t settled_flag_mask;         // telecommand_data_t::flags bit marking a settled joystick, 0 = no trailing frame
+} tc_send_policy_config_t;
+
+class TelecommandSendPolicy {
+public:
+    explicit TelecommandSendPolicy(const tc_send_policy_config_t &config);
+
+    // Why tc should be sent at now_ms, or TC_SEND_NONE to hold it back.
+    // Call once per loop pass: it tracks how long the stick has rested and
+    // sets or clears the settled flag in tc accordingly.
+    tc_send_reason_t evaluate(telecommand_data_t &tc, uint32_t now_ms);
+
+    // Record that tc was transmitted at now_ms for the given reason
+    void onSent(const telecommand_data_t &tc, uint32_t now_ms, tc_send_reason_t reason);
+
+    // Number of frames sent for each reason
+    uint32_t sentCount(tc_send_reason_t reason) const;
+
+    const tc_send_policy_config_t &config() const { return config_; }
+
+private:
+    tc_send_policy_config_t config_;
+    bool has_sent_;
+    uint32_t last_sent_ms_;
+    telecommand_data_t last_sent_;
+    uint32_t sent_count_[TC_SEND_REASON_COUNT];
+
+    bool has_rest_;
+    uint16_t rest_x_;                   // Where the stick came to rest
+    uint16_t rest_y_;
+    uint32_t rest_since_ms_;
+};
@@ -1,5 +1,6 @@
 #include "MPUFilter.h"
 #include <math.h>
+#include <stdint.h>
 
 #define DEFAULT_SAMPLE_FREQ	512.0f	// sample frequency in Hz
 // #define twoKiDef	(2.0f * 0.0f)	// 2 * integral gain
@@ -8,23 +9,121 @@
 #define twoKpDef	(2.0f * 1.0f)	// 2 * proportional gain
 
 //-------------------------------------------------------------------------------------------
+// Filter state, copied into locals for the duration of a batch
 
-MPUFilter::MPUFilter()
+struct MPUFilterState {
+	float q0, q1, q2, q3;
+	float integralFBx, integralFBy, integralFBz;
+};
+
+//-------------------------------------------------------------------------------------------
+// Fast inverse square-root
+
+static inline float fastInvSqrt(float x)
 {
-	twoKp = twoKpDef;	// 2 * proportional gain (Kp)
-	twoKi = twoKiDef;	// 2 * integral gain (Ki)
-	q0 = 1.0f;
-	q1 = 0.0f;
-	q2 = 0.0f;
-	q3 = 0.0f;
-	integralFBx = 0.0f;
-	integralFBy = 0.0f;
-	integralFBz = 0.0f;
-	anglesComputed = 0;
-	invSampleFreq = 1.0f / DEFAULT_SAMPLE_FREQ;
+	float halfx = 0.5f * x;
+	union { float f; int32_t l; } i;
+	i.f = x;
+	i.l = 0x5f3759df - (i.l >> 1);
+	float y = i.f;
+	y = y * (1.5f - (halfx * y * y));
+	y = y * (1.5f - (halfx * y * y));
+	return y;
 }
 
-void MPUFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz)
+template <MPUFilterNorm Norm>
+static inline float recipSqrt(float x)
+{
+	if (Norm == MPUFILTER_NORM_SQRTF) return 1.0f / sqrtf(x);
+	return fastInvSqrt(x);
+}
+
+//-------------------------------------------------------------------------------------------
+// One IMU step (gyro in deg/s, step dt in seconds)
+
+template <MPUFilterNorm Norm>
+static inline void stepIMU(MPUFilterState &s, float twoKp, float twoKi, float dt,
+                           float gx, float gy, float gz, float ax, float ay, float az)
+{
+	float recipNorm;
+	float halfvx, halfvy, halfvz;
+	float halfex, halfey, halfez;
+	float qa, qb, qc;
+
+	// Convert gyroscope degrees/sec to radians/sec
+	gx *= 0.0174533f;
+	gy *= 0.0174533f;
+	gz *= 0.0174533f;
+
+	// Compute feedback only if accelerometer measurement valid
+	// (avoids NaN in accelerometer normalisation)
+	if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+
+		// Normalise accelerometer measurement
+		recipNorm = recipSqrt<Norm>(ax * ax + ay * ay + az * az);
+		ax *= recipNorm;
+		ay *= recipNorm;
+		az *= recipNorm;
+
+		// Estimated direction of gravity
+		halfvx = s.q1 * s.q3 - s.q0 * s.q2;
+		halfvy = s.q0 * s.q1 + s.q2 * s.q3;
+		halfvz = s.q0 * s.q0 - 0.5f + s.q3 * s.q3;
+
+		// Error is sum of cross product between estimated
+		// and measured direction of gravity
+		halfex = (ay * halfvz - az * halfvy);
+		halfey = (az * halfvx - ax * halfvz);
+		halfez = (ax * halfvy - ay * halfvx);
+
+		// Compute and apply integral feedback if enabled
+		if(twoKi > 0.0f) {
+			// integral error scaled by Ki
+			s.integralFBx += twoKi * halfex * dt;
+			s.integralFBy += twoKi * halfey * dt;
+			s.integralFBz += twoKi * halfez * dt;
+			gx += s.integralFBx;	// apply integral feedback
+			gy += s.integralFBy;
+			gz += s.integralFBz;
+		} else {
+			s.integralFBx = 0.0f;	// prevent integral windup
+			s.integralFBy = 0.0f;
+			s.integralFBz = 0.0f;
+		}
+
+		// Apply proportional feedback
+		gx += twoKp * halfex;
+		gy += twoKp * halfey;
+		gz += twoKp * halfez;
+	}
+
+	// Integrate rate of change of quaternion
+	gx *= (0.5f * dt);		// pre-multiply common factors
+	gy *= (0.5f * dt);
+	gz *= (0.5f * dt);
+	qa = s.q0;
+	qb = s.q1;
+	qc = s.q2;
+	s.q0 += (-qb * gx - qc * gy - s.q3 * gz);
+	s.q1 += (qa * gx + qc * gz - s.q3 * gy);
+	s.q2 += (qa * gy - qb * gz + s.q3 * gx);
+	s.q3 += (qa * gz + qb * gy - qc * gx);
+
+	// Normalise quaternion
+	recipNorm = recipSqrt<Norm>(s.q0 * s.q0 + s.q1 * s.q1 + s.q2 * s.q2 + s.q3 * s.q3);
+	s.q0 *= recipNorm;
+	s.q1 *= recipNorm;
+	s.q2 *= recipNorm;
+	s.q3 *= recipNorm;
+}
+
+//-------------------------------------------------------------------------------------------
+// One AHRS step with magnetometer (gyro in deg/s, step dt in seconds)
+
+template <MPUFilterNorm Norm>
+static inline void stepMARG(MPUFilterState &s, float twoKp, float twoKi, float dt,
+                            float gx, float gy, float gz, float ax, float ay, float az,
+                            float mx, float my, float mz)
 {
 	float recipNorm;
 	float q0q0, q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
@@ -36,7 +135,7 @@ void MPUFilter::update(float gx, float gy, float gz, float ax, float ay, float a
 	// Use IMU algorithm if magnetometer measurement invalid
 	// (avoids NaN in magnetometer normalisation)
 	if((mx == 0.0f) && (my == 0.0f) && (mz == 0.0f)) {
-		updateIMU(gx, gy, gz, ax, ay, az);
+		stepIMU<Norm>(s, twoKp, twoKi, dt, gx, gy, gz, ax, ay, az);
 		return;
 	}
 
@@ -50,28 +149,28 @@ void MPUFilter::update(float gx, float gy, float gz, float ax, float ay, float a
 	if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
 
 		// Normalise accelerometer measurement
-		recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+		recipNorm = recipSqrt<Norm>(ax * ax + ay * ay + az * az);
 		ax *= recipNorm;
 		ay *= recipNorm;
 		az *= recipNorm;
 
 		// Normalise magnetometer measurement
-		recipNorm = invSqrt(mx * mx + my * my + mz * mz);
+		recipNorm = recipSqrt<Norm>(mx * mx + my * my + mz * mz);
 		mx *= recipNorm;
 		my *= recipNorm;
 		mz *= recipNorm;
 
 		// Auxiliary variables to avoid repeated arithmetic
-		q0q0 = q0 * q0;
-		q0q1 = q0 * q1;
-		q0q2 = q0 * q2;
-		q0q3 = q0 * q3;
-		q1q1 = q1 * q1;
-		q1q2 = q1 * q2;
-		q1q3 = q1 * q3;
-		q2q2 = q2 * q2;
-		q2q3 = q2 * q3;
-		q3q3 = q3 * q3;
+		q0q0 = s.q0 * s.q0;
+		q0q1 = s.q0 * s.q1;
+		q0q2 = s.q0 * s.q2;
+		q0q3 = s.q0 * s.q3;
+		q1q1 = s.q1 * s.q1;
+		q1q2 = s.q1 * s.q2;
+		q1q3 = s.q1 * s.q3;
+		q2q2 = s.q2 * s.q2;
+		q2q3 = s.q2 * s.q3;
+		q3q3 = s.q3 * s.q3;
 
 		// Reference direction of Earth's magnetic field
 		hx = 2.0f * (mx * (0.5f - q2q2 - q3q3) + my * (q1q2 - q0q3) + mz * (q1q3 + q0q2));
@@ -96,16 +195,16 @@ void MPUFilter::update(float gx, float gy, float gz, float ax, float ay, float a
 		// Compute and apply integral feedback if enabled
 		if(twoKi > 0.0f) {
 			// integral error scaled by Ki
-			integralFBx += twoKi * halfex * invSampleFreq;
-			integralFBy += twoKi * halfey * invSampleFreq;
-			integralFBz += twoKi * halfez * invSampleFreq;
-			gx += integralFBx;	// apply integral feedback
-			gy += integralFBy;
-			gz += integralFBz;
+			s.integralFBx += twoKi * halfex * dt;
+			s.integralFBy += twoKi * halfey * dt;
+			s.integralFBz += twoKi * halfez * dt;
+			gx += s.integralFBx;	// apply integral feedback
+			gy += s.integralFBy;
+			gz += s.integralFBz;
 		} else {
-			integralFBx = 0.0f;	// prevent integral windup
-			integralFBy = 0.0f;
-			integralFBz = 0.0f;
+			s.integralFBx = 0.0f;	// prevent integral windup
+			s.integralFBy = 0.0f;
+			s.integralFBz = 0.0f;
 		}
 
 		// Apply proportional feedback
@@ -115,117 +214,130 @@ void MPUFilter::update(float gx, float gy, float gz, float ax, float ay, float a
 	}
 
 	// Integrate rate of change of quaternion
-	gx *= (0.5f * invSampleFreq);		// pre-multiply common factors
-	gy *= (0.5f * invSampleFreq);
-	gz *= (0.5f * invSampleFreq);
-	qa = q0;
-	qb = q1;
-	qc = q2;
-	q0 += (-qb * gx - qc * gy - q3 * gz);
-	q1 += (qa * gx + qc * gz - q3 * gy);
-	q2 += (qa * gy - qb * gz + q3 * gx);
-	q3 += (qa * gz + qb * gy - qc * gx);
+	gx *= (0.5f * dt);		// pre-multiply common factors
+	gy *= (0.5f * dt);
+	gz *= (0.5f * dt);
+	qa = s.q0;
+	qb = s.q1;
+	qc = s.q2;
+	s.q0 += (-qb * gx - qc * gy - s.q3 * gz);
+	s.q1 += (qa * gx + qc * gz - s.q3 * gy);
+	s.q2 += (qa * gy - qb * gz + s.q3 * gx);
+	s.q3 += (qa * gz + qb * gy - qc * gx);
 
 	// Normalise quaternion
-	recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-	q0 *= recipNorm;
-	q1 *= recipNorm;
-	q2 *= recipNorm;
-	q3 *= recipNorm;
-	anglesComputed = 0;
+	recipNorm = recipSqrt<Norm>(s.q0 * s.q0 + s.q1 * s.q1 + s.q2 * s.q2 + s.q3 * s.q3);
+	s.q0 *= recipNorm;
+	s.q1 *= recipNorm;
+	s.q2 *= recipNorm;
+	s.q3 *= recipNorm;
 }
 
 //-------------------------------------------------------------------------------------------
-// IMU algorithm update
+// Batch loops, one instance per normalisation so the choice is made once per batch
 
-void MPUFilter::updateIMU(float gx, float gy, float gz, float ax, float ay, float az)
+template <MPUFilterNorm Norm>
+static void runIMUBatch(MPUFilterState &state, float twoKp, float twoKi, float invSampleFreq,
+                        const float gyro[][3], const float accel[][3], const float *dt, size_t count)
 {
-	float recipNorm;
-	float halfvx, halfvy, halfvz;
-	float halfex, halfey, halfez;
-	float qa, qb, qc;
+	MPUFilterState s = state;
+	for (size_t i = 0; i < count; i++) {
+		stepIMU<Norm>(s, twoKp, twoKi, dt ? dt[i] : invSampleFreq,
+		              gyro[i][0], gyro[i][1], gyro[i][2], accel[i][0], accel[i][1], accel[i][2]);
+	}
+	state = s;
+}
 
-	// Convert gyroscope degrees/sec to radians/sec
-	gx *= 0.0174533f;
-	gy *= 0.0174533f;
-	gz *= 0.0174533f;
+template <MPUFilterNorm Norm>
+static void runMARGBatch(MPUFilterState &state, float twoKp, float twoKi, float invSampleFreq,
+                         const float gyro[][3], const float accel[][3], const float mag[][3],
+                         const float *dt, size_t count)
+{
+	MPUFilterState s = state;
+	for (size_t i = 0; i < count; i++) {
+		stepMARG<Norm>(s, twoKp, twoKi, dt ? dt[i] : invSampleFreq,
+		               gyro[i][0], gyro[i][1], gyro[i][2], accel[i][0], accel[i][1], accel[i][2],
+		               mag[i][0], mag[i][1], mag[i][2]);
+	}
+	state = s;
+}
 
-	// Compute feedback only if accelerometer measurement valid
-	// (avoids NaN in accelerometer normalisation)
-	if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+//-------------------------------------------------------------------------------------------
 
-		// Normalise accelerometer measurement
-		recipNorm = invSqrt(ax * ax + ay * ay + az * az);
-		ax *= recipNorm;
-		ay *= recipNorm;
-		az *= recipNorm;
+MPUFilter::MPUFilter()
+{
+	twoKp = twoKpDef;	// 2 * proportional gain (Kp)
+	twoKi = twoKiDef;	// 2 * integral gain (Ki)
+	q0 = 1.0f;
+	q1 = 0.0f;
+	q2 = 0.0f;
+	q3 = 0.0f;
+	integralFBx = 0.0f;
+	integralFBy = 0.0f;
+	integralFBz = 0.0f;
+	anglesComputed = 0;
+	invSampleFreq = 1.0f / DEFAULT_SAMPLE_FREQ;
+	norm = MPUFILTER_NORM_FAST_INVSQRT;
+}
 
-		// Estimated direction of gravity
-		halfvx = q1 * q3 - q0 * q2;
-		halfvy = q0 * q1 + q2 * q3;
-		halfvz = q0 * q0 - 0.5f + q3 * q3;
+void MPUFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz)
+{
+	const float gyro[1][3] = { { gx, gy, gz } };
+	const float accel[1][3] = { { ax, ay, az } };
+	const float mag[1][3] = { { mx, my, mz } };
+	updateBatch(gyro, accel, mag, NULL, 1);
+}
 
-		// Error is sum of cross product between estimated
-		// and measured direction of gravity
-		halfex = (ay * halfvz - az * halfvy);
-		halfey = (az * halfvx - ax * halfvz);
-		halfez = (ax * halfvy - ay * halfvx);
+//-------------------------------------------------------------------------------------------
+// IMU algorithm update
 
-		// Compute and apply integral feedback if enabled
-		if(twoKi > 0.0f) {
-			// integral error scaled by Ki
-			integralFBx += twoKi * halfex * invSampleFreq;
-			integralFBy += twoKi * halfey * invSampleFreq;
-			integralFBz += twoKi * halfez * invSampleFreq;
-			gx += integralFBx;	// apply integral feedback
-			gy += integralFBy;
-			gz += integralFBz;
-		} else {
-			integralFBx = 0.0f;	// prevent integral windup
-			integralFBy = 0.0f;
-			integralFBz = 0.0f;
-		}
+void MPUFilter::updateIMU(float gx, float gy, float gz, float ax, float ay, float az)
+{
+	const float gyro[1][3] = { { gx, gy, gz } };
+	const float accel[1][3] = { { ax, ay, az } };
+	updateIMUBatch(gyro, accel, NULL, 1);
+}
 
-		// Apply proportional feedback
-		gx += twoKp * halfex;
-		gy += twoKp * halfey;
-		gz += twoKp * halfez;
-	}
+void MPUFilter::updateIMUBatch(const float gyro[][3], const float accel[][3], const float *dt, size_t count)
+{
+	if (count == 0) return;
 
-	// Integrate rate of change of quaternion
-	gx *= (0.5f * invSampleFreq);		// pre-multiply common factors
-	gy *= (0.5f * invSampleFreq);
-	gz *= (0.5f * invSampleFreq);
-	qa = q0;
-	qb = q1;
-	qc = q2;
-	q0 += (-qb * gx - qc * gy - q3 * gz);
-	q1 += (qa * gx + qc * gz - q3 * gy);
-	q2 += (qa * gy - qb * gz + q3 * gx);
-	q3 += (qa * gz + qb * gy - qc * gx);
+	MPUFilterState state = { q0, q1, q2, q3, integralFBx, integralFBy, integralFBz };
+	if (norm == MPUFILTER_NORM_SQRTF) {
+		runIMUBatch<MPUFILTER_NORM_SQRTF>(state, twoKp, twoKi, invSampleFreq, gyro, accel, dt, count);
+	} else {
+		runIMUBatch<MPUFILTER_NORM_FAST_INVSQRT>(state, twoKp, twoKi, invSampleFreq, gyro, accel, dt, count);
+	}
 
-	// Normalise quaternion
-	recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-	q0 *= recipNorm;
-	q1 *= recipNorm;
-	q2 *= recipNorm;
-	q3 *= recipNorm;
+	q0 = state.q0;
+	q1 = state.q1;
+	q2 = state.q2;
+	q3 = state.q3;
+	integralFBx = state.integralFBx;
+	integralFBy = state.integralFBy;
+	integralFBz = state.integralFBz;
 	anglesComputed = 0;
 }
 
-//-------------------------------------------------------------------------------------------
-// Fast inverse square-root
-
-float MPUFilter::invSqrt(float x)
+void MPUFilter::updateBatch(const float gyro[][3], const float accel[][3], const float mag[][3], const float *dt, size_t count)
 {
-	float halfx = 0.5f * x;
-	union { float f; long l; } i;
-	i.f = x;
-	i.l = 0x5f3759df - (i.l >> 1);
-	float y = i.f;
-	y = y * (1.5f - (halfx * y * y));
-	y = y * (1.5f - (halfx * y * y));
-	return y;
+	if (count == 0) return;
+
+	MPUFilterState state = { q0, q1, q2, q3, integralFBx, integralFBy, integralFBz };
+	if (norm == MPUFILTER_NORM_SQRTF) {
+		runMARGBatch<MPUFILTER_NORM_SQRTF>(state, twoKp, twoKi, invSampleFreq, gyro, accel, mag, dt, count);
+	} else {
+		runMARGBatch<MPUFILTER_NORM_FAST_INVSQRT>(state, twoKp, twoKi, invSampleFreq, gyro, accel, mag, dt, count);
+	}
+
+	q0 = state.q0;
+	q1 = state.q1;
+	q2 = state.q2;
+	q3 = state.q3;
+	integralFBx = state.integralFBx;
+	integralFBy = state.integralFBy;
+	integralFBz = state.integralFBz;
+	anglesComputed = 0;
 }
 
 //-------------------------------------------------------------------------------------------
@@ -236,4 +348,4 @@ void MPUFilter::computeAngles()
 	pitch = asinf(-2.0f * (q1*q3 - q0*q2));
 	yaw = atan2f(q1*q2 + q0*q3, 0.5f - q2*q2 - q3*q3);
 	anglesComputed = 1;
-}
\ No newline at end of file
+}
@@ -1,6 +1,17 @@
 #ifndef MPUFilter_h
 #define MPUFilter_h
 #include <math.h>
+#include <stddef.h>
+
+//--------------------------------------------------------------------------------------------
+// Normalisation used for the accelerometer, magnetometer and quaternion
+//   MPUFILTER_NORM_FAST_INVSQRT - bit-trick inverse square root, two Newton steps (default)
+//   MPUFILTER_NORM_SQRTF        - 1.0f / sqrtf(x)
+
+enum MPUFilterNorm {
+	MPUFILTER_NORM_FAST_INVSQRT,
+	MPUFILTER_NORM_SQRTF
+};
 
 //--------------------------------------------------------------------------------------------
 // Variable declaration
@@ -14,7 +25,7 @@ private:
 	float invSampleFreq;
 	float roll, pitch, yaw;
 	char anglesComputed;
-	static float invSqrt(float x);
+	MPUFilterNorm norm;
 	void computeAngles();
 
 //-------------------------------------------------------------------------------------------
@@ -23,9 +34,17 @@ private:
 public:
 	MPUFilter();
 	void begin(float sampleFrequency) { invSampleFreq = 1.0f / sampleFrequency; }
+	void setNormalisation(MPUFilterNorm mode) { norm = mode; }
 	void update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz);
 	void updateIMU(float gx, float gy, float gz, float ax, float ay, float az);
 
+	// Batch updates: count samples, gyro in deg/s. dt holds the step of each
+	// sample in seconds, or is NULL for the begin() rate. The filter state
+	// stays in locals for the whole batch. A mag sample of all zeros falls
+	// back to the IMU step, as in update().
+	void updateIMUBatch(const float gyro[][3], const float accel[][3], const float *dt, size_t count);
+	void updateBatch(const float gyro[][3], const float accel[][3], const float mag[][3], const float *dt, size_t count);
+
     // Getter functions for quaternion components
     float getQ0() const { return q0; }
     float getQ1() const { return q1; }
@@ -58,4 +77,4 @@ public:
 	}
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,169 @@
+#include "MPUFilterQ.h"
+#include <math.h>
+
+#define DEFAULT_SAMPLE_FREQ	512.0f	// sample frequency in Hz
+#define DEFAULT_GYRO_LSB_PER_DPS	131.0f	// +-250 deg/s
+#define twoKiDef	(2.0f * 0.0f)	// 2 * integral gain (as MPUFilter)
+#define twoKpDef	(2.0f * 1.0f)	// 2 * proportional gain (as MPUFilter)
+
+#define Q30_ONE		(1 << 30)
+#define Q30_HALF	(1 << 29)
+#define Q30_THREE_HALVES	(3 << 29)
+
+//-------------------------------------------------------------------------------------------
+// Q30 helpers
+
+static inline int32_t qmul(int32_t a, int32_t b)
+{
+	return (int32_t)(((int64_t)a * b + Q30_HALF) >> 30);
+}
+
+// 1 / sqrt(m) for m in [1, 4), indexed by 8 * m - 8 (interval midpoints, Q30)
+static const int32_t invSqrtSeed[24] = {
+	1041682578, 985333074, 937238702, 895562589,
+	858993459, 826566842, 797555404, 771398898,
+	747657839, 725981977, 706088274, 687745184,
+	670761200, 654976372, 640255922, 626485368,
+	613566757, 601415717, 589959130, 579133272,
+	568882316, 559157115, 549914212, 541115017,
+};
+
+// 1 / sqrt(x) = y * 2^-k for x > 0, y in Q30
+static inline int32_t invSqrtQ30(uint32_t x, int &k)
+{
+	int msb = 31 - __builtin_clz(x);
+	k = msb >> 1;
+
+	// x = m * 4^k with m in [1, 4), m as Q28
+	int shift = 28 - 2 * k;
+	uint32_t m = (shift >= 0) ? (x << shift) : (x >> -shift);
+
+	int32_t y = invSqrtSeed[(m >> 25) - 8];
+	for (int i = 0; i < 2; i++) {
+		int32_t y2 = qmul(y, y);
+		int32_t t = (int32_t)(((int64_t)m * y2) >> 28);	// m * y^2, Q30
+		y = qmul(y, Q30_THREE_HALVES - (t >> 1));
+	}
+	return y;
+}
+
+//-------------------------------------------------------------------------------------------
+
+MPUFilterQ::MPUFilterQ()
+{
+	q0 = Q30_ONE;
+	q1 = 0;
+	q2 = 0;
+	q3 = 0;
+	integralX = 0;
+	integralY = 0;
+	integralZ = 0;
+	anglesComputed = 0;
+	begin(DEFAULT_SAMPLE_FREQ, DEFAULT_GYRO_LSB_PER_DPS);
+}
+
+void MPUFilterQ::begin(float sampleFrequency, float gyroLsbPerDps)
+{
+	double dt = 1.0 / sampleFrequency;
+	gyroHalfAngle = (int32_t)lround(0.5 * dt * 0.0174532925 / gyroLsbPerDps * 1099511627776.0);	// 2^40
+	kpHalfStep = (int32_t)lround(0.5 * dt * twoKpDef * Q30_ONE);
+	kiHalfStep = (int32_t)lround(0.5 * dt * dt * twoKiDef * Q30_ONE);
+}
+
+void MPUFilterQ::updateIMU(int16_t gx, int16_t gy, int16_t gz, int16_t ax, int16_t ay, int16_t az)
+{
+	const int16_t gyro[1][3] = { { gx, gy, gz } };
+	const int16_t accel[1][3] = { { ax, ay, az } };
+	updateIMUBatch(gyro, accel, 1);
+}
+
+void MPUFilterQ::updateIMUBatch(const int16_t gyro[][3], const int16_t accel[][3], size_t count)
+{
+	int32_t s0 = q0, s1 = q1, s2 = q2, s3 = q3;
+	int32_t ix = integralX, iy = integralY, iz = integralZ;
+
+	for (size_t i = 0; i < count; i++) {
+		// Gyro counts to half rotation angle over the step (Q30)
+		int32_t hx = (int32_t)(((int64_t)gyro[i][0] * gyroHalfAngle) >> 10);
+		int32_t hy = (int32_t)(((int64_t)gyro[i][1] * gyroHalfAngle) >> 10);
+		int32_t hz = (int32_t)(((int64_t)gyro[i][2] * gyroHalfAngle) >> 10);
+
+		int32_t ax = accel[i][0], ay = accel[i][1], az = accel[i][2];
+		uint32_t accelNormSq = (uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az);
+
+		// Compute feedback only if accelerometer measurement valid
+		if (accelNormSq != 0) {
+			// Normalise accelerometer measurement (Q30)
+			int k;
+			int32_t recipNorm = invSqrtQ30(accelNormSq, k);
+			ax = (int32_t)(((int64_t)ax * recipNorm) >> k);
+			ay = (int32_t)(((int64_t)ay * recipNorm) >> k);
+			az = (int32_t)(((int64_t)az * recipNorm) >> k);
+
+			// Estimated direction of gravity
+			int32_t halfvx = qmul(s1, s3) - qmul(s0, s2);
+			int32_t halfvy = qmul(s0, s1) + qmul(s2, s3);
+			int32_t halfvz = qmul(s0, s0) - Q30_HALF + qmul(s3, s3);
+
+			// Error is cross product between estimated and measured direction of gravity
+			int32_t halfex = qmul(ay, halfvz) - qmul(az, halfvy);
+			int32_t halfey = qmul(az, halfvx) - qmul(ax, halfvz);
+			int32_t halfez = qmul(ax, halfvy) - qmul(ay, halfvx);
+
+			// Integral feedback if enabled
+			if (kiHalfStep > 0) {
+				ix += qmul(halfex, kiHalfStep);
+				iy += qmul(halfey, kiHalfStep);
+				iz += qmul(halfez, kiHalfStep);
+				hx += ix;
+				hy += iy;
+				hz += iz;
+			} else {
+				ix = 0;
+				iy = 0;
+				iz = 0;
+			}
+
+			// Proportional feedback
+			hx += qmul(halfex, kpHalfStep);
+			hy += qmul(halfey, kpHalfStep);
+			hz += qmul(halfez, kpHalfStep);
+		}
+
+		// Integrate rate of change of quaternion
+		int32_t qa = s0, qb = s1, qc = s2;
+		s0 += -qmul(qb, hx) - qmul(qc, hy) - qmul(s3, hz);
+		s1 += qmul(qa, hx) + qmul(qc, hz) - qmul(s3, hy);
+		s2 += qmul(qa, hy) - qmul(qb, hz) + qmul(s3, hx);
+		s3 += qmul(qa, hz) + qmul(qb, hy) - qmul(qc, hx);
+
+		// Normalise quaternion - it stays within a few ppm of unit length per
+		// step, so one Newton step from 1 is enough
+		int32_t normSq = qmul(s0, s0) + qmul(s1, s1) + qmul(s2, s2) + qmul(s3, s3);
+		int32_t recipNorm = Q30_THREE_HALVES - (normSq >> 1);
+		s0 = qmul(s0, recipNorm);
+		s1 = qmul(s1, recipNorm);
+		s2 = qmul(s2, recipNorm);
+		s3 = qmul(s3, recipNorm);
+	}
+
+	q0 = s0;
+	q1 = s1;
+	q2 = s2;
+	q3 = s3;
+	integralX = ix;
+	integralY = iy;
+	integralZ = iz;
+	anglesComputed = 0;
+}
+
+//-------------------------------------------------------------------------------------------
+
+void MPUFilterQ::computeAngles()
+{
+	float f0 = getQ0(), f1 = getQ1(), f2 = getQ2(), f3 = getQ3();
+	roll = atan2f(f0*f1 + f2*f3, 0.5f - f1*f1 - f2*f2);
+	pitch = asinf(-2.0f * (f1*f3 - f0*f2));
+	yaw = atan2f(f1*f2 + f0*f3, 0.5f - f2*f2 - f3*f3);
+	anglesComputed = 1;
+}
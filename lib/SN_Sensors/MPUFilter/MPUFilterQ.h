@@ -0,0 +1,58 @@
+#ifndef MPUFilterQ_h
+#define MPUFilterQ_h
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------------
+// Fixed-point variant of MPUFilter's IMU update (same Mahony filter, same gains)
+//
+// Takes raw MPU6050 counts (offsets already removed) and keeps the
+// quaternion in Q30. Only 32x32->64 multiplies and shifts are used per
+// sample; normalisation is a table seed plus two Newton steps. The step is
+// fixed by begin(), there is no per-sample dt and no magnetometer update.
+// Floats are only used in begin() and the getters.
+//
+// tools/mpufilter_bench.cpp compares it with the float filter.
+
+class MPUFilterQ {
+private:
+	int32_t q0, q1, q2, q3;		// Q30 quaternion of sensor frame relative to auxiliary frame
+	int32_t integralX, integralY, integralZ;	// Q30 integral feedback, as half angle per step
+	int32_t gyroHalfAngle;		// Q40 half rotation angle per step per gyro count
+	int32_t kpHalfStep;		// Q30 0.5 * dt * twoKp
+	int32_t kiHalfStep;		// Q30 0.5 * dt * dt * twoKi
+	float roll, pitch, yaw;
+	char anglesComputed;
+	void computeAngles();
+
+//-------------------------------------------------------------------------------------------
+// Function declarations
+
+public:
+	MPUFilterQ();
+	// gyroLsbPerDps: gyro counts per deg/s (131 at +-250 deg/s)
+	void begin(float sampleFrequency, float gyroLsbPerDps);
+	void updateIMU(int16_t gx, int16_t gy, int16_t gz, int16_t ax, int16_t ay, int16_t az);
+	void updateIMUBatch(const int16_t gyro[][3], const int16_t accel[][3], size_t count);
+
+    float getQ0() const { return q0 * (1.0f / 1073741824.0f); }
+    float getQ1() const { return q1 * (1.0f / 1073741824.0f); }
+    float getQ2() const { return q2 * (1.0f / 1073741824.0f); }
+    float getQ3() const { return q3 * (1.0f / 1073741824.0f); }
+
+    float getRoll() {
+		if (!anglesComputed) computeAngles();
+		return roll * 57.29578f;
+	}
+	float getPitch() {
+		if (!anglesComputed) computeAngles();
+		return pitch * 57.29578f;
+	}
+	float getYaw() {
+		if (!anglesComputed) computeAngles();
+		return yaw * 57.29578f + 180.0f;
+	}
+};
+
+#endif
@@ -36,8 +36,8 @@
 #include "MPUFilter/MPUFilter.h"
 #include <QMC5883LCompass.h>
 #include <Preferences.h>
-
-Preferences preferences;
+#include <Wire.h>
+#include "esp_timer.h"
 
 // Initialize ADC (ADS1115)
 Adafruit_ADS1115 obc_adc;
@@ -68,16 +68,67 @@ SN_MPU_Sensor mpu_sensor; // Structure to hold MPU sensor data
 // MPU Normalization variables
 Vector3D gravity;               // used to store the gravity vector, low-pass filter and normalization
 const float gravityAlpha = 0.9; // Complementary filter constant for isolating gravity
-
-// MPU Calibration variables
-bool doMPUCalibration = false;
-int numberOfSamples = 10000;
-int calibrationSamplesCount = 0;
-// Accelerometer sums
-double axSum = 0.0, aySum = 0.0, azSum = 0.0;
-// Gyroscope sums
-double gxSum = 0.0, gySum = 0.0, gzSum = 0.0;
-// End of MPU Calibration variables
+const float gravityAlphaPeriod = 0.2; // s - gravityAlpha was tuned for one sample per 200 ms
+float gravityAlphaSample = gravityAlpha; // gravityAlpha rescaled to the FIFO sample period
+
+// MPU6050 FIFO (registers not exposed by Adafruit_MPU6050)
+#define MPU_I2C_ADDRESS          0x68
+#define MPU_REG_SMPLRT_DIV       0x19
+#define MPU_REG_FIFO_EN          0x23
+#define MPU_REG_USER_CTRL        0x6A
+#define MPU_REG_FIFO_COUNTH      0x72
+#define MPU_REG_FIFO_R_W         0x74
+#define MPU_FIFO_EN_SENSORS      0xF8   // TEMP, XG, YG, ZG, ACCEL
+#define MPU_USER_CTRL_FIFO_EN    0x40
+#define MPU_USER_CTRL_FIFO_RESET 0x04
+#define MPU_FIFO_SIZE            1024
+#define MPU_FIFO_SAMPLE_BYTES    14     // accel xyz, temp, gyro xyz - big-endian int16
+#define MPU_GYRO_OUTPUT_RATE_HZ  1000   // With the DLPF enabled
+#define MPU_ACCEL_SCALE          (9.80665f / 16384.0f)             // m/s^2 per LSB at +-2 g
+#define MPU_GYRO_SCALE           (0.0174532925f / 131.0f)          // rad/s per LSB at +-250 deg/s
+
+static_assert(SN_MPU_SAMPLE_RATE_HZ >= 4 && SN_MPU_SAMPLE_RATE_HZ <= MPU_GYRO_OUTPUT_RATE_HZ,
+              "SN_MPU_SAMPLE_RATE_HZ must be between 4 and 1000");
+static_assert(SN_MPU_CALIBRATION_RATE_HZ >= 4 && SN_MPU_CALIBRATION_RATE_HZ <= MPU_GYRO_OUTPUT_RATE_HZ,
+              "SN_MPU_CALIBRATION_RATE_HZ must be between 4 and 1000");
+static_assert(SN_MPU_CALIBRATION_SAMPLES >= 2, "SN_MPU_CALIBRATION_SAMPLES must be at least 2");
+
+static uint8_t mpu_fifo_buffer[SN_MPU_FIFO_BURST_SAMPLES * MPU_FIFO_SAMPLE_BYTES];
+static float mpu_batch_gyro[SN_MPU_FIFO_BURST_SAMPLES][3];     // Filter frame, deg/s
+static float mpu_batch_accel[SN_MPU_FIFO_BURST_SAMPLES][3];    // Filter frame
+
+#if SN_USE_MAGNETOMETER == 1 && SN_MPU_FUSION_9DOF == 1
+// Magnetometer samples for the filter: all zero (IMU-only step) except the
+// entry of the FIFO sample a fresh magnetometer reading is fused with
+static float mpu_batch_mag[SN_MPU_FIFO_BURST_SAMPLES][3];
+static float mag_fusion_sample[3];      // Calibrated, IMU axes; set by read_MAG()
+static bool mag_fusion_pending = false;
+static bool mag_fusion_aligned = false;
+
+// One fused step per sensor cycle corrects heading with a time constant of
+// roughly (IMU rate / magnetometer rate) / Kp - tens of seconds. The first
+// reading is therefore fused repeatedly with the gyro held at zero (50 s of
+// filter time) so the heading starts out right instead of creeping round
+// from the power-on guess.
+#define MAG_FUSION_ALIGN_STEPS  200
+#define MAG_FUSION_ALIGN_DT_S   0.25f
+#endif
+static uint16_t mpu_burst_samples = SN_MPU_FIFO_BURST_SAMPLES;  // Lowered if Wire cannot buffer a full burst
+
+// Offset-corrected values of the newest FIFO sample, published by read_MPU()
+static float mpu_last_gyro[3];          // rad/s
+static float mpu_last_linear[3];        // m/s^2, gravity removed
+static int16_t mpu_last_temp_raw = 0;
+
+// Bias calibration - requested from any task, run by read_MPU() on the sensor task
+#define MPU_CALIBRATION_SETTLE_SAMPLES  50  // Dropped after the rate change while the DLPF settles
+#define MPU_CALIBRATION_POLL_MS         20
+static volatile SN_MPU_CalibrationStatus mpu_calibration_status = MPU_CALIBRATION_IDLE;
+
+// Calibration cache - written by the setters below, copied by read_MPU()
+static Preferences mpu_preferences;
+static mpu_calibration_t mpu_calibration = { MPU_CALIBRATION_VERSION, 0, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+static portMUX_TYPE mpu_calibration_lock = portMUX_INITIALIZER_UNLOCKED;
 
 #endif // SN_USE_IMU
 
@@ -115,6 +166,10 @@ bool SN_Sensors_DS18B20Init() {
 #endif // SN_USE_TEMPERATURE_SENSOR
 
 void SN_Sensors_Init() {
+    #if SN_USE_IMU == 1
+    SN_Sensors_MPU_PrepareBus();    // Before the first Wire.begin() (ADC init)
+    #endif // SN_USE_IMU
+
     #if SN_USE_ADC == 1
     if (SN_Sensors_ADCInit()) {
         logMessage(true, "SN_Sensors_Init", "ADC Initialized Successfully");
@@ -142,7 +197,83 @@ void SN_Sensors_Init() {
 }
 
 #if SN_USE_IMU == 1
+static void loadMPUCalibration()
+{
+    mpu_calibration_t stored = {};
+    bool valid = false;
+
+    if (mpu_preferences.begin("mpu", true)) // Read-only; fails if nothing was ever stored
+    {
+        valid = mpu_preferences.getBytesLength("cal") == sizeof(stored) &&
+                mpu_preferences.getBytes("cal", &stored, sizeof(stored)) == sizeof(stored) &&
+                stored.version == MPU_CALIBRATION_VERSION;
+        mpu_preferences.end();
+    }
+
+    if (!valid)
+    {
+        logMessage(false, "SN_Sensors_MPU_Init", "No valid MPU calibration stored - using zero offsets");
+        return;
+    }
+
+    portENTER_CRITICAL(&mpu_calibration_lock);
+    mpu_calibration = stored;
+    portEXIT_CRITICAL(&mpu_calibration_lock);
+    logMessage(true, "SN_Sensors_MPU_Init", "Loaded MPU calibration (orientation %u)", stored.orientation);
+}
+
+static void saveMPUCalibration(const mpu_calibration_t &calibration)
+{
+    bool saved = mpu_preferences.begin("mpu", false) &&
+                 mpu_preferences.putBytes("cal", &calibration, sizeof(calibration)) == sizeof(calibration);
+    mpu_preferences.end();
+
+    if (!saved)
+    {
+        logMessage(false, "SN_Sensors_MPU", "Failed to store MPU calibration");
+    }
+}
+
+static bool mpuWriteRegister(uint8_t reg, uint8_t value)
+{
+    Wire.beginTransmission(MPU_I2C_ADDRESS);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+
+// Register address write and data read in one transaction (repeated start)
+static bool mpuReadRegisters(uint8_t reg, uint8_t *data, size_t length)
+{
+    Wire.beginTransmission(MPU_I2C_ADDRESS);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0)
+    {
+        return false;
+    }
+    if (Wire.requestFrom((uint16_t)MPU_I2C_ADDRESS, length) != length)
+    {
+        return false;
+    }
+    return Wire.readBytes(data, length) == length;
+}
+
+void SN_Sensors_MPU_PrepareBus() {
+    // The Wire buffer can only be resized while the bus is stopped
+    size_t wanted = sizeof(mpu_fifo_buffer);
+    size_t size = Wire.setBufferSize(wanted);
+    if (size < wanted)
+    {
+        size_t usable = (size > 0) ? size : I2C_BUFFER_LENGTH;
+        mpu_burst_samples = (usable >= MPU_FIFO_SAMPLE_BYTES) ? (uint16_t)(usable / MPU_FIFO_SAMPLE_BYTES) : 1;
+        logMessage(false, "SN_Sensors_MPU_PrepareBus", "Wire buffer limited to %u bytes - %u samples per FIFO read",
+                   (unsigned)usable, (unsigned)mpu_burst_samples);
+    }
+}
+
 void SN_Sensors_MPU_Init() {
+    loadMPUCalibration();
+
     if (!mpu.begin()) {
         logMessage(false, "SN_Sensors_MPU_Init", "Failed to initialize MPU6050.");
         return;
@@ -152,10 +283,24 @@ void SN_Sensors_MPU_Init() {
     mpu.setGyroRange(MPU6050_RANGE_250_DEG);
     mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
 
-    // Initialize MPUFilter
-    mpuFilter.begin(5);
+    // Sample into the FIFO at SN_MPU_SAMPLE_RATE_HZ; read_MPU() drains it
+    uint8_t divider = (uint8_t)(MPU_GYRO_OUTPUT_RATE_HZ / SN_MPU_SAMPLE_RATE_HZ - 1);
+    float sample_rate_hz = (float)MPU_GYRO_OUTPUT_RATE_HZ / (divider + 1);
+
+    bool fifo_ok = mpuWriteRegister(MPU_REG_SMPLRT_DIV, divider) &&
+                   mpuWriteRegister(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_RESET) &&
+                   mpuWriteRegister(MPU_REG_FIFO_EN, MPU_FIFO_EN_SENSORS) &&
+                   mpuWriteRegister(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_EN);
+    if (!fifo_ok) {
+        logMessage(false, "SN_Sensors_MPU_Init", "Failed to configure MPU6050 FIFO.");
+        return;
+    }
+
+    // Initialize MPUFilter at the FIFO sample rate
+    mpuFilter.begin(sample_rate_hz);
+    gravityAlphaSample = powf(gravityAlpha, 1.0f / (sample_rate_hz * gravityAlphaPeriod));
 
-    logMessage(true, "SN_Sensors_MPU_Init", "MPU6050 Initialized Successfully");
+    logMessage(true, "SN_Sensors_MPU_Init", "MPU6050 Initialized Successfully (FIFO %.0f Hz)", sample_rate_hz);
 }
 #endif // SN_USE_IMU
 
@@ -328,88 +473,41 @@ float SN_Sensors_GetBatteryTemperature() {
 
 #if SN_USE_IMU == 1
 
-// This function is called from the read_MPU() function each time
-void mpuCalibrationEventHandler(const sensors_event_t &accel, const sensors_event_t &gyro)
+static inline int16_t mpuFifoWord(const uint8_t *bytes)
 {
-    if (doMPUCalibration)
-    {
-        if (calibrationSamplesCount < numberOfSamples)
-        {
-            axSum += accel.acceleration.x;
-            aySum += accel.acceleration.y;
-            azSum += accel.acceleration.z;
-            gxSum += gyro.gyro.x;
-            gySum += gyro.gyro.y;
-            gzSum += gyro.gyro.z;
-            calibrationSamplesCount++;
-        }
-        else
-        {
-            float acc_x = axSum / numberOfSamples;
-            float acc_y = aySum / numberOfSamples;
-            float acc_z = azSum / numberOfSamples;
-            float gyro_x = gxSum / numberOfSamples;
-            float gyro_y = gySum / numberOfSamples;
-            float gyro_z = gzSum / numberOfSamples;
-
-            float expectedGravity = -9.81;
-            int orientation = preferences.getInt("orientation", 0);
-
-            if (orientation == 1)
-            {
-                acc_x -= expectedGravity;
-            }
-            else if (orientation == 0)
-            {
-                acc_z -= expectedGravity;
-            }
-
-            preferences.putFloat("acc_x", acc_x);
-            preferences.putFloat("acc_y", acc_y);
-            preferences.putFloat("acc_z", acc_z);
-            preferences.putFloat("gyro_x", gyro_x);
-            preferences.putFloat("gyro_y", gyro_y);
-            preferences.putFloat("gyro_z", gyro_z);
-
-            doMPUCalibration = false;
-            calibrationSamplesCount = 0;
-            axSum = 0.0;
-            aySum = 0.0;
-            azSum = 0.0;
-            gxSum = 0.0;
-            gySum = 0.0;
-            gzSum = 0.0;
-        }
-    }
+    return (int16_t)((bytes[0] << 8) | bytes[1]);
 }
 
-void read_MPU()
+// Offsets and gravity estimate for one FIFO sample; fills its filter batch entry
+static void processMPUSample(const uint8_t *sample, const mpu_calibration_t &calibration,
+                             float filter_gyro[3], float filter_accel[3])
 {
-    // Get accelerometer, gyroscope, and temperature events
-    sensors_event_t accel, gyro, temp;
-    mpu.getEvent(&accel, &gyro, &temp);
-
-    // Check if calibration is enabled - Non-blocking calibration mode
-    mpuCalibrationEventHandler(accel, gyro);
+    float accel[3], gyro[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        accel[axis] = mpuFifoWord(&sample[2 * axis]) * MPU_ACCEL_SCALE;
+        gyro[axis] = mpuFifoWord(&sample[8 + 2 * axis]) * MPU_GYRO_SCALE;
+    }
+    mpu_last_temp_raw = mpuFifoWord(&sample[6]);
 
     // Read with Offsets ===========================================================
-    float accelerationX = accel.acceleration.x - preferences.getFloat("acc_x", 0.0f);
-    float accelerationY = accel.acceleration.y - preferences.getFloat("acc_y", 0.0f);
-    float accelerationZ = accel.acceleration.z - preferences.getFloat("acc_z", 0.0f);
-    float gyroX = gyro.gyro.x - preferences.getFloat("gyro_x", 0.0f);
-    float gyroY = gyro.gyro.y - preferences.getFloat("gyro_y", 0.0f);
-    float gyroZ = gyro.gyro.z - preferences.getFloat("gyro_z", 0.0f);
+    float accelerationX = accel[0] - calibration.acc_offset[0];
+    float accelerationY = accel[1] - calibration.acc_offset[1];
+    float accelerationZ = accel[2] - calibration.acc_offset[2];
+    float gyroX = gyro[0] - calibration.gyro_offset[0];
+    float gyroY = gyro[1] - calibration.gyro_offset[1];
+    float gyroZ = gyro[2] - calibration.gyro_offset[2];
     // End of Read with offsets ====================================================
 
     // Apply low-pass filter to isolate gravity from accelerometer data
-    gravity.x = gravityAlpha * gravity.x + (1 - gravityAlpha) * accelerationX;
-    gravity.y = gravityAlpha * gravity.y + (1 - gravityAlpha) * accelerationY;
-    gravity.z = gravityAlpha * gravity.z + (1 - gravityAlpha) * accelerationZ;
+    gravity.x = gravityAlphaSample * gravity.x + (1 - gravityAlphaSample) * accelerationX;
+    gravity.y = gravityAlphaSample * gravity.y + (1 - gravityAlphaSample) * accelerationY;
+    gravity.z = gravityAlphaSample * gravity.z + (1 - gravityAlphaSample) * accelerationZ;
 
     // Subtract gravity from the accelerometer data to get linear acceleration
-    float linearAccX = accelerationX - gravity.x;
-    float linearAccY = accelerationY - gravity.y;
-    float linearAccZ = accelerationZ - gravity.z;
+    mpu_last_linear[0] = accelerationX - gravity.x;
+    mpu_last_linear[1] = accelerationY - gravity.y;
+    mpu_last_linear[2] = accelerationZ - gravity.z;
 
     // Normalize the gravity vector to ensure it has a magnitude of ~9.81
     float magnitude = sqrt(gravity.x * gravity.x + gravity.y * gravity.y + gravity.z * gravity.z);
@@ -423,28 +521,317 @@ void read_MPU()
         gravity.z *= correctionFactor;
     }
 
-    float gyroScale = 3.800;
+    // MPUFilter takes deg/s; its step is the FIFO sample period set in SN_Sensors_MPU_Init()
+    if (calibration.orientation == 1) // vertical
+    {
+        filter_gyro[0] = -gyroY * RAD_TO_DEG;
+        filter_gyro[1] = -gyroZ * RAD_TO_DEG;
+        filter_gyro[2] = -gyroX * RAD_TO_DEG;
+        filter_accel[0] = -accelerationY;
+        filter_accel[1] = -accelerationZ;
+        filter_accel[2] = -accelerationX;
+    }
+    else // horizontal
+    {
+        filter_gyro[0] = gyroX * RAD_TO_DEG;
+        filter_gyro[1] = gyroY * RAD_TO_DEG;
+        filter_gyro[2] = -gyroZ * RAD_TO_DEG;
+        filter_accel[0] = accelerationX;
+        filter_accel[1] = accelerationY;
+        filter_accel[2] = -accelerationZ;
+    }
+
+    mpu_last_gyro[0] = gyroX;
+    mpu_last_gyro[1] = gyroY;
+    mpu_last_gyro[2] = gyroZ;
+}
+
+// Running mean and variance per axis (Welford) - stays accurate in float
+// where a plain sum of squares would cancel
+struct MPUCalibrationStats {
+    uint32_t count;
+    float mean[6];              // accel xyz (m/s^2), gyro xyz (rad/s)
+    float m2[6];                // Sum of squared deviations from the mean
+};
+
+static void mpuCalibrationAdd(MPUCalibrationStats &stats, const uint8_t *sample)
+{
+    float value[6];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        value[axis] = mpuFifoWord(&sample[2 * axis]) * MPU_ACCEL_SCALE;
+        value[3 + axis] = mpuFifoWord(&sample[8 + 2 * axis]) * MPU_GYRO_SCALE;
+    }
+
+    stats.count++;
+    for (int i = 0; i < 6; i++)
+    {
+        float delta = value[i] - stats.mean[i];
+        stats.mean[i] += delta / stats.count;
+        stats.m2[i] += delta * (value[i] - stats.mean[i]);
+    }
+}
+
+// Drains the FIFO as it fills until SN_MPU_CALIBRATION_SAMPLES are collected
+static SN_MPU_CalibrationStatus collectMPUCalibration(MPUCalibrationStats &stats)
+{
+    uint32_t settle = MPU_CALIBRATION_SETTLE_SAMPLES;
+    const TickType_t timeout = pdMS_TO_TICKS(3000UL * (SN_MPU_CALIBRATION_SAMPLES + MPU_CALIBRATION_SETTLE_SAMPLES) /
+                                             SN_MPU_CALIBRATION_RATE_HZ);    // 3x the expected duration
+    TickType_t start = xTaskGetTickCount();
+
+    while (stats.count < SN_MPU_CALIBRATION_SAMPLES)
+    {
+        if (xTaskGetTickCount() - start > timeout)
+        {
+            return MPU_CALIBRATION_FAILED;
+        }
+
+        uint8_t count_bytes[2];
+        if (!mpuReadRegisters(MPU_REG_FIFO_COUNTH, count_bytes, sizeof(count_bytes)))
+        {
+            return MPU_CALIBRATION_FAILED;
+        }
+        uint16_t queued = ((uint16_t)count_bytes[0] << 8) | count_bytes[1];
+        if (queued > (MPU_FIFO_SIZE / MPU_FIFO_SAMPLE_BYTES) * MPU_FIFO_SAMPLE_BYTES || queued % MPU_FIFO_SAMPLE_BYTES != 0)
+        {
+            return MPU_CALIBRATION_FAILED;  // Samples were lost
+        }
+
+        uint16_t available = queued / MPU_FIFO_SAMPLE_BYTES;
+        uint16_t burst = (available < mpu_burst_samples) ? available : mpu_burst_samples;
+        if (burst > 0)
+        {
+            if (!mpuReadRegisters(MPU_REG_FIFO_R_W, mpu_fifo_buffer, burst * MPU_FIFO_SAMPLE_BYTES))
+            {
+                return MPU_CALIBRATION_FAILED;
+            }
+            for (uint16_t i = 0; i < burst && stats.count < SN_MPU_CALIBRATION_SAMPLES; i++)
+            {
+                if (settle > 0)
+                {
+                    settle--;
+                    continue;
+                }
+                mpuCalibrationAdd(stats, &mpu_fifo_buffer[i * MPU_FIFO_SAMPLE_BYTES]);
+            }
+        }
+        if (burst == available)
+        {
+            vTaskDelay(pdMS_TO_TICKS(MPU_CALIBRATION_POLL_MS));
+        }
+    }
+    return MPU_CALIBRATION_DONE;
+}
+
+static void runMPUCalibration()
+{
+    const uint8_t calibration_divider = (uint8_t)(MPU_GYRO_OUTPUT_RATE_HZ / SN_MPU_CALIBRATION_RATE_HZ - 1);
+    const uint8_t normal_divider = (uint8_t)(MPU_GYRO_OUTPUT_RATE_HZ / SN_MPU_SAMPLE_RATE_HZ - 1);
+    int64_t started_us = esp_timer_get_time();
+
+    MPUCalibrationStats stats = {};
+    SN_MPU_CalibrationStatus status = MPU_CALIBRATION_FAILED;
+    if (mpuWriteRegister(MPU_REG_SMPLRT_DIV, calibration_divider) &&
+        mpuWriteRegister(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_EN | MPU_USER_CTRL_FIFO_RESET))
+    {
+        status = collectMPUCalibration(stats);
+    }
 
-    int orientation = preferences.getInt("orientation", 0);
+    // Back to the normal rate, dropping whatever queued at the calibration rate
+    mpuWriteRegister(MPU_REG_SMPLRT_DIV, normal_divider);
+    mpuWriteRegister(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_EN | MPU_USER_CTRL_FIFO_RESET);
 
-    if (orientation == 1) // vertical
+    if (status != MPU_CALIBRATION_DONE)
     {
-        mpuFilter.updateIMU(-gyroY * gyroScale, -gyroZ * gyroScale, -gyroX * gyroScale, -accelerationY, -accelerationZ, -accelerationX);
+        logMessage(false, "SN_Sensors_MPUCalibration", "Calibration failed after %u samples (I2C error, FIFO overflow or timeout)",
+                   (unsigned)stats.count);
+        mpu_calibration_status = status;
+        return;
     }
-    else if (orientation == 0) // horizontal
+
+    float accel_std = 0.0f, gyro_std = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
     {
-        mpuFilter.updateIMU(gyroX * gyroScale, gyroY * gyroScale, -gyroZ * gyroScale, accelerationX, accelerationY, -accelerationZ);
+        accel_std = fmaxf(accel_std, sqrtf(stats.m2[axis] / (stats.count - 1)));
+        gyro_std = fmaxf(gyro_std, sqrtf(stats.m2[3 + axis] / (stats.count - 1)));
+    }
+    if (accel_std > SN_MPU_CALIBRATION_MAX_ACCEL_STD || gyro_std > SN_MPU_CALIBRATION_MAX_GYRO_STD)
+    {
+        logMessage(false, "SN_Sensors_MPUCalibration", "Rejected - rover moved (std accel %.3f m/s^2, gyro %.4f rad/s)",
+                   accel_std, gyro_std);
+        mpu_calibration_status = MPU_CALIBRATION_REJECTED_MOTION;
+        return;
     }
 
+    float expectedGravity = -9.81;
+
+    // Swap in all six offsets at once so read_MPU() never sees a mix
+    mpu_calibration_t calibration;
+    portENTER_CRITICAL(&mpu_calibration_lock);
+    int orientation = mpu_calibration.orientation;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        mpu_calibration.acc_offset[axis] = stats.mean[axis];
+        mpu_calibration.gyro_offset[axis] = stats.mean[3 + axis];
+    }
+    if (orientation == 1)
+    {
+        mpu_calibration.acc_offset[0] -= expectedGravity;
+    }
+    else if (orientation == 0)
+    {
+        mpu_calibration.acc_offset[2] -= expectedGravity;
+    }
+    calibration = mpu_calibration;
+    portEXIT_CRITICAL(&mpu_calibration_lock);
+
+    saveMPUCalibration(calibration);
+    mpu_calibration_status = MPU_CALIBRATION_DONE;
+
+    logMessage(true, "SN_Sensors_MPUCalibration", "Calibrated from %u samples in %u ms (std accel %.3f m/s^2, gyro %.4f rad/s)",
+               (unsigned)stats.count, (unsigned)((esp_timer_get_time() - started_us) / 1000), accel_std, gyro_std);
+}
+
+void SN_Sensors_RequestMPUCalibration()
+{
+    mpu_calibration_status = MPU_CALIBRATION_PENDING;
+}
+
+SN_MPU_CalibrationStatus SN_Sensors_GetMPUCalibrationStatus()
+{
+    return mpu_calibration_status;
+}
+
+void read_MPU()
+{
+    if (mpu_calibration_status == MPU_CALIBRATION_PENDING)
+    {
+        runMPUCalibration();
+        return;     // The FIFO was reset; normal sampling resumes next cycle
+    }
+
+    // Everything sampled since the last call is queued in the FIFO
+    uint8_t count_bytes[2];
+    if (!mpuReadRegisters(MPU_REG_FIFO_COUNTH, count_bytes, sizeof(count_bytes)))
+    {
+        return;
+    }
+    uint16_t queued = ((uint16_t)count_bytes[0] << 8) | count_bytes[1];
+
+    // A full FIFO has dropped bytes and lost sample alignment - start over
+    if (queued > (MPU_FIFO_SIZE / MPU_FIFO_SAMPLE_BYTES) * MPU_FIFO_SAMPLE_BYTES || queued % MPU_FIFO_SAMPLE_BYTES != 0)
+    {
+        mpuWriteRegister(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_EN | MPU_USER_CTRL_FIFO_RESET);
+        mpu_sensor.fifo_overflows++;
+        return;
+    }
+
+    mpu_calibration_t calibration;
+    SN_GetMPUCalibration(calibration);
+
+    // Normally a single burst; only a late wake-up needs more than one
+    uint16_t pending = queued / MPU_FIFO_SAMPLE_BYTES;
+    uint16_t processed = 0;
+    while (pending > 0)
+    {
+        uint16_t burst = (pending < mpu_burst_samples) ? pending : mpu_burst_samples;
+        if (!mpuReadRegisters(MPU_REG_FIFO_R_W, mpu_fifo_buffer, burst * MPU_FIFO_SAMPLE_BYTES))
+        {
+            break;
+        }
+        for (uint16_t i = 0; i < burst; i++)
+        {
+            processMPUSample(&mpu_fifo_buffer[i * MPU_FIFO_SAMPLE_BYTES], calibration,
+                             mpu_batch_gyro[i], mpu_batch_accel[i]);
+        }
+
+#if SN_USE_MAGNETOMETER == 1 && SN_MPU_FUSION_9DOF == 1
+        // read_MAG() runs just before read_MPU(): fuse its sample with the newest FIFO sample
+        bool fuse_mag = mag_fusion_pending && burst == pending;
+        if (fuse_mag)
+        {
+            float *mag = mpu_batch_mag[burst - 1];
+            if (calibration.orientation == 1) // vertical - same axis mapping as the accelerometer
+            {
+                mag[0] = -mag_fusion_sample[1];
+                mag[1] = -mag_fusion_sample[2];
+                mag[2] = -mag_fusion_sample[0];
+            }
+            else // horizontal
+            {
+                mag[0] = mag_fusion_sample[0];
+                mag[1] = mag_fusion_sample[1];
+                mag[2] = -mag_fusion_sample[2];
+            }
+
+            // Keep only the part of the field perpendicular to gravity, so the
+            // magnetometer corrects heading and leaves roll/pitch to the accelerometer
+            const float *acc = mpu_batch_accel[burst - 1];
+            float acc_sq = acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2];
+            if (acc_sq > 0.0f)
+            {
+                float k = (mag[0] * acc[0] + mag[1] * acc[1] + mag[2] * acc[2]) / acc_sq;
+                mag[0] -= k * acc[0];
+                mag[1] -= k * acc[1];
+                mag[2] -= k * acc[2];
+            }
+            mag_fusion_pending = false;
+        }
+        mpuFilter.updateBatch(mpu_batch_gyro, mpu_batch_accel, mpu_batch_mag, NULL, burst);
+        if (fuse_mag)
+        {
+            if (!mag_fusion_aligned)
+            {
+                static const float zero_gyro[1][3] = { { 0.0f, 0.0f, 0.0f } };
+                const float dt = MAG_FUSION_ALIGN_DT_S;
+                for (int step = 0; step < MAG_FUSION_ALIGN_STEPS; step++)
+                {
+                    mpuFilter.updateBatch(zero_gyro, &mpu_batch_accel[burst - 1], &mpu_batch_mag[burst - 1], &dt, 1);
+                }
+                mag_fusion_aligned = true;
+            }
+            memset(mpu_batch_mag[burst - 1], 0, sizeof(mpu_batch_mag[0]));
+        }
+#else
+        mpuFilter.updateIMUBatch(mpu_batch_gyro, mpu_batch_accel, NULL, burst);
+#endif
+        pending -= burst;
+        processed += burst;
+    }
+
+    mpu_sensor.fifo_samples = processed;
+    if (processed == 0)
+    {
+        return;
+    }
+
+    // Publish the attitude after the newest sample only
+    int orientation = calibration.orientation;
+    float gyroX = mpu_last_gyro[0];
+    float gyroZ = mpu_last_gyro[2];
+    float linearAccX = mpu_last_linear[0];
+    float linearAccY = mpu_last_linear[1];
+    float linearAccZ = mpu_last_linear[2];
+
     float q0 = mpuFilter.getQ0();
     float q1 = mpuFilter.getQ1();
     float q2 = mpuFilter.getQ2();
     float q3 = mpuFilter.getQ3();
 
+    // Yaw rate: the axis fed to the filter as its z gyro for this mounting
+    mpu_sensor.yaw_rate_dps = ((orientation == 1) ? -gyroX : -gyroZ) * RAD_TO_DEG;
+
     float roll = mpuFilter.getRoll();
     float pitch = mpuFilter.getPitch();
     float yaw = mpuFilter.getYaw();
 
+#if SN_USE_MAGNETOMETER == 1 && SN_MPU_FUSION_9DOF == 1
+    // Compass heading, clockwise from magnetic north; already tilt-compensated
+    float heading = -mpuFilter.getYawRadians() * RAD_TO_DEG;
+    mpu_sensor.heading_degrees = (heading < 0.0f) ? heading + 360.0f : heading;
+#endif
+
     if (orientation == 1)
     {
         // ACCELERATION OUTPUT PD-DATA
@@ -487,14 +874,20 @@ void read_MPU()
     mpu_sensor.Z_quaternion = q3;
 
     // TEMPERATURE OUTPUT PD-DATA
-    mpu_sensor.temperature = temp.temperature / 340.00 + 36.53;
+    mpu_sensor.temperature = mpu_last_temp_raw / 340.00 + 36.53;
 }
 
 void SN_SetMPUOrientation(int orientation)
 {
     if (orientation == 0 || orientation == 1)
     {
-        preferences.putInt("orientation", orientation);
+        mpu_calibration_t calibration;
+        portENTER_CRITICAL(&mpu_calibration_lock);
+        mpu_calibration.orientation = (uint16_t)orientation;
+        calibration = mpu_calibration;
+        portEXIT_CRITICAL(&mpu_calibration_lock);
+
+        saveMPUCalibration(calibration);
         logMessage(true, "SN_SetMPUOrientation", "MPU orientation set to: %d", orientation);
     }
     else
@@ -505,21 +898,79 @@ void SN_SetMPUOrientation(int orientation)
 
 int SN_GetMPUOrientation()
 {
-    return preferences.getInt("orientation", 0); // Default to horizontal
+    mpu_calibration_t calibration;
+    SN_GetMPUCalibration(calibration);
+    return calibration.orientation; // Default to horizontal
 }
 
 void SN_ClearMPUCalibrationData()
 {
-    preferences.remove("acc_x");
-    preferences.remove("acc_y");
-    preferences.remove("acc_z");
-    preferences.remove("gyro_x");
-    preferences.remove("gyro_y");
-    preferences.remove("gyro_z");
-    preferences.remove("orientation");
+    portENTER_CRITICAL(&mpu_calibration_lock);
+    mpu_calibration = mpu_calibration_t{ MPU_CALIBRATION_VERSION, 0, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    portEXIT_CRITICAL(&mpu_calibration_lock);
+
+    if (mpu_preferences.begin("mpu", false))
+    {
+        mpu_preferences.remove("cal");
+        mpu_preferences.end();
+    }
 
     logMessage(true, "SN_ClearMPUCalibrationData", "All MPU calibration preferences cleared.");
 }
+
+void SN_GetMPUCalibration(mpu_calibration_t &out)
+{
+    portENTER_CRITICAL(&mpu_calibration_lock);
+    out = mpu_calibration;
+    portEXIT_CRITICAL(&mpu_calibration_lock);
+}
+
+void SN_Sensors_BenchmarkMPUCalibration(void (*print)(const char *line))
+{
+    const int samples = 200;
+    static const char *const keys[6] = { "acc_x", "acc_y", "acc_z", "gyro_x", "gyro_y", "gyro_z" };
+    volatile float sink = 0.0f;
+    char line[96];
+
+    // Before: six getFloat() and one getInt() per sample, on a scratch
+    // namespace holding the keys read_MPU() used to look up
+    Preferences bench_preferences;
+    if (!bench_preferences.begin("mpu_bench", false))
+    {
+        print("imubench: failed to open NVS");
+        return;
+    }
+    for (int k = 0; k < 6; k++) bench_preferences.putFloat(keys[k], 0.01f * k);
+    bench_preferences.putInt("orientation", 0);
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < samples; i++)
+    {
+        for (int k = 0; k < 6; k++) sink = sink + bench_preferences.getFloat(keys[k], 0.0f);
+        sink = sink + bench_preferences.getInt("orientation", 0);
+    }
+    int64_t nvs_us = esp_timer_get_time() - start_us;
+
+    bench_preferences.clear();
+    bench_preferences.end();
+
+    // After: one copy of the cached struct per sample
+    start_us = esp_timer_get_time();
+    for (int i = 0; i < samples; i++)
+    {
+        mpu_calibration_t calibration;
+        SN_GetMPUCalibration(calibration);
+        sink = sink + calibration.acc_offset[0] + calibration.gyro_offset[2] + calibration.orientation;
+    }
+    int64_t cache_us = esp_timer_get_time() - start_us;
+
+    snprintf(line, sizeof(line), "MPU calibration lookup per sample (%d samples):", samples);
+    print(line);
+    snprintf(line, sizeof(line), "  nvs   %8.2f us", (double)nvs_us / samples);
+    print(line);
+    snprintf(line, sizeof(line), "  cache %8.2f us", (double)cache_us / samples);
+    print(line);
+}
 #endif // SN_USE_IMU
 
 #if SN_USE_MAGNETOMETER == 1
@@ -591,6 +1042,21 @@ void read_MAG()
     
     // Get cardinal direction string (N, NE, E, SE, S, SW, W, NW)
     magnetometer.getDirection(mag_sensor.direction, 2);
+
+#if SN_USE_IMU == 1 && SN_MPU_FUSION_9DOF == 1
+    // Hand the sample to read_MPU(), in IMU axes (see computeTiltCompensatedHeading)
+    mag_fusion_sample[0] = -(float)mag_sensor.mag_x;
+    mag_fusion_sample[1] = (float)mag_sensor.mag_y;
+    mag_fusion_sample[2] = (float)mag_sensor.mag_z;
+    mag_fusion_pending = (mag_sensor.mag_x != 0 || mag_sensor.mag_y != 0 || mag_sensor.mag_z != 0);
+#endif
+}
+
+void SN_Sensors_HeadingToCardinal(float heading_degrees, char cardinal[3])
+{
+    static const char *const points[8] = { "N", "NE", "E", "SE", "S", "SW", "W", "NW" };
+    int sector = (int)((heading_degrees + 22.5f) / 45.0f) & 7;
+    strncpy(cardinal, points[sector], 3);
 }
 
 
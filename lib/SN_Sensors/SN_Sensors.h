@@ -13,10 +13,44 @@
 #define SN_USE_IMU 1  // Enable MPU6050 IMU by default
 #endif
 
+// MPU6050 samples into its FIFO at this rate; read_MPU() drains it in bursts
+#ifndef SN_MPU_SAMPLE_RATE_HZ
+#define SN_MPU_SAMPLE_RATE_HZ 200  // 1 kHz / N; 200 Hz queues ~560 bytes per 200 ms sensor cycle
+#endif
+
+#ifndef SN_MPU_FIFO_BURST_SAMPLES
+#define SN_MPU_FIFO_BURST_SAMPLES 64  // Samples per I2C read (14 bytes each), sizes the Wire buffer
+#endif
+
+// Bias calibration (SN_Sensors_RequestMPUCalibration): samples at this rate
+// while the rover is still, and rejects the run if any axis varies too much
+#ifndef SN_MPU_CALIBRATION_RATE_HZ
+#define SN_MPU_CALIBRATION_RATE_HZ 500  // 1 kHz / N; 1 kHz is more than a 100 kHz I2C bus can drain
+#endif
+
+#ifndef SN_MPU_CALIBRATION_SAMPLES
+#define SN_MPU_CALIBRATION_SAMPLES 1000  // 2 s at 500 Hz
+#endif
+
+#ifndef SN_MPU_CALIBRATION_MAX_ACCEL_STD
+#define SN_MPU_CALIBRATION_MAX_ACCEL_STD 0.1f  // m/s^2; sensor noise is ~0.02 at the 21 Hz DLPF
+#endif
+
+#ifndef SN_MPU_CALIBRATION_MAX_GYRO_STD
+#define SN_MPU_CALIBRATION_MAX_GYRO_STD 0.01f  // rad/s (~0.6 deg/s); sensor noise is ~0.001
+#endif
+
 #ifndef SN_USE_MAGNETOMETER
 #define SN_USE_MAGNETOMETER 1  // Enable QMC5883L magnetometer by default
 #endif
 
+// 9-DOF fusion: each magnetometer read goes into MPUFilter with the newest
+// IMU sample and the heading comes from the fused quaternion. 0 keeps the
+// 6-DOF filter plus the separate tilt-compensated compass heading.
+#ifndef SN_MPU_FUSION_9DOF
+#define SN_MPU_FUSION_9DOF SN_USE_MAGNETOMETER
+#endif
+
 #ifndef SN_USE_ADC
 #define SN_USE_ADC 1  // Enable ADS1115 ADC by default
 #endif
@@ -34,6 +68,7 @@ int16_t SN_Sensors_ADCReadChannel(uint8_t channel);
 float SN_Sensors_ADCGetParameterValue(uint8_t channel);
 float SN_Sensors_GetBatteryTemperature();
 void SN_Sensors_Init();
+void SN_Sensors_MPU_PrepareBus();
 void SN_Sensors_MPU_Init();
 void SN_Sensors_MAG_Init();
 
@@ -60,10 +95,30 @@ struct s_SN_MPU_Sensor {
     float Z_quaternion = 0;
 
     float temperature = 0;
+
+    float yaw_rate_dps = 0;     // Rotation about the vertical axis (offset-corrected gyro)
+
+    float heading_degrees = 0;  // Compass heading 0-360 from the fused quaternion (SN_MPU_FUSION_9DOF)
+
+    uint16_t fifo_samples = 0;  // FIFO samples consumed by the last read_MPU()
+    uint32_t fifo_overflows = 0;
 };
 
 typedef struct s_SN_MPU_Sensor SN_MPU_Sensor;
 
+// MPU calibration, kept in RAM and persisted as one NVS blob ("mpu"/"cal").
+// Loaded once by SN_Sensors_MPU_Init(); read_MPU() only takes a copy.
+// Bump MPU_CALIBRATION_VERSION when the layout changes - a stored blob with
+// another version or size is ignored and the defaults are used.
+#define MPU_CALIBRATION_VERSION 1
+
+typedef struct {
+    uint16_t version;
+    uint16_t orientation;       // 0 = horizontal, 1 = vertical
+    float acc_offset[3];        // m/s^2, gravity already removed
+    float gyro_offset[3];       // rad/s
+} mpu_calibration_t;
+
 // External declaration of MPU sensor data
 extern SN_MPU_Sensor mpu_sensor;
 
@@ -72,6 +127,24 @@ void read_MPU();
 void SN_SetMPUOrientation(int orientation);
 int SN_GetMPUOrientation();
 void SN_ClearMPUCalibrationData();
+void SN_GetMPUCalibration(mpu_calibration_t &out);
+
+// Bias calibration runs inside the next read_MPU() (the sensor task owns the
+// bus) and blocks it for about SN_MPU_CALIBRATION_SAMPLES / rate seconds.
+// The rover must be still and level in its configured orientation.
+enum SN_MPU_CalibrationStatus {
+    MPU_CALIBRATION_IDLE,
+    MPU_CALIBRATION_PENDING,
+    MPU_CALIBRATION_DONE,
+    MPU_CALIBRATION_REJECTED_MOTION,    // An axis varied more than the SN_MPU_CALIBRATION_MAX_*_STD limit
+    MPU_CALIBRATION_FAILED              // I2C error, FIFO overflow or timeout
+};
+
+void SN_Sensors_RequestMPUCalibration();
+SN_MPU_CalibrationStatus SN_Sensors_GetMPUCalibrationStatus();
+
+// Time the former per-sample NVS lookups against the cached copy
+void SN_Sensors_BenchmarkMPUCalibration(void (*print)(const char *line));
 
 #endif // SN_USE_IMU
 
@@ -96,6 +169,7 @@ float computeTiltCompensatedHeading(float mag_x, float mag_y, float mag_z,
                                     float pitch_rad, float roll_rad);
 void SN_SetMagnetometerCalibration(int x_min, int x_max, int y_min, int y_max, int z_min, int z_max);
 void SN_SetMagnetometerSmoothing(uint8_t steps, bool advanced);
+void SN_Sensors_HeadingToCardinal(float heading_degrees, char cardinal[3]);
 
 #endif // SN_USE_MAGNETOMETER
 
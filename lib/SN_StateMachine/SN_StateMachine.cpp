@@ -0,0 +1,146 @@
+#include <SN_StateMachine.h>
+
+StateMachine::StateMachine(const sm_state_desc_t *states, uint8_t num_states,
+                           const sm_transition_t *transitions, uint8_t num_transitions,
+                           void *ctx, sm_clock_t clock)
+    : states_(states), num_states_(num_states),
+      transitions_(transitions), num_transitions_(num_transitions),
+      ctx_(ctx), clock_(clock), listener_(nullptr), valid_(true),
+      current_(SM_NO_STATE), transitions_taken_(0),
+      trace_(), trace_head_(0), trace_count_(0) {
+    if (num_states == SM_NO_STATE) valid_ = false;
+
+    for (uint8_t i = 0; valid_ && i < num_states; i++) {
+        if (states[i].id != i) {
+            valid_ = false;
+            break;
+        }
+        // Walking up must reach the top level within SM_MAX_DEPTH steps
+        // (this also rejects parent loops)
+        sm_state_t s = i;
+        uint8_t depth = 0;
+        while (s != SM_NO_STATE) {
+            if (s >= num_states || ++depth > SM_MAX_DEPTH) {
+                valid_ = false;
+                break;
+            }
+            s = states[s].parent;
+        }
+    }
+}
+
+bool StateMachine::isAncestorOrSelf(sm_state_t ancestor, sm_state_t s) const {
+    while (s != SM_NO_STATE) {
+        if (s == ancestor) return true;
+        s = states_[s].parent;
+    }
+    return false;
+}
+
+bool StateMachine::isIn(sm_state_t s) const {
+    if (current_ == SM_NO_STATE) return false;
+    return isAncestorOrSelf(s, current_);
+}
+
+const char *StateMachine::stateName(sm_state_t s) const {
+    if (s >= num_states_ || states_[s].name == nullptr) return "?";
+    return states_[s].name;
+}
+
+void StateMachine::start(sm_state_t initial) {
+    if (!valid_ || initial >= num_states_) return;
+
+    uint32_t start_us = clock_();
+    sm_state_t from = current_;
+    current_ = SM_NO_STATE;
+    transitionTo(initial, nullptr);
+    record(start_us, from, initial, SM_NO_EVENT);
+}
+
+bool StateMachine::dispatch(sm_event_t event) {
+    if (!valid_ || current_ == SM_NO_STATE) return false;
+
+    // Innermost state first, then outwards
+    for (sm_state_t s = current_; s != SM_NO_STATE; s = states_[s].parent) {
+        for (uint8_t i = 0; i < num_transitions_; i++) {
+            const sm_transition_t &t = transitions_[i];
+            if (t.from != s || t.event != event) continue;
+            if (t.guard != nullptr && !t.guard(ctx_)) continue;
+
+            if (t.to == SM_NO_STATE) {
+                if (t.action != nullptr) t.action(ctx_);
+                return true;
+            }
+            if (t.to >= num_states_) return false;
+
+            uint32_t start_us = clock_();
+            sm_state_t from = current_;
+            transitionTo(t.to, t.action);
+            record(start_us, from, t.to, event);
+            return true;
+        }
+    }
+    return false;
+}
+
+void StateMachine::run() {
+    if (!valid_ || current_ == SM_NO_STATE) return;
+
+    for (sm_state_t s = current_; s != SM_NO_STATE; s = states_[s].parent) {
+        if (states_[s].on_run != nullptr) {
+            sm_event_t event = states_[s].on_run(ctx_);
+            if (event != SM_NO_EVENT) dispatch(event);
+            return;
+        }
+    }
+}
+
+void StateMachine::transitionTo(sm_state_t target, sm_action_t action) {
+    // Exit up to the closest state that strictly contains the target
+    sm_state_t s = current_;
+    while (s != SM_NO_STATE && !(s != target && isAncestorOrSelf(s, target))) {
+        if (states_[s].on_exit != nullptr) states_[s].on_exit(ctx_);
+        s = states_[s].parent;
+    }
+    sm_state_t common = s;
+
+    if (action != nullptr) action(ctx_);
+
+    // Enter from just below the common ancestor down to the target
+    sm_state_t path[SM_MAX_DEPTH];
+    uint8_t depth = 0;
+    for (sm_state_t p = target; p != common && p != SM_NO_STATE; p = states_[p].parent) {
+        path[depth++] = p;
+    }
+    current_ = target;
+    while (depth > 0) {
+        sm_state_t p = path[--depth];
+        if (states_[p].on_entry != nullptr) states_[p].on_entry(ctx_);
+    }
+}
+
+void StateMachine::record(uint32_t start_us, sm_state_t from, sm_state_t to, sm_event_t event) {
+    sm_trace_entry_t &entry = trace_[trace_head_];
+    entry.time_us = start_us;
+    entry.duration_us = clock_() - start_us;
+    entry.from = from;
+    entry.to = to;
+    entry.event = event;
+
+    trace_head_ = (uint8_t)((trace_head_ + 1) % SN_SM_TRACE_DEPTH);
+    if (trace_count_ < SN_SM_TRACE_DEPTH) trace_count_++;
+    transitions_taken_++;
+
+    if (listener_ != nullptr) listener_(entry, ctx_);
+}
+
+const sm_trace_entry_t &StateMachine::traceAt(uint8_t index) const {
+    if (index >= trace_count_) index = trace_count_ ? (uint8_t)(trace_count_ - 1) : 0;
+    uint8_t oldest = (uint8_t)((trace_head_ + SN_SM_TRACE_DEPTH - trace_count_) % SN_SM_TRACE_DEPTH);
+    return trace_[(oldest + index) % SN_SM_TRACE_DEPTH];
+}
+
+void StateMachine::clearTrace() {
+    trace_head_ = 0;
+    trace_count_ = 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <stdint.h>
+
+// ============================================================================
+// TABLE-DRIVEN HIERARCHICAL STATE MACHINE
+// ============================================================================
+// Behaviour is described by two constant tables:
+//   - states:      id, parent (SM_NO_STATE for top level), name and optional
+//                  entry / exit / run actions. The table is indexed by id,
+//                  i.e. states[i].id == i.
+//   - transitions: from, event, guard, to, action. The first row whose guard
+//                  passes wins. Rows are looked up for the current state
+//                  first, then for each of its parents, so a superstate can
+//                  handle an event for all of its children. A row with
+//                  to == SM_NO_STATE is an internal transition: it consumes
+//                  the event (and runs its action) without leaving the state.
+//
+// A transition exits from the current state up to (not including) the
+// closest common ancestor of source and target, runs the transition action,
+// then enters down to the target. A self-transition exits and re-enters.
+// Entry and exit actions therefore only run when the state really changes.
+//
+// run() executes the run action of the current state, or of its closest
+// ancestor that has one. A run action may return an event, which is
+// dispatched immediately.
+//
+// Every transition is recorded in a ring buffer (oldest entries are
+// overwritten) with the time it started and how long the exit, transition
+// and entry actions took, read from the clock passed to the constructor.
+//
+// Not thread safe: dispatch() and run() must be called from one task.
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_SM_TRACE_DEPTH
+#define SN_SM_TRACE_DEPTH 16
+#endif
+
+static_assert(SN_SM_TRACE_DEPTH > 0 && SN_SM_TRACE_DEPTH <= 128, "SN_SM_TRACE_DEPTH must be 1..128");
+
+#define SM_MAX_DEPTH 8          // Maximum nesting of states
+#define SM_NO_STATE 0xFF
+#define SM_NO_EVENT 0xFF
+
+typedef uint8_t sm_state_t;
+typedef uint8_t sm_event_t;
+
+typedef void (*sm_action_t)(void *ctx);
+typedef bool (*sm_guard_t)(void *ctx);
+typedef sm_event_t (*sm_run_t)(void *ctx);
+typedef uint32_t (*sm_clock_t)();
+
+typedef struct {
+    sm_state_t id;
+    sm_state_t parent;
+    const char *name;
+    sm_action_t on_entry;
+    sm_action_t on_exit;
+    sm_run_t on_run;
+} sm_state_desc_t;
+
+typedef struct {
+    sm_state_t from;
+    sm_event_t event;
+    sm_guard_t guard;           // nullptr = always
+    sm_state_t to;              // SM_NO_STATE = internal transition
+    sm_action_t action;         // nullptr = none
+} sm_transition_t;
+
+typedef struct {
+    uint32_t time_us;           // When the transition started
+    uint32_t duration_us;       // Exit + transition + entry actions
+    sm_state_t from;            // SM_NO_STATE for the initial entry by start()
+    sm_state_t to;
+    sm_event_t event;           // SM_NO_EVENT for the initial entry by start()
+} sm_trace_entry_t;
+
+// Called after every transition, once the target has been entered
+typedef void (*sm_listener_t)(const sm_trace_entry_t &entry, void *ctx);
+
+class StateMachine {
+public:
+    StateMachine(const sm_state_desc_t *states, uint8_t num_states,
+                 const sm_transition_t *transitions, uint8_t num_transitions,
+                 void *ctx, sm_clock_t clock);
+
+    // False if the state table is not indexed by id, a parent is unknown or
+    // the nesting is deeper than SM_MAX_DEPTH. An invalid machine ignores
+    // start(), dispatch() and run().
+    bool valid() const { return valid_; }
+
+    void setListener(sm_listener_t listener) { listener_ = listener; }
+
+    // Enter the initial state (and its parents, outermost first)
+    void start(sm_state_t initial);
+
+    // Returns true if the event was handled (including internal transitions)
+    bool dispatch(sm_event_t event);
+
+    // Run the current state's run action and dispatch the event it returns
+    void run();
+
+    sm_state_t state() const { return current_; }
+
+    // True if the current state is s or is nested inside s
+    bool isIn(sm_state_t s) const;
+
+    const char *stateName(sm_state_t s) const;
+
+    uint32_t transitionCount() const { return transitions_taken_; }
+
+    // Transition trace, oldest first
+    uint8_t traceCount() const { return trace_count_; }
+    const sm_trace_entry_t &traceAt(uint8_t index) const;
+    void clearTrace();
+
+private:
+    const sm_state_desc_t *states_;
+    uint8_t num_states_;
+    const sm_transition_t *transitions_;
+    uint8_t num_transitions_;
+    void *ctx_;
+    sm_clock_t clock_;
+    sm_listener_t listener_;
+    bool valid_;
+
+    sm_state_t current_;
+    uint32_t transitions_taken_;
+
+    sm_trace_entry_t trace_[SN_SM_TRACE_DEPTH];
+    uint8_t trace_head_;
+    uint8_t trace_count_;
+
+    bool isAncestorOrSelf(sm_state_t ancestor, sm_state_t s) const;
+    void transitionTo(sm_state_t target, sm_action_t action);
+    void record(uint32_t start_us, sm_state_t from, sm_state_t to, sm_event_t event);
+};
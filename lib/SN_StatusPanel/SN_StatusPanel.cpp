@@ -2,6 +2,7 @@
 #include <SN_StatusPanel.h>
 #include <SN_XR_Board_Types.h>
 #include <SN_Logger.h>
+#include <SN_Trace.h>
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include "freertos/FreeRTOS.h"
@@ -130,7 +131,10 @@ void updateStatusLEDs() {
 
 void led_task(void *pvParameters) {
   for (;;) {
-    updateStatusLEDs();
+    {
+      SN_TRACE_SCOPE("led_update");
+      updateStatusLEDs();
+    }
     vTaskDelay(pdMS_TO_TICKS(50)); // Refresh rate of 20Hz
   }
 }
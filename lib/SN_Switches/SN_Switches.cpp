@@ -4,6 +4,7 @@
 
 #include <SN_Logger.h>
 #include <SN_Common.h>
+#include <SN_Trace.h>
 
 extern xr4_system_context_t xr4_system_context;
 
@@ -67,6 +68,7 @@ static volatile uint8_t lastEncoderState = 0;
  * getting stuck if an interrupt is missed during debouncing.
  */
 void IRAM_ATTR SN_Switches_EStop_ISR() {
+    SN_TRACE_BEGIN("estop_isr");
     unsigned long currentTime = millis();
     
     // Read current pin state immediately
@@ -83,6 +85,7 @@ void IRAM_ATTR SN_Switches_EStop_ISR() {
             // Debounce period has passed - accept the new state
             estopRawState = currentState;
             lastEStopInterruptTime = currentTime;
+            SN_TRACE_INSTANT("estop", currentState == HIGH);
             
             // LEVEL-BASED: Update to match current pin state
             if (currentState == HIGH) {
@@ -102,6 +105,7 @@ void IRAM_ATTR SN_Switches_EStop_ISR() {
         // else: Debounce timer hasn't expired yet - ignore this transition
     }
     // else: Same state as before - this is just switch bounce, ignore it
+    SN_TRACE_END("estop_isr");
 }
 
 /**
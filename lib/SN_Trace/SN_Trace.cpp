@@ -0,0 +1,127 @@
+#include <SN_Trace.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <chrono>
+#endif
+
+static trace_event_t trace_ring[SN_TRACE_DEPTH];
+static uint32_t trace_next = 0;             // Slots claimed since the last clear
+static volatile bool trace_enabled = true;
+
+#if defined(ARDUINO)
+
+SN_TRACE_IRAM uint32_t SN_Trace_NowUs() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+static inline SN_TRACE_IRAM uint8_t traceCore() {
+    return (uint8_t)xPortGetCoreID();
+}
+
+static inline SN_TRACE_IRAM const char *traceThread() {
+    return xPortInIsrContext() ? "ISR" : pcTaskGetTaskName(NULL);
+}
+
+#else
+
+uint32_t SN_Trace_NowUs() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline uint8_t traceCore() { return 0; }
+static inline const char *traceThread() { return "host"; }
+
+#endif
+
+static SN_TRACE_IRAM void traceRecord(char phase, const char *name, uint32_t time_us, uint32_t arg) {
+    if (!trace_enabled) return;
+
+    uint32_t index = __atomic_fetch_add(&trace_next, 1, __ATOMIC_RELAXED);
+    trace_event_t &event = trace_ring[index & (SN_TRACE_DEPTH - 1)];
+
+    __atomic_store_n(&event.seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    event.time_us = time_us;
+    event.name = name;
+    event.thread = traceThread();
+    event.arg = arg;
+    event.phase = phase;
+    event.core = traceCore();
+    __atomic_store_n(&event.seq, index + 1, __ATOMIC_RELEASE);
+}
+
+SN_TRACE_IRAM void SN_Trace_Begin(const char *name) {
+    traceRecord(TRACE_PHASE_BEGIN, name, SN_Trace_NowUs(), 0);
+}
+
+SN_TRACE_IRAM void SN_Trace_End(const char *name) {
+    traceRecord(TRACE_PHASE_END, name, SN_Trace_NowUs(), 0);
+}
+
+SN_TRACE_IRAM void SN_Trace_Instant(const char *name, uint32_t arg) {
+    traceRecord(TRACE_PHASE_INSTANT, name, SN_Trace_NowUs(), arg);
+}
+
+SN_TRACE_IRAM void SN_Trace_Complete(const char *name, uint32_t start_us, uint32_t duration_us) {
+    traceRecord(TRACE_PHASE_COMPLETE, name, start_us, duration_us);
+}
+
+void SN_Trace_SetEnabled(bool enabled) {
+    trace_enabled = enabled;
+}
+
+void SN_Trace_Clear() {
+    bool was_enabled = trace_enabled;
+    trace_enabled = false;
+    for (uint32_t i = 0; i < SN_TRACE_DEPTH; i++) {
+        __atomic_store_n(&trace_ring[i].seq, 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&trace_next, 0, __ATOMIC_RELEASE);
+    trace_enabled = was_enabled;
+}
+
+uint32_t SN_Trace_Recorded() {
+    return __atomic_load_n(&trace_next, __ATOMIC_ACQUIRE);
+}
+
+void SN_Trace_Dump(trace_print_t print) {
+    bool was_enabled = trace_enabled;
+    trace_enabled = false;
+
+    uint32_t end = SN_Trace_Recorded();
+    uint32_t start = end > SN_TRACE_DEPTH ? end - SN_TRACE_DEPTH : 0;
+
+    char line[128];
+    snprintf(line, sizeof(line), "# SN_TRACE BEGIN recorded=%lu kept=%lu",
+             (unsigned long)end, (unsigned long)(end - start));
+    print(line);
+    print("# seq,time_us,phase,core,thread,name,arg");
+
+    for (uint32_t index = start; index < end; index++) {
+        const trace_event_t &slot = trace_ring[index & (SN_TRACE_DEPTH - 1)];
+
+        // Copy, then check the slot was not rewritten meanwhile (writers that
+        // claimed a slot before the pause may still be finishing)
+        uint32_t seq = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+        trace_event_t event;
+        memcpy(&event, (const void *)&slot, sizeof(event));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq != index + 1 || __atomic_load_n(&slot.seq, __ATOMIC_RELAXED) != seq) continue;
+
+        snprintf(line, sizeof(line), "%lu,%lu,%c,%u,%s,%s,%lu",
+                 (unsigned long)seq, (unsigned long)event.time_us, event.phase,
+                 (unsigned)event.core, event.thread ? event.thread : "?",
+                 event.name ? event.name : "?", (unsigned long)event.arg);
+        print(line);
+    }
+
+    print("# SN_TRACE END");
+    trace_enabled = was_enabled;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+
+// ============================================================================
+// EVENT TRACE (ISRs, tasks and radio callbacks on one timeline)
+// ============================================================================
+// Fixed-size ring of begin / end / instant / complete events, each with a
+// microsecond timestamp (esp_timer), the core it was recorded on and the
+// recording context (FreeRTOS task name, or "ISR").
+//
+// Recording is lock-free and safe from any task on either core and from
+// ISRs: a writer claims a slot with an atomic increment and publishes it by
+// storing the slot's sequence number last. When the ring is full the oldest
+// events are overwritten. A reader copies a slot and keeps it only if the
+// sequence number is unchanged, so a slot being rewritten is skipped rather
+// than printed torn.
+//
+// SN_Trace_Dump() prints the ring, oldest first, as text lines framed by
+// "# SN_TRACE BEGIN" / "# SN_TRACE END" so the block can be cut out of a
+// serial log. tools/trace2chrome.py turns one or more such logs into Chrome
+// trace / Perfetto JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Event names must be string literals (only the pointer is stored) and must
+// not contain commas.
+//
+// Build with -D SN_TRACE_ENABLED=0 to compile the trace points out.
+// Kept free of Arduino dependencies so it can be built on the host.
+// ============================================================================
+
+// Defaults (can be overridden in platformio.ini build_flags)
+#ifndef SN_TRACE_ENABLED
+#define SN_TRACE_ENABLED 1
+#endif
+
+#ifndef SN_TRACE_DEPTH
+#define SN_TRACE_DEPTH 256              // Events kept, power of two (24 bytes each)
+#endif
+
+#ifndef SN_TRACE_LOOP_MIN_US
+#define SN_TRACE_LOOP_MIN_US 1000       // Only loop() passes at least this long are traced
+#endif
+
+static_assert((SN_TRACE_DEPTH & (SN_TRACE_DEPTH - 1)) == 0, "SN_TRACE_DEPTH must be a power of two");
+
+#if defined(ARDUINO)
+#include "esp_attr.h"
+#define SN_TRACE_IRAM IRAM_ATTR
+#else
+#define SN_TRACE_IRAM
+#endif
+
+// Chrome trace event phases
+#define TRACE_PHASE_BEGIN    'B'
+#define TRACE_PHASE_END      'E'
+#define TRACE_PHASE_INSTANT  'i'
+#define TRACE_PHASE_COMPLETE 'X'        // arg holds the duration in us
+
+typedef struct {
+    uint32_t seq;               // Claim index + 1 once published, 0 while being written
+    uint32_t time_us;
+    const char *name;
+    const char *thread;         // Task name or "ISR"
+    uint32_t arg;
+    char phase;
+    uint8_t core;
+} trace_event_t;
+
+// Receives one formatted line (without newline) per call
+typedef void (*trace_print_t)(const char *line);
+
+// Microsecond clock used for timestamps (low 32 bits of esp_timer_get_time())
+uint32_t SN_Trace_NowUs();
+
+void SN_Trace_Begin(const char *name);
+void SN_Trace_End(const char *name);
+void SN_Trace_Instant(const char *name, uint32_t arg);
+void SN_Trace_Complete(const char *name, uint32_t start_us, uint32_t duration_us);
+
+// Pause / resume recording (events recorded while paused are dropped)
+void SN_Trace_SetEnabled(bool enabled);
+
+void SN_Trace_Clear();
+
+// Events recorded since the last clear, including overwritten ones
+uint32_t SN_Trace_Recorded();
+
+// Print the ring (recording is paused meanwhile)
+void SN_Trace_Dump(trace_print_t print);
+
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : name_(name) { SN_Trace_Begin(name_); }
+    ~TraceScope() { SN_Trace_End(name_); }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name_;
+};
+
+#define SN_TRACE_CONCAT_(a, b) a##b
+#define SN_TRACE_CONCAT(a, b) SN_TRACE_CONCAT_(a, b)
+
+#if SN_TRACE_ENABLED
+#define SN_TRACE_SCOPE(name) TraceScope SN_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define SN_TRACE_BEGIN(name) SN_Trace_Begin(name)
+#define SN_TRACE_END(name) SN_Trace_End(name)
+#define SN_TRACE_INSTANT(name, arg) SN_Trace_Instant(name, (uint32_t)(arg))
+#define SN_TRACE_COMPLETE(name, start_us, duration_us) SN_Trace_Complete(name, start_us, duration_us)
+#else
+#define SN_TRACE_SCOPE(name) do {} while (0)
+#define SN_TRACE_BEGIN(name) do {} while (0)
+#define SN_TRACE_END(name) do {} while (0)
+#define SN_TRACE_INSTANT(name, arg) do {} while (0)
+#define SN_TRACE_COMPLETE(name, start_us, duration_us) do {} while (0)
+#endif
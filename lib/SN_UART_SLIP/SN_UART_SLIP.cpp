@@ -24,7 +24,6 @@ void SN_UART_SLIP_Init() {
 }
 
 
-#define UART_NUM UART_NUM_0
 #define MAX_COMMANDS 16
 #define INPUT_BUFFER_SIZE 128
 #define MAX_ARGS 8
@@ -73,9 +72,14 @@ static void serial_console_task(void *arg) {
     printf("Serial Console Ready. Type 'help' for commands.\n");
 
     while (true) {
-        uint8_t ch;
-        int len = uart_read_bytes(UART_NUM, &ch, 1, pdMS_TO_TICKS(10));
-        if (len > 0) {
+        // UART0 is owned by the Arduino Serial driver (SN_UART_SLIP_Init), so
+        // read through it instead of installing the IDF UART driver on top
+        if (Serial.available() <= 0) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        int ch = Serial.read();
+        if (ch >= 0) {
             if (ch == '\r' || ch == '\n') {
                 if (pos > 0) {
                     input_line[pos] = '\0';
@@ -83,23 +87,14 @@ static void serial_console_task(void *arg) {
                     pos = 0;
                 }
             } else if (pos < INPUT_BUFFER_SIZE - 1) {
-                input_line[pos++] = ch;
+                input_line[pos++] = (char)ch;
             }
         }
     }
 }
 
+// Call after SN_UART_SLIP_Init()
 void serial_console_start(void) {
-    uart_config_t uart_config = {
-        .baud_rate = 115200,
-        .data_bits = UART_DATA_8_BITS,
-        .parity    = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE
-    };
-    uart_param_config(UART_NUM, &uart_config);
-    uart_driver_install(UART_NUM, 1024, 0, 0, NULL, 0);
-
     serial_console_register_command("help", command_help, "Show this help message");
     xTaskCreate(serial_console_task, "serial_console", 4096, NULL, 5, NULL);
 }
\ No newline at end of file
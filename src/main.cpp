@@ -10,6 +10,9 @@
 #include <SN_Joystick.h>
 #include <SN_Motors.h>
 #include <SN_StatusPanel.h>
+#include <SN_StateMachine.h>
+#include <SN_Trace.h>
+#include <SN_RuntimeStats.h>
 
 #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
 #include <SN_Switches.h>
@@ -37,6 +40,194 @@ const char* rr(esp_reset_reason_t r){
     default: return "OTHER";
   }
 }
+
+// ============================================================================
+// SYSTEM STATE MACHINE (shared by CTU and OBC)
+// ============================================================================
+// Leaf state ids are the XR4_STATE_* values and are mirrored into
+// xr4_system_context.system_state on every transition. Two superstates group
+// them:
+//   STARTUP     - INITIALIZED, COMMS_CONFIG
+//   OPERATIONAL - WAITING_FOR_ARM, ARMED, EMERGENCY_STOP (runs the board
+//                 main handler)
+// The E-STOP and ARM inputs are turned into events in loop() only when they
+// change or the state changed, so LED actions run once per transition
+// instead of every pass.
+// Entry actions only touch the status LEDs and the trace. The motors belong
+// to the OBC control task, which stops them from system_state (mirrored by
+// onStateTransition) on its next tick.
+// ============================================================================
+
+#define XR4_SM_STARTUP      9
+#define XR4_SM_OPERATIONAL  10
+
+enum {
+  XR4_EV_INIT_DONE,
+  XR4_EV_COMMS_OK,
+  XR4_EV_COMMS_FAILED,
+  XR4_EV_ESTOP_ENGAGED,
+  XR4_EV_ESTOP_RELEASED,
+  XR4_EV_ARMED,
+  XR4_EV_DISARMED,
+};
+
+static const char* const xr4_event_names[] = {
+  "INIT_DONE", "COMMS_OK", "COMMS_FAILED", "ESTOP_ENGAGED", "ESTOP_RELEASED", "ARMED", "DISARMED"
+};
+
+static void dumpStateTrace();
+
+static uint32_t smClock() {
+  return (uint32_t)micros();
+}
+
+// ---- Entry actions ----
+static void enterInitialized(void*) {
+  SN_StatusPanel__SetStatusLedState(Solid_Blue); // Initializing
+}
+
+static void enterWaitingForArm(void*) {
+  SN_StatusPanel__SetStatusLedState(Moving_Back_Forth); // Waiting for arming
+}
+
+static void enterArmed(void*) {
+  SN_StatusPanel__SetStatusLedState(Solid_Green); // Armed and operational
+}
+
+static void enterEmergencyStop(void*) {
+  SN_StatusPanel__SetStatusLedState(Blink_Red); // Emergency stop active
+}
+
+static void enterError(void*) {
+  SN_StatusPanel__SetStatusLedState(Solid_Red);
+  dumpStateTrace();
+}
+
+static void enterOtaUpdate(void*) {
+  SN_StatusPanel__SetStatusLedState(Blink_XR4);
+  logMessage(true, "Main Loop", "Entering OTA Firmware Update mode...");
+  // After OTA update, system should reboot or return to a safe state
+}
+
+static void enterReboot(void*) {
+  SN_StatusPanel__SetStatusLedState(Blink_Yellow);
+  logMessage(true, "Main Loop", "Rebooting system...");
+  delay(100); // Give time for log message to send
+  ESP.restart();
+}
+
+// ---- Run actions (every loop pass) ----
+static sm_event_t runInitialized(void*) {
+  return XR4_EV_INIT_DONE;
+}
+
+static sm_event_t runCommsConfig(void*) {
+  if (SN_ESPNOW_Init()) {
+    logMessage(true, "Main Loop", "ESP-NOW initialized successfully in COMMS_CONFIG state");
+    espnow_init_success = true; // Set flag when ESP-NOW initializes successfully
+    return XR4_EV_COMMS_OK;
+  }
+  logMessage(true, "Main Loop", "ESP-NOW initialization failed in COMMS_CONFIG state");
+  espnow_init_success = false; // Clear flag on failure
+  return XR4_EV_COMMS_FAILED;
+}
+
+static sm_event_t runOperational(void*) {
+  #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
+  // Also runs in EMERGENCY_STOP: the handler must keep processing ESP-NOW
+  // messages, otherwise the OBC can never receive the command to exit ESTOP.
+  // The control task keeps the motors stopped while Emergency_Stop is set.
+  SN_OBC_MainHandler();   // OBC Handler - GPS runs independently via ticker
+  #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
+  SN_CTU_MainHandler();   // CTU Handler
+  #endif
+  return SM_NO_EVENT;
+}
+
+static sm_event_t runError(void*) {
+  #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
+  // Update switches to enable encoder navigation even in error state
+  SN_Switches_Update();
+  SwitchStates_t error_state_switches = SN_Switches_GetStates();
+
+  // Handle encoder navigation for LCD pages
+  if (error_state_switches.encoder_delta > 0) {
+    SN_LCD_NextPage();
+  } else if (error_state_switches.encoder_delta < 0) {
+    SN_LCD_PrevPage();
+  }
+
+  // Update encoder position in context (for display on CONTROL page)
+  xr4_system_context.Encoder_Pos = (uint16_t)error_state_switches.encoder_position;
+
+  // Update LCD to show error status even in error state
+  SN_LCD_Update(&xr4_system_context);
+  #endif
+  return SM_NO_EVENT;
+}
+
+// ---- Guards ----
+static bool isArmed(void*) {
+  return xr4_system_context.Armed;
+}
+
+static const sm_state_desc_t xr4_states[] = {
+  // id                         parent               name               entry                exit     run
+  { XR4_STATE_JUST_POWERED_ON,  SM_NO_STATE,         "JUST_POWERED_ON", nullptr,             nullptr, nullptr },
+  { XR4_STATE_INITIALIZED,      XR4_SM_STARTUP,      "INITIALIZED",     enterInitialized,    nullptr, runInitialized },
+  { XR4_STATE_COMMS_CONFIG,     XR4_SM_STARTUP,      "COMMS_CONFIG",    nullptr,             nullptr, runCommsConfig },
+  { XR4_STATE_WAITING_FOR_ARM,  XR4_SM_OPERATIONAL,  "WAITING_FOR_ARM", enterWaitingForArm,  nullptr, nullptr },
+  { XR4_STATE_ARMED,            XR4_SM_OPERATIONAL,  "ARMED",           enterArmed,          nullptr, nullptr },
+  { XR4_STATE_ERROR,            SM_NO_STATE,         "ERROR",           enterError,          nullptr, runError },
+  { XR4_STATE_EMERGENCY_STOP,   XR4_SM_OPERATIONAL,  "EMERGENCY_STOP",  enterEmergencyStop,  nullptr, nullptr },
+  { XR4_STATE_OTA_FW_UPDATE,    SM_NO_STATE,         "OTA_FW_UPDATE",   enterOtaUpdate,      nullptr, nullptr },
+  { XR4_STATE_REBOOT,           SM_NO_STATE,         "REBOOT",          enterReboot,         nullptr, nullptr },
+  { XR4_SM_STARTUP,             SM_NO_STATE,         "STARTUP",         nullptr,             nullptr, nullptr },
+  { XR4_SM_OPERATIONAL,         SM_NO_STATE,         "OPERATIONAL",     nullptr,             nullptr, runOperational },
+};
+
+static const sm_transition_t xr4_transitions[] = {
+  // from                        event                   guard    to                          action
+  { XR4_STATE_INITIALIZED,       XR4_EV_INIT_DONE,       nullptr, XR4_STATE_COMMS_CONFIG,     nullptr },
+  { XR4_STATE_COMMS_CONFIG,      XR4_EV_COMMS_OK,        nullptr, XR4_STATE_WAITING_FOR_ARM,  nullptr },
+  { XR4_STATE_COMMS_CONFIG,      XR4_EV_COMMS_FAILED,    nullptr, XR4_STATE_ERROR,            nullptr },
+
+  // E-STOP overrides ARM; while stopped, ARM changes are ignored
+  { XR4_STATE_EMERGENCY_STOP,    XR4_EV_ESTOP_ENGAGED,   nullptr, SM_NO_STATE,                nullptr },
+  { XR4_STATE_EMERGENCY_STOP,    XR4_EV_ESTOP_RELEASED,  isArmed, XR4_STATE_ARMED,            nullptr },
+  { XR4_STATE_EMERGENCY_STOP,    XR4_EV_ESTOP_RELEASED,  nullptr, XR4_STATE_WAITING_FOR_ARM,  nullptr },
+  { XR4_STATE_EMERGENCY_STOP,    XR4_EV_ARMED,           nullptr, SM_NO_STATE,                nullptr },
+  { XR4_STATE_EMERGENCY_STOP,    XR4_EV_DISARMED,        nullptr, SM_NO_STATE,                nullptr },
+  { XR4_SM_OPERATIONAL,          XR4_EV_ESTOP_ENGAGED,   nullptr, XR4_STATE_EMERGENCY_STOP,   nullptr },
+
+  { XR4_STATE_WAITING_FOR_ARM,   XR4_EV_ARMED,           nullptr, XR4_STATE_ARMED,            nullptr },
+  { XR4_STATE_ARMED,             XR4_EV_DISARMED,        nullptr, XR4_STATE_WAITING_FOR_ARM,  nullptr },
+};
+
+static StateMachine xr4_state_machine(xr4_states, sizeof(xr4_states) / sizeof(xr4_states[0]),
+                                      xr4_transitions, sizeof(xr4_transitions) / sizeof(xr4_transitions[0]),
+                                      nullptr, smClock);
+
+static void onStateTransition(const sm_trace_entry_t &entry, void*) {
+  xr4_system_context.system_state = entry.to;
+  SN_TRACE_INSTANT("state", entry.to);
+
+  const char* event_name = entry.event < sizeof(xr4_event_names) / sizeof(xr4_event_names[0])
+                           ? xr4_event_names[entry.event] : "START";
+  logMessage(true, "Main Loop", "State %s -> %s on %s (%lu us)",
+             xr4_state_machine.stateName(entry.from), xr4_state_machine.stateName(entry.to),
+             event_name, (unsigned long)entry.duration_us);
+}
+
+// Log the transition trace, oldest first
+static void dumpStateTrace() {
+  for (uint8_t i = 0; i < xr4_state_machine.traceCount(); i++) {
+    const sm_trace_entry_t &entry = xr4_state_machine.traceAt(i);
+    logMessage(false, "State Trace", "%lu us: %s -> %s (%lu us)",
+               (unsigned long)entry.time_us, xr4_state_machine.stateName(entry.from),
+               xr4_state_machine.stateName(entry.to), (unsigned long)entry.duration_us);
+  }
+}
  
 void setup() {
 
@@ -60,6 +251,10 @@ void setup() {
 
   SN_StatusPanel__Init(); // Init Status Panel
 
+  SN_RuntimeStats_Init();       // CPU load / stack / heap sampling
+  SN_Handler_InitDiagnostics(); // "prof", "trace" and "stats" console commands
+  serial_console_start();    // Serial console commands (type "help")
+
   #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
     SN_Switches_Init(); // Init CTU switches with interrupts and debouncing
     SN_Joystick_Init(); // Init Joystick
@@ -71,6 +266,9 @@ void setup() {
     
     // Start background sensor reading task (IMU/MAG) - Zero latency!
     SN_OBC_StartBackgroundSensorTask();
+
+    // Start fixed-rate motor control task (telecommand intake, link watchdog, motors)
+    SN_OBC_StartControlTask();
     
     bool gps_ok = SN_GPS_Init(); // Init GPS - capture return but don't block on it
     if (!gps_ok) {
@@ -80,15 +278,22 @@ void setup() {
     }
   #endif
 
-  // Set initial state to INITIALIZED (ESP-NOW will be initialized in loop state machine)
-  xr4_system_context.system_state = XR4_STATE_INITIALIZED;
+  // Enter INITIALIZED (ESP-NOW will be initialized in loop state machine)
+  if (!xr4_state_machine.valid()) {
+    logMessage(true, "Main Logger", "State table invalid - check xr4_states ids and parents");
+  }
+  xr4_state_machine.setListener(onStateTransition);
+  xr4_state_machine.start(XR4_STATE_INITIALIZED);
   logMessage(false, "Main Logger", "System initialized - ESP-NOW will initialize in main loop");
 
   logMessage(false, "Main Logger", "setup() - end");
 
 }
 
+
 void loop() {
+  uint32_t loop_start_us = SN_Trace_NowUs();
+
   // Update CTU switch states before state transitions
   // NOTE: E-STOP is handled by hardware interrupt - updates context directly
   #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
@@ -98,170 +303,31 @@ void loop() {
   // which updates the context. E-STOP is updated directly by ISR.
   #endif
 
-  // High-priority checks for safety and state transitions
-  #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-  if (xr4_system_context.Emergency_Stop && xr4_system_context.system_state != XR4_STATE_EMERGENCY_STOP) {
-      logMessage(true, "Main Loop", "EMERGENCY STOP DETECTED - Switching to EMERGENCY_STOP state");
-      SN_StatusPanel__SetStatusLedState(Blink_Red);
-      SN_Motors_Stop(); // Immediately stop motors
-      xr4_system_context.system_state = XR4_STATE_EMERGENCY_STOP;
-  } else if (!xr4_system_context.Emergency_Stop && xr4_system_context.system_state == XR4_STATE_EMERGENCY_STOP) {
-      // ESTOP released - transition back to appropriate state
-      if (xr4_system_context.Armed) {
-          logMessage(true, "Main Loop", "ESTOP released, ARM ON - Switching to ARMED state");
-          SN_StatusPanel__SetStatusLedState(Solid_Green);
-          xr4_system_context.system_state = XR4_STATE_ARMED;
-      } else {
-          logMessage(true, "Main Loop", "ESTOP released, ARM OFF - Switching to WAITING_FOR_ARM state");
-          SN_StatusPanel__SetStatusLedState(Moving_Back_Forth);
-          xr4_system_context.system_state = XR4_STATE_WAITING_FOR_ARM;
-      }
-  } else if (!xr4_system_context.Armed && (xr4_system_context.system_state == XR4_STATE_ARMED || xr4_system_context.system_state == XR4_STATE_WAITING_FOR_ARM)) {
-      logMessage(true, "Main Loop", "Disarmed signal received - moving to WAITING_FOR_ARM state.");
-      SN_StatusPanel__SetStatusLedState(Moving_Back_Forth);
-      xr4_system_context.system_state = XR4_STATE_WAITING_FOR_ARM;
+  // Safety inputs -> events. Re-posted after every transition so a state that
+  // is entered with E-STOP or ARM already set reacts to it on the next pass.
+  static bool last_estop = false;
+  static bool last_armed = false;
+  static uint32_t last_transition_count = UINT32_MAX;
+  bool estop = xr4_system_context.Emergency_Stop;
+  bool armed = xr4_system_context.Armed;
+  if (estop != last_estop || armed != last_armed || xr4_state_machine.transitionCount() != last_transition_count) {
+    last_estop = estop;
+    last_armed = armed;
+    xr4_state_machine.dispatch(estop ? XR4_EV_ESTOP_ENGAGED : XR4_EV_ESTOP_RELEASED);
+    xr4_state_machine.dispatch(armed ? XR4_EV_ARMED : XR4_EV_DISARMED);
+    last_transition_count = xr4_state_machine.transitionCount();
   }
-  #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
-  // CTU state transitions based on switch positions
-  if (xr4_system_context.Emergency_Stop && xr4_system_context.system_state != XR4_STATE_EMERGENCY_STOP && xr4_system_context.system_state != XR4_STATE_ERROR) {
-      logMessage(true, "Main Loop", "CTU EMERGENCY STOP DETECTED - Switching to EMERGENCY_STOP state");
-      SN_StatusPanel__SetStatusLedState(Blink_Red);
-      xr4_system_context.system_state = XR4_STATE_EMERGENCY_STOP;
-  } else if (!xr4_system_context.Emergency_Stop && xr4_system_context.system_state == XR4_STATE_EMERGENCY_STOP) {
-      // E-STOP released - return to appropriate state based on ARM switch
-      if (xr4_system_context.Armed) {
-          logMessage(true, "Main Loop", "CTU E-STOP released, ARM ON - Switching to ARMED state");
-          SN_StatusPanel__SetStatusLedState(Solid_Green);
-          xr4_system_context.system_state = XR4_STATE_ARMED;
-      } else {
-          logMessage(true, "Main Loop", "CTU E-STOP released, ARM OFF - Switching to WAITING_FOR_ARM state");
-          SN_StatusPanel__SetStatusLedState(Moving_Back_Forth);
-          xr4_system_context.system_state = XR4_STATE_WAITING_FOR_ARM;
-      }
-  } else if (xr4_system_context.Armed && xr4_system_context.system_state == XR4_STATE_WAITING_FOR_ARM) {
-      logMessage(true, "Main Loop", "CTU Armed - Switching to ARMED state");
-      SN_StatusPanel__SetStatusLedState(Solid_Green);
-      xr4_system_context.system_state = XR4_STATE_ARMED;
-  } else if (!xr4_system_context.Armed && xr4_system_context.system_state == XR4_STATE_ARMED) {
-      logMessage(true, "Main Loop", "CTU Disarmed - Switching to WAITING_FOR_ARM state");
-      SN_StatusPanel__SetStatusLedState(Moving_Back_Forth);
-      xr4_system_context.system_state = XR4_STATE_WAITING_FOR_ARM;
-  }
-  #endif
-
-  switch (xr4_system_context.system_state) {
-    case XR4_STATE_INITIALIZED:
-      // Perform actions for INITIALIZED state
-      SN_StatusPanel__SetStatusLedState(Solid_Blue); // Initializing
-      xr4_system_context.system_state = XR4_STATE_COMMS_CONFIG;
-      break;
-
-    case XR4_STATE_COMMS_CONFIG:
-      if (SN_ESPNOW_Init()) {
-        logMessage(true, "Main Loop", "ESP-NOW initialized successfully in COMMS_CONFIG state");
-        espnow_init_success = true; // Set flag when ESP-NOW initializes successfully
-        SN_StatusPanel__SetStatusLedState(Solid_Blue);
-        xr4_system_context.system_state = XR4_STATE_WAITING_FOR_ARM;
-      } else {
-        logMessage(true, "Main Loop", "ESP-NOW initialization failed in COMMS_CONFIG state");
-        espnow_init_success = false; // Clear flag on failure
-        // Handle initialization failure (e.g., retry, set error state, etc.)
-        xr4_system_context.system_state = XR4_STATE_ERROR;
-      }
-      break;
-
-    case XR4_STATE_WAITING_FOR_ARM:
-      // Perform actions for WAITING_FOR_ARM state
-      SN_StatusPanel__SetStatusLedState(Moving_Back_Forth); // Waiting for arming
-      #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-      SN_OBC_MainHandler();   // OBC Handler - GPS runs independently via ticker
-      #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
-      SN_CTU_MainHandler();   // CTU Handler
-      #endif
-      break;
-
-    case XR4_STATE_ARMED: // Merged ARMED into WAITING_FOR_ARM as SN_OBC_MainHandler handles armed/disarmed logic internally
-      SN_StatusPanel__SetStatusLedState(Solid_Green); // Armed and operational
-      #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-      SN_OBC_MainHandler();   // OBC Handler - GPS runs independently via ticker
-      
-      // OPTIONAL: Enable real-time pin monitoring (only when MOTOR_DIAGNOSTIC_MODE is false)
-      // Uncomment to monitor pins during operation
-      // MotorDiagnostics::monitorPinsRealtime();
-      
-      #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
-      SN_CTU_MainHandler();   // CTU Handler
-      #endif
-      break;
-
-    case XR4_STATE_ERROR: {
-      // Perform actions for ERROR state
-      SN_StatusPanel__SetStatusLedState(Solid_Red);
-      #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
-      // Update switches to enable encoder navigation even in error state
-      SN_Switches_Update();
-      SwitchStates_t error_state_switches = SN_Switches_GetStates();
-      
-      // Handle encoder navigation for LCD pages
-      if (error_state_switches.encoder_delta > 0) {
-        SN_LCD_NextPage();
-      } else if (error_state_switches.encoder_delta < 0) {
-        SN_LCD_PrevPage();
-      }
-      
-      // Update encoder position in context (for display on CONTROL page)
-      xr4_system_context.Encoder_Pos = (uint16_t)error_state_switches.encoder_position;
-      
-      // Update LCD to show error status even in error state
-      SN_LCD_Update(&xr4_system_context);
-      #elif SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-      SN_Motors_Stop();
-      #endif
-      break;
-    }
-
-    case XR4_STATE_EMERGENCY_STOP: {      // Perform actions for EMERGENCY_STOP state
-      SN_StatusPanel__SetStatusLedState(Blink_Red); // Emergency stop active
-      #if SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-      // CRITICAL: Must still run main handler to process incoming ESP-NOW messages
-      // Otherwise the OBC can never receive the command to exit ESTOP!
-      // The handler will internally stop motors when Emergency_Stop flag is true
-      SN_OBC_MainHandler();
-      #elif SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
-      // Update CTU display and inputs even in emergency stop
-      SN_CTU_MainHandler();
-      #endif
-      break;
-    }
 
-    case XR4_STATE_OTA_FW_UPDATE: {
-      // Perform actions for OTA_FW_UPDATE state
-      SN_StatusPanel__SetStatusLedState(Blink_XR4);
-      logMessage(true, "Main Loop", "Entering OTA Firmware Update mode...");
-      #if SN_XR4_BOARD_TYPE == SN_XR4_CTU_ESP32
+  xr4_state_machine.run();
 
+  SN_RuntimeStats_Update();   // Samples once per SN_RUNTIME_STATS_INTERVAL_MS
 
-      #elif SN_XR4_BOARD_TYPE == SN_XR4_OBC_ESP32
-
-      #endif
-
-      // After OTA update, system should reboot or return to a safe state
-      break;
-    }
-
-    case XR4_STATE_REBOOT: {      // Perform actions for REBOOT state
-      SN_StatusPanel__SetStatusLedState(Blink_Yellow);
-      logMessage(true, "Main Loop", "Rebooting system...");
-      delay(100); // Give time for log message to send
-      ESP.restart();
-      break;
-    }
-
-    default:
-      // Handle unknown states
-      break;
+  // Every pass would flood the trace ring; keep only the slow ones
+  uint32_t loop_us = SN_Trace_NowUs() - loop_start_us;
+  if (loop_us >= SN_TRACE_LOOP_MIN_US) {
+    SN_TRACE_COMPLETE("loop", loop_start_us, loop_us);
   }
-  
+
   // ULTRA LOW LATENCY: Removed delay entirely for maximum responsiveness
   // With taskYIELD(), scheduler allows other tasks to run without blocking
   // This gives sub-millisecond response time - professional competition-grade
@@ -269,4 +335,4 @@ void loop() {
 
   // The SN_StatusPanel__MainLoop() is no longer needed here
   // as it is handled by a dedicated FreeRTOS task.
-}
\ No newline at end of file
+}
@@ -0,0 +1,164 @@
+// Tests for the battery-sag feed-forward (lib/SN_DriveControl/SN_BatteryCompensator.*):
+// pio test -e native -f test_battery_compensator
+//
+// The OBC calls updateVoltage() every control tick with Main_Bus_V, which the
+// sensor task refreshes every 200 ms; the replays below hold each reading for
+// a sensor period the same way.
+
+#include <unity.h>
+#include <math.h>
+#include <SN_BatteryCompensator.h>
+
+static const float TICK_S = 1.0f / 250.0f;
+static const int TICKS_PER_READING = 50;    // 200 ms sensor period
+
+static const battery_comp_config_t CONFIG = {
+    11.1f,      // nominal_v
+    0.8f,       // min_gain
+    1.25f,      // max_gain
+    2.0f,       // filter_tau_s
+    6.0f,       // min_valid_v
+};
+
+// Feeds volts(t) for duration_s, sampled once per sensor period and held in between
+template <typename VoltageFn>
+static void replay(BatteryCompensator &comp, float &t, float duration_s, VoltageFn volts) {
+    int ticks = (int)lroundf(duration_s / TICK_S);
+    float reading = volts(t);
+    for (int i = 0; i < ticks; i++) {
+        if (i % TICKS_PER_READING == 0) reading = volts(t);
+        comp.updateVoltage(reading, TICK_S);
+        t += TICK_S;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_reading_sets_the_gain_directly() {
+    BatteryCompensator comp(CONFIG);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, comp.gain());
+    comp.updateVoltage(12.0f, TICK_S);
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, comp.filteredVoltage());
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 11.1f / 12.0f, comp.gain());
+}
+
+// Full charge down to a flat pack over ten minutes: the gain follows
+// nominal / voltage with the filter lag, then pins at max_gain
+void test_discharge_trace_tracks_and_clamps_gain() {
+    BatteryCompensator comp(CONFIG);
+    auto discharge = [](float t) { return 12.6f - 4.6f * t / 600.0f; };   // 12.6 V -> 8.0 V
+    float t = 0.0f;
+    bool clamped_seen = false;
+    while (t < 600.0f) {
+        replay(comp, t, 10.0f, discharge);
+        // Slope x tau of lag, plus up to one held reading
+        float lag = 4.6f / 600.0f * (CONFIG.filter_tau_s + 0.2f);
+        TEST_ASSERT_FLOAT_WITHIN(lag + 0.01f, discharge(t), comp.filteredVoltage());
+
+        float expected = CONFIG.nominal_v / comp.filteredVoltage();
+        if (expected > CONFIG.max_gain) {
+            TEST_ASSERT_EQUAL_FLOAT(CONFIG.max_gain, comp.gain());
+            clamped_seen = true;
+        } else {
+            TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected, comp.gain());
+        }
+        TEST_ASSERT_TRUE(comp.gain() >= CONFIG.min_gain && comp.gain() <= CONFIG.max_gain);
+    }
+    TEST_ASSERT_TRUE(clamped_seen);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 8.0f, comp.filteredVoltage());
+}
+
+void test_overvoltage_clamps_to_min_gain() {
+    BatteryCompensator comp(CONFIG);
+    comp.updateVoltage(14.8f, TICK_S);     // Charger connected
+    TEST_ASSERT_EQUAL_FLOAT(CONFIG.min_gain, comp.gain());
+}
+
+// Motor inrush pulls the bus down for half a second: the filter keeps the
+// gain from chasing it, and a sustained step is followed at tau
+void test_load_sag_step_is_filtered() {
+    BatteryCompensator comp(CONFIG);
+    float t = 0.0f;
+    replay(comp, t, 5.0f, [](float) { return 11.1f; });
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, comp.gain());
+
+    float peak_gain = 0.0f;
+    int ticks = (int)lroundf(0.5f / TICK_S);
+    for (int i = 0; i < ticks; i++) {
+        comp.updateVoltage(9.9f, TICK_S);
+        if (comp.gain() > peak_gain) peak_gain = comp.gain();
+    }
+    // Unfiltered this would be 11.1 / 9.9 = 1.12
+    TEST_ASSERT_LESS_THAN_FLOAT(1.03f, peak_gain);
+    TEST_ASSERT_GREATER_THAN_FLOAT(1.0f, peak_gain);
+
+    replay(comp, t, 10.0f, [](float) { return 11.1f; });
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 1.0f, comp.gain());
+
+    // Sustained 1.2 V step: 63 % of the way after one time constant
+    BatteryCompensator step(CONFIG);
+    step.updateVoltage(11.1f, TICK_S);
+    float v0 = step.filteredVoltage();
+    for (int i = 0; i < (int)lroundf(CONFIG.filter_tau_s / TICK_S); i++) step.updateVoltage(9.9f, TICK_S);
+    float fraction = (v0 - step.filteredVoltage()) / (11.1f - 9.9f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f - expf(-1.0f), fraction);
+}
+
+void test_invalid_reading_disables_compensation() {
+    BatteryCompensator comp(CONFIG);
+    comp.updateVoltage(10.0f, TICK_S);
+    TEST_ASSERT_TRUE(comp.gain() > 1.0f);
+
+    comp.updateVoltage(0.0f, TICK_S);       // ADC disabled or not read yet
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, comp.gain());
+    drive_mix_t same = comp.apply({-40, 30});
+    TEST_ASSERT_EQUAL_INT16(-40, same.left);
+    TEST_ASSERT_EQUAL_INT16(30, same.right);
+
+    // The next valid reading restarts the filter instead of ramping from the old value
+    comp.updateVoltage(12.0f, TICK_S);
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, comp.filteredVoltage());
+}
+
+void test_apply_scales_and_desaturates_keeping_the_ratio() {
+    BatteryCompensator comp(CONFIG);
+    comp.updateVoltage(8.0f, TICK_S);      // Pinned at max_gain 1.25
+    TEST_ASSERT_EQUAL_FLOAT(1.25f, comp.gain());
+
+    drive_mix_t scaled = comp.apply({-40, 20});
+    TEST_ASSERT_EQUAL_INT16(-50, scaled.left);
+    TEST_ASSERT_EQUAL_INT16(25, scaled.right);
+
+    // -112.5 / 56.25 would clip one side only; both come down by 100 / 112.5
+    drive_mix_t saturated = comp.apply({-90, 45});
+    TEST_ASSERT_EQUAL_INT16(-100, saturated.left);
+    TEST_ASSERT_EQUAL_INT16(50, saturated.right);
+
+    // Every saturated input keeps its left:right ratio to within rounding
+    for (int left = -100; left <= 100; left += 5) {
+        for (int right = -100; right <= 100; right += 5) {
+            drive_mix_t out = comp.apply({(int16_t)left, (int16_t)right});
+            TEST_ASSERT_TRUE(out.left >= -100 && out.left <= 100);
+            TEST_ASSERT_TRUE(out.right >= -100 && out.right <= 100);
+            TEST_ASSERT_INT_WITHIN(100, out.left * right, out.right * left);
+        }
+    }
+
+    comp.reset();
+    comp.updateVoltage(14.8f, TICK_S);     // Pinned at min_gain 0.8
+    drive_mix_t reduced = comp.apply({-100, 100});
+    TEST_ASSERT_EQUAL_INT16(-80, reduced.left);
+    TEST_ASSERT_EQUAL_INT16(80, reduced.right);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_reading_sets_the_gain_directly);
+    RUN_TEST(test_discharge_trace_tracks_and_clamps_gain);
+    RUN_TEST(test_overvoltage_clamps_to_min_gain);
+    RUN_TEST(test_load_sag_step_is_filtered);
+    RUN_TEST(test_invalid_reading_disables_compensation);
+    RUN_TEST(test_apply_scales_and_desaturates_keeping_the_ratio);
+    return UNITY_END();
+}
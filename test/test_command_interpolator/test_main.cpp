@@ -0,0 +1,180 @@
+// Host tests for CommandInterpolator (lib/SN_DriveControl/SN_DriveControl.*):
+// pio test -e native -f test_command_interpolator
+
+#include <unity.h>
+#include <SN_DriveControl.h>
+#include <SN_SendPolicy.h>
+
+#include <vector>
+
+static const uint16_t NEUTRAL_X = 2117;
+static const uint16_t NEUTRAL_Y = 2000;
+static const uint32_t TRANSIT_US = 1000;    // Fixed radio delay for the unit tests
+
+static const cmd_interp_config_t LINEAR = {
+    CMD_INTERP_LINEAR, 0, 40000, 250000, NEUTRAL_X, NEUTRAL_Y
+};
+
+// Add a sample sent at tx_us (CTU clock) and received TRANSIT_US later
+static void add(CommandInterpolator &interp, uint32_t tx_us, uint16_t x, uint16_t y, bool settled = false) {
+    TEST_ASSERT_TRUE(interp.addSample(tx_us, tx_us + TRANSIT_US, x, y, true, settled));
+}
+
+// Evaluate at the local time that corresponds to CTU time t_us
+static cmd_interp_result_t at(CommandInterpolator &interp, uint32_t t_us, uint16_t &x, uint16_t &y) {
+    return interp.evaluate(t_us + TRANSIT_US, x, y);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_interpolates_between_samples() {
+    CommandInterpolator interp(LINEAR);
+    uint16_t x = 0, y = 0;
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_NONE, interp.evaluate(0, x, y));
+
+    add(interp, 0, NEUTRAL_X, 2000);
+    add(interp, 10000, NEUTRAL_X, 3000);
+    add(interp, 20000, NEUTRAL_X, 3000);
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_INTERPOLATED, at(interp, 5000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(2500, y);
+    TEST_ASSERT_EQUAL_UINT16(NEUTRAL_X, x);
+}
+
+void test_extrapolation_limited_to_last_step() {
+    CommandInterpolator interp(LINEAR);
+    uint16_t x = 0, y = 0;
+    add(interp, 0, NEUTRAL_X, 2500);
+    add(interp, 10000, NEUTRAL_X, 3000);
+
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_EXTRAPOLATED, at(interp, 14000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(3200, y);
+    // The slope would reach 4500 at the horizon; it stops one step (500) on
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_EXTRAPOLATED, at(interp, 40000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(3500, y);
+}
+
+void test_extrapolation_stops_at_neutral() {
+    CommandInterpolator interp(LINEAR);
+    uint16_t x = 0, y = 0;
+    add(interp, 0, NEUTRAL_X, 2600);
+    add(interp, 10000, NEUTRAL_X, 2100);
+
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_EXTRAPOLATED, at(interp, 11000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(2050, y);
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_EXTRAPOLATED, at(interp, 30000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(NEUTRAL_Y, y);
+}
+
+// Past the horizon the newest sample is held, not the extrapolated value
+void test_newest_sample_held_after_horizon() {
+    CommandInterpolator interp(LINEAR);
+    uint16_t x = 0, y = 0;
+    add(interp, 0, NEUTRAL_X, 2500);
+    add(interp, 10000, NEUTRAL_X, 3000);
+
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_HELD, at(interp, 10000 + 40001, x, y));
+    TEST_ASSERT_EQUAL_UINT16(3000, y);
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_HELD, at(interp, 300000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(3000, y);
+}
+
+void test_settled_sample_is_not_extrapolated() {
+    CommandInterpolator interp(LINEAR);
+    uint16_t x = 0, y = 0;
+    add(interp, 0, NEUTRAL_X, 2500);
+    add(interp, 10000, NEUTRAL_X, 3000, true);
+
+    TEST_ASSERT_EQUAL(CMD_INTERP_RESULT_HELD, at(interp, 15000, x, y));
+    TEST_ASSERT_EQUAL_UINT16(3000, y);
+}
+
+// Replays a full-forward stick released to 2010 over 25 ms: CTU loop at
+// 1 kHz through the real send policy, 2..5 ms radio delay, OBC control
+// task at 250 Hz. The command must fall from full forward to the final
+// position without ever going through neutral into reverse, and must not
+// wait for the 100 ms heartbeat to get there.
+static void runRelease(bool use_settled_flag) {
+    const uint16_t SETTLED = 1 << 8;
+    const tc_send_policy_config_t policy_config = {
+        5, 100, 24, 1 << 7, 20, 8, NEUTRAL_X, NEUTRAL_Y, 50, (uint16_t)(use_settled_flag ? SETTLED : 0)
+    };
+    const cmd_interp_config_t interp_config = {
+        CMD_INTERP_LINEAR, 5000, 40000, 250000, NEUTRAL_X, NEUTRAL_Y
+    };
+    TelecommandSendPolicy policy(policy_config);
+    CommandInterpolator interp(interp_config);
+
+    const uint32_t CLOCK_OFFSET_US = 123456789;     // OBC clock minus CTU clock
+    const uint32_t RELEASE_START_MS = 200;
+    const uint32_t RELEASE_MS = 25;
+    const uint16_t FINAL_Y = 2010;
+
+    struct Frame { uint32_t tx_us; uint32_t rx_us; uint16_t x; uint16_t y; bool settled; };
+    std::vector<Frame> frames;
+
+    for (uint32_t ms = 0; ms < 500; ms++) {
+        uint16_t y = 4095;
+        if (ms >= RELEASE_START_MS + RELEASE_MS) {
+            y = FINAL_Y;
+        } else if (ms >= RELEASE_START_MS) {
+            y = (uint16_t)(4095 - (4095 - FINAL_Y) * (ms - RELEASE_START_MS) / RELEASE_MS);
+        }
+        telecommand_data_t tc = {};
+        tc.Joystick_X = NEUTRAL_X;
+        tc.Joystick_Y = y;
+        tc_send_reason_t reason = policy.evaluate(tc, ms);
+        if (reason != TC_SEND_NONE) {
+            policy.onSent(tc, ms, reason);
+            uint32_t tx_us = ms * 1000;
+            uint32_t rx_us = tx_us + CLOCK_OFFSET_US + 2000 + (frames.size() % 4) * 1000;
+            frames.push_back({tx_us, rx_us, tc.Joystick_X, tc.Joystick_Y, (tc.flags & SETTLED) != 0});
+        }
+    }
+
+    size_t next = 0;
+    uint16_t x = 0, y = 0;
+    uint16_t min_y = 4095;
+    uint32_t reached_final_ms = 0;
+    for (uint32_t now_us = CLOCK_OFFSET_US; now_us < CLOCK_OFFSET_US + 500000; now_us += 4000) {
+        while (next < frames.size() && frames[next].rx_us <= now_us) {
+            const Frame &f = frames[next++];
+            interp.addSample(f.tx_us, f.rx_us, f.x, f.y, true, f.settled);
+        }
+        if (interp.evaluate(now_us, x, y) == CMD_INTERP_RESULT_NONE) continue;
+
+        uint32_t local_ms = (now_us - CLOCK_OFFSET_US) / 1000;
+        if (local_ms >= RELEASE_START_MS && y < min_y) min_y = y;
+        if (reached_final_ms == 0 && local_ms > RELEASE_START_MS && y == FINAL_Y) reached_final_ms = local_ms;
+    }
+
+    TEST_ASSERT_GREATER_OR_EQUAL(NEUTRAL_Y, min_y);
+    TEST_ASSERT_EQUAL_UINT16(FINAL_Y, y);
+    TEST_ASSERT_NOT_EQUAL(0, reached_final_ms);
+    if (use_settled_flag) {
+        // Final position applied within the settle time plus transit, not a heartbeat later
+        TEST_ASSERT_LESS_OR_EQUAL(RELEASE_START_MS + RELEASE_MS + 20 + 15, reached_final_ms);
+    }
+}
+
+void test_stick_release_never_commands_reverse() {
+    runRelease(true);
+}
+
+// Same release with an older CTU that never sets the settled flag: the
+// clamp alone has to keep the command out of reverse
+void test_stick_release_without_settled_flag() {
+    runRelease(false);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_interpolates_between_samples);
+    RUN_TEST(test_extrapolation_limited_to_last_step);
+    RUN_TEST(test_extrapolation_stops_at_neutral);
+    RUN_TEST(test_newest_sample_held_after_horizon);
+    RUN_TEST(test_settled_sample_is_not_extrapolated);
+    RUN_TEST(test_stick_release_never_commands_reverse);
+    RUN_TEST(test_stick_release_without_settled_flag);
+    return UNITY_END();
+}
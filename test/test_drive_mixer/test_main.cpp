@@ -0,0 +1,109 @@
+// Golden-output tests for the differential-drive mixer (lib/SN_DriveControl/SN_DriveMixer.*):
+// pio test -e native -f test_drive_mixer
+//
+// The expected values are for the default axis settings (X neutral 2117,
+// Y neutral 2000, deadband 50, no expo, full scale). A change to the curve
+// or the mix has to update this table on purpose.
+
+#include <unity.h>
+#include <SN_DriveMixer.h>
+
+struct GoldenMix {
+    uint16_t x, y;              // Raw joystick ADC
+    int16_t steering, throttle; // Shaped axes, 0.1 %
+    int16_t left, right;        // Mixed output, percent
+};
+
+static const GoldenMix GOLDEN[] = {
+    // Centre and deadband edges
+    {2117, 2000,     0,     0,    0,    0},
+    {2167, 2050,     0,     0,    0,    0},
+    {2068, 1950,     0,     0,    0,    0},
+    // Full scale on one axis
+    {2117, 4095,     0,  1000, -100,  100},
+    {2117,    0,     0, -1000,  100, -100},
+    {4095, 2000,  1000,     0, -100, -100},
+    {   0, 2000, -1000,     0,  100,  100},
+    // Half stick, both halves normalised from the off-centre neutral
+    {2117, 3048,     0,   488,  -49,   49},
+    {2600, 2600,   225,   269,  -49,    4},
+    // Saturated: both sides scaled by the same factor, turn ratio kept
+    {4095, 4095,  1000,  1000, -100,    0},
+    {   0, 4095, -1000,  1000,    0,  100},
+    {3106, 4095,   487,  1000, -100,   34},
+    {3106, 3048,   487,   488,  -98,    0},
+    {4095, 3048,  1000,   488, -100,  -34},
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_golden_points() {
+    for (const GoldenMix &g : GOLDEN) {
+        TEST_ASSERT_EQUAL_INT16(g.steering, SN_DriveMixer_Steering(g.x));
+        TEST_ASSERT_EQUAL_INT16(g.throttle, SN_DriveMixer_Throttle(g.y));
+        drive_mix_t mix = SN_DriveMixer_Mix(g.x, g.y);
+        TEST_ASSERT_EQUAL_INT16(g.left, mix.left);
+        TEST_ASSERT_EQUAL_INT16(g.right, mix.right);
+    }
+}
+
+// Whole deadband maps to exactly zero, the first count outside it does not jump
+void test_deadband_is_exact_and_continuous() {
+    for (int adc = 2117 - 50; adc <= 2117 + 50; adc++) TEST_ASSERT_EQUAL_INT16(0, SN_DriveMixer_Steering(adc));
+    for (int adc = 2000 - 50; adc <= 2000 + 50; adc++) TEST_ASSERT_EQUAL_INT16(0, SN_DriveMixer_Throttle(adc));
+    TEST_ASSERT_LESS_OR_EQUAL(1, SN_DriveMixer_Steering(2117 + 51));
+    TEST_ASSERT_GREATER_OR_EQUAL(-1, SN_DriveMixer_Throttle(2000 - 51));
+}
+
+void test_tables_are_monotonic() {
+    for (int adc = 1; adc < MIXER_ADC_RANGE; adc++) {
+        TEST_ASSERT_GREATER_OR_EQUAL(SN_DriveMixer_Steering(adc - 1), SN_DriveMixer_Steering(adc));
+        TEST_ASSERT_GREATER_OR_EQUAL(SN_DriveMixer_Throttle(adc - 1), SN_DriveMixer_Throttle(adc));
+    }
+}
+
+void test_out_of_range_adc_clamps() {
+    TEST_ASSERT_EQUAL_INT16(1000, SN_DriveMixer_Steering(5000));
+    TEST_ASSERT_EQUAL_INT16(1000, SN_DriveMixer_Throttle(0xFFFF));
+}
+
+// expo blends a cubic into the response; scale limits full scale
+void test_expo_and_scale_tables() {
+    static const MixerAxisTable expo({2000, 50, 50, 100});
+    static const MixerAxisTable scaled({2000, 50, 0, 60});
+
+    const uint16_t adc[] = {0, 1000, 1950, 2051, 2500, 3022, 3500, 4095};
+    const int16_t expo_golden[] = {-1000, -301, 0, 0, 115, 291, 533, 1000};
+    const int16_t scaled_golden[] = {-600, -292, 0, 0, 132, 285, 425, 600};
+    for (size_t i = 0; i < sizeof(adc) / sizeof(adc[0]); i++) {
+        TEST_ASSERT_EQUAL_INT16(expo_golden[i], expo[adc[i]]);
+        TEST_ASSERT_EQUAL_INT16(scaled_golden[i], scaled[adc[i]]);
+    }
+}
+
+// Desaturation keeps left:right for every saturated input
+void test_clipping_preserves_turn_ratio() {
+    for (int steering = -1000; steering <= 1000; steering += 50) {
+        for (int throttle = -1000; throttle <= 1000; throttle += 50) {
+            int32_t left = -steering - throttle;
+            int32_t right = -steering + throttle;
+            drive_mix_t mix = SN_DriveMixer_MixShaped(steering, throttle);
+            TEST_ASSERT_LESS_OR_EQUAL(100, mix.left < 0 ? -mix.left : mix.left);
+            TEST_ASSERT_LESS_OR_EQUAL(100, mix.right < 0 ? -mix.right : mix.right);
+            // Cross-multiplied ratio, within one percent of rounding on either side
+            TEST_ASSERT_INT_WITHIN(1000 + 1000, (int32_t)mix.left * right, (int32_t)mix.right * left);
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_golden_points);
+    RUN_TEST(test_deadband_is_exact_and_continuous);
+    RUN_TEST(test_tables_are_monotonic);
+    RUN_TEST(test_out_of_range_adc_clamps);
+    RUN_TEST(test_expo_and_scale_tables);
+    RUN_TEST(test_clipping_preserves_turn_ratio);
+    return UNITY_END();
+}
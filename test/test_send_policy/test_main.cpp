@@ -0,0 +1,224 @@
+// Host tests for TelecommandSendPolicy (lib/SN_SendPolicy): pio test -e native -f test_send_policy
+
+#include <unity.h>
+#include <SN_SendPolicy.h>
+
+// SN_ESPNOW is not built on the host (SN_ESPNOW.cpp needs the ESP32 SDK), so
+// compile the codec into the test directly
+#include <SN_ESPNOW_Wire.cpp>
+
+static const uint16_t ESTOP = 1 << 7;
+static const uint16_t SETTLED = 1 << 8;
+static const uint16_t NEUTRAL_X = 2117;
+static const uint16_t NEUTRAL_Y = 2000;
+
+static const tc_send_policy_config_t CONFIG = {
+    5,          // min_gap_ms
+    100,        // heartbeat_ms
+    24,         // joystick_delta_threshold
+    ESTOP,      // safety_flags_mask
+    20,         // settle_ms
+    8,          // joystick_still_threshold
+    NEUTRAL_X,
+    NEUTRAL_Y,
+    50,         // neutral_deadband
+    SETTLED,
+};
+
+static telecommand_data_t stick(uint16_t x, uint16_t y) {
+    telecommand_data_t tc = {};
+    tc.Joystick_X = x;
+    tc.Joystick_Y = y;
+    return tc;
+}
+
+// One CTU loop pass: evaluate, and "send" if the policy says so
+static tc_send_reason_t pass(TelecommandSendPolicy &policy, telecommand_data_t tc, uint32_t now_ms,
+                             telecommand_data_t *sent = nullptr) {
+    tc_send_reason_t reason = policy.evaluate(tc, now_ms);
+    if (reason != TC_SEND_NONE) {
+        policy.onSent(tc, now_ms, reason);
+        if (sent) *sent = tc;
+    }
+    return reason;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_pass_and_heartbeat() {
+    TelecommandSendPolicy policy(CONFIG);
+    TEST_ASSERT_EQUAL(TC_SEND_HEARTBEAT, pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 0));
+    for (uint32_t t = 1; t < 100; t++) {
+        TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), t));
+    }
+    TEST_ASSERT_EQUAL(TC_SEND_HEARTBEAT, pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 100));
+}
+
+void test_safety_edge_bypasses_min_gap() {
+    TelecommandSendPolicy policy(CONFIG);
+    pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 0);
+    telecommand_data_t tc = stick(NEUTRAL_X, NEUTRAL_Y);
+    tc.flags = ESTOP;
+    TEST_ASSERT_EQUAL(TC_SEND_SAFETY_EDGE, pass(policy, tc, 1));
+}
+
+void test_joystick_delta_respects_min_gap() {
+    TelecommandSendPolicy policy(CONFIG);
+    pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 0);
+    TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(3000, NEUTRAL_Y), 2));
+    TEST_ASSERT_EQUAL(TC_SEND_JOYSTICK_DELTA, pass(policy, stick(3000, NEUTRAL_Y), 5));
+    TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(3010, NEUTRAL_Y), 10));
+}
+
+// Stick pushed forward and held: the position it stops at (less than one
+// delta threshold from the last frame) goes out settle_ms later, flagged
+void test_trailing_frame_after_settle_time() {
+    TelecommandSendPolicy policy(CONFIG);
+    telecommand_data_t sent;
+    pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 0);
+
+    TEST_ASSERT_EQUAL(TC_SEND_JOYSTICK_DELTA, pass(policy, stick(NEUTRAL_X, 3000), 10, &sent));
+    TEST_ASSERT_EQUAL_UINT16(0, sent.flags & SETTLED);
+
+    // Final position, 20 counts on: below the delta threshold
+    uint32_t t = 11;
+    for (; t < 31; t++) {
+        TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(NEUTRAL_X, 3020), t));
+    }
+    TEST_ASSERT_EQUAL(TC_SEND_SETTLED, pass(policy, stick(NEUTRAL_X, 3020), t, &sent));
+    TEST_ASSERT_EQUAL_UINT16(3020, sent.Joystick_Y);
+    TEST_ASSERT_EQUAL_UINT16(SETTLED, sent.flags & SETTLED);
+
+    // Only once; heartbeats keep the flag while the stick rests
+    TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(NEUTRAL_X, 3022), t + 50));
+    TEST_ASSERT_EQUAL(TC_SEND_HEARTBEAT, pass(policy, stick(NEUTRAL_X, 3022), t + 100, &sent));
+    TEST_ASSERT_EQUAL_UINT16(SETTLED, sent.flags & SETTLED);
+    TEST_ASSERT_EQUAL_UINT32(1, policy.sentCount(TC_SEND_SETTLED));
+}
+
+// Noise within joystick_still_threshold does not restart the settle timer
+void test_noise_does_not_delay_settling() {
+    TelecommandSendPolicy policy(CONFIG);
+    pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 0);
+    pass(policy, stick(NEUTRAL_X, 3000), 10);
+    uint32_t t = 11;
+    for (; t < 30; t++) {
+        uint16_t y = (t & 1) ? 3006 : 2998;
+        TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(NEUTRAL_X, y), t));
+    }
+    TEST_ASSERT_EQUAL(TC_SEND_SETTLED, pass(policy, stick(NEUTRAL_X, 3000), t));
+}
+
+// Released stick: the frame that enters the deadband is flagged at once, so
+// the OBC never extrapolates the release slope past neutral
+void test_return_to_deadband_is_settled_immediately() {
+    TelecommandSendPolicy policy(CONFIG);
+    telecommand_data_t sent;
+    pass(policy, stick(NEUTRAL_X, NEUTRAL_Y), 0);
+    pass(policy, stick(NEUTRAL_X, 4095), 10);
+
+    TEST_ASSERT_EQUAL(TC_SEND_JOYSTICK_DELTA, pass(policy, stick(NEUTRAL_X, 2600), 20, &sent));
+    TEST_ASSERT_EQUAL_UINT16(0, sent.flags & SETTLED);
+    TEST_ASSERT_EQUAL(TC_SEND_JOYSTICK_DELTA, pass(policy, stick(NEUTRAL_X, 2010), 30, &sent));
+    TEST_ASSERT_EQUAL_UINT16(SETTLED, sent.flags & SETTLED);
+    TEST_ASSERT_EQUAL(TC_SEND_NONE, pass(policy, stick(NEUTRAL_X, 2010), 60));
+}
+
+// Moving again clears the flag; the flag change alone sends nothing
+void test_moving_clears_settled_flag() {
+    TelecommandSendPolicy policy(CONFIG);
+    telecommand_data_t sent;
+    pass(policy, stick(NEUTRAL_X, 3000), 0, &sent);
+    TEST_ASSERT_EQUAL(TC_SEND_SETTLED, pass(policy, stick(NEUTRAL_X, 3000), 20, &sent));
+
+    telecommand_data_t tc = stick(NEUTRAL_X, 3015);
+    TEST_ASSERT_EQUAL(TC_SEND_NONE, policy.evaluate(tc, 21));
+    TEST_ASSERT_EQUAL_UINT16(0, tc.flags & SETTLED);
+    TEST_ASSERT_EQUAL(TC_SEND_JOYSTICK_DELTA, pass(policy, stick(NEUTRAL_X, 3030), 25, &sent));
+    TEST_ASSERT_EQUAL_UINT16(0, sent.flags & SETTLED);
+}
+
+// The CTU handler's order: build the telecommand, let the policy mark it,
+// send that same struct, then tell the policy what went out. Returns the
+// flags the OBC decodes, or -1 if nothing was sent.
+static int ctuPass(TelecommandSendPolicy &policy, uint16_t x, uint16_t y, uint32_t now_ms, uint16_t seq,
+                   tc_send_reason_t *reason_out = nullptr) {
+    telecommand_data_t tc = stick(x, y);       // SN_Telecommand_updateStruct
+    tc_send_reason_t reason = policy.evaluate(tc, now_ms);
+    if (reason_out) *reason_out = reason;
+    if (reason == TC_SEND_NONE) return -1;
+
+    uint8_t frame[SN_WIRE_MAX_FRAME_LEN];
+    sn_wire_meta_t meta = {seq, now_ms * 1000};
+    size_t len = SN_Wire_EncodeTelecommand(tc, meta, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(len > 0);
+    policy.onSent(tc, now_ms, reason);
+
+    telecommand_data_t received;
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelecommand(frame, len, received));
+    TEST_ASSERT_EQUAL_UINT16(tc.Joystick_Y, received.Joystick_Y);
+    return received.flags;
+}
+
+void test_settled_bit_reaches_encoded_frame() {
+    TelecommandSendPolicy policy(CONFIG);
+    uint16_t seq = 0;
+    ctuPass(policy, NEUTRAL_X, NEUTRAL_Y, 0, seq++);
+    TEST_ASSERT_EQUAL_INT(0, ctuPass(policy, NEUTRAL_X, 3000, 10, seq++) & SETTLED);
+
+    tc_send_reason_t reason = TC_SEND_NONE;
+    int flags = -1;
+    for (uint32_t t = 11; t <= 40 && reason != TC_SEND_SETTLED; t++) {
+        flags = ctuPass(policy, NEUTRAL_X, 3000, t, seq++, &reason);
+    }
+    TEST_ASSERT_EQUAL(TC_SEND_SETTLED, reason);
+    TEST_ASSERT_EQUAL_INT(SETTLED, flags & SETTLED);
+}
+
+// A stick left alone for a second, off centre and then centred: one
+// trailing frame each, everything else is heartbeats
+void test_resting_stick_sends_one_trailing_frame() {
+    const uint16_t positions[] = {3000, NEUTRAL_Y};
+    for (uint16_t rest_y : positions) {
+        TelecommandSendPolicy policy(CONFIG);
+        uint16_t seq = 0;
+        ctuPass(policy, NEUTRAL_X, NEUTRAL_Y, 0, seq++);
+        ctuPass(policy, NEUTRAL_X, 4095, 10, seq++);
+
+        // Count frames that newly carry the settled bit, and what follows it
+        uint32_t settled_edges = 0, after_settled = 0;
+        bool settled = false;
+        for (uint32_t t = 20; t < 1020; t++) {
+            tc_send_reason_t reason;
+            int flags = ctuPass(policy, NEUTRAL_X, rest_y, t, seq++, &reason);
+            if (flags < 0) continue;
+            if (settled) {
+                TEST_ASSERT_EQUAL(TC_SEND_HEARTBEAT, reason);
+                TEST_ASSERT_EQUAL_INT(SETTLED, flags & SETTLED);
+                after_settled++;
+            } else if (flags & SETTLED) {
+                settled = true;
+                settled_edges++;
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT32(1, settled_edges);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, policy.sentCount(TC_SEND_SETTLED));
+        // One heartbeat per TC_SEND_HEARTBEAT_MS, not one per min_gap
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(10, after_settled);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_pass_and_heartbeat);
+    RUN_TEST(test_safety_edge_bypasses_min_gap);
+    RUN_TEST(test_joystick_delta_respects_min_gap);
+    RUN_TEST(test_trailing_frame_after_settle_time);
+    RUN_TEST(test_noise_does_not_delay_settling);
+    RUN_TEST(test_return_to_deadband_is_settled_immediately);
+    RUN_TEST(test_moving_clears_settled_flag);
+    RUN_TEST(test_settled_bit_reaches_encoded_frame);
+    RUN_TEST(test_resting_stick_sends_one_trailing_frame);
+    return UNITY_END();
+}
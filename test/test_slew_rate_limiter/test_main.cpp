@@ -0,0 +1,155 @@
+// Host tests for SlewRateLimiter through MotorGroupT<SimMotor> (lib/SN_Motors):
+// pio test -e native -f test_slew_rate_limiter
+
+#include <unity.h>
+#include <SimMotor.h>
+
+// SN_Motors is not built on the host (Motor.cpp needs the ESP32 SDK), so
+// compile the limiter into the test directly
+#include <SlewRateLimiter.cpp>
+
+static const float DT_S = 0.004f;           // 250 Hz control task
+static const uint64_t DT_US = 4000;
+static const slew_limits_t LIMITS = {500.0f, 1000.0f, 0.0f};
+
+struct Rig {
+    SimClock clock;
+    SimMotor front{clock};
+    SimMotor rear{clock};
+    MotorGroupT<SimMotor> side{front, rear};
+
+    Rig() {
+        side.init();
+        side.setRampLimits(LIMITS);
+    }
+
+    // One control tick towards target; returns the applied speed
+    int16_t tick(int16_t target) {
+        clock.advance(DT_US);
+        side.driveRamped(target, DT_S);
+        return side.speed();
+    }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_accel_limit() {
+    Rig rig;
+    int16_t prev = 0;
+    int ticks = 0;
+    while (rig.side.speed() < 100) {
+        int16_t speed = rig.tick(100);
+        TEST_ASSERT_INT_WITHIN(2, prev, speed);     // 500 %/s * 4 ms
+        prev = speed;
+        TEST_ASSERT_LESS_OR_EQUAL(100, ++ticks);
+    }
+    TEST_ASSERT_EQUAL(50, ticks);                   // 0 -> 100 % in 200 ms
+    TEST_ASSERT_EQUAL(SimMotor::DIR_FORWARD, rig.front.direction());
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, rig.rear.duty());
+}
+
+void test_decel_limit() {
+    Rig rig;
+    rig.side.drive(100);
+    int16_t prev = 100;
+    int ticks = 0;
+    while (rig.side.speed() > 0) {
+        int16_t speed = rig.tick(0);
+        TEST_ASSERT_INT_WITHIN(4, prev, speed);     // 1000 %/s * 4 ms
+        prev = speed;
+        TEST_ASSERT_LESS_OR_EQUAL(100, ++ticks);
+    }
+    TEST_ASSERT_EQUAL(25, ticks);                   // 100 -> 0 % in 100 ms
+    TEST_ASSERT_EQUAL(SimMotor::DIR_STOPPED, rig.front.direction());
+}
+
+// A reversal decelerates to zero at the decel limit, stops there for the
+// tick, then accelerates the other way at the accel limit
+void test_reversal_goes_through_zero() {
+    Rig rig;
+    rig.side.drive(-40);
+    rig.front.clearTimeline();
+
+    int16_t prev = -40;
+    bool stopped = false;
+    for (int i = 0; i < 100; i++) {
+        int16_t speed = rig.tick(40);
+        if (prev < 0) {
+            TEST_ASSERT_INT_WITHIN(4, prev, speed);
+            TEST_ASSERT_LESS_OR_EQUAL(0, speed);    // Never jumps past zero
+        } else {
+            TEST_ASSERT_INT_WITHIN(2, prev, speed);
+        }
+        if (speed == 0) stopped = true;
+        prev = speed;
+    }
+    TEST_ASSERT_TRUE(stopped);
+    TEST_ASSERT_EQUAL(40, rig.side.speed());
+
+    // Backward -> stopped -> forward, with no direct direction flip
+    const std::vector<SimMotor::Event> &events = rig.front.timeline();
+    SimMotor::Direction last = SimMotor::DIR_BACKWARD;
+    for (const SimMotor::Event &e : events) {
+        if (e.direction == SimMotor::DIR_FORWARD) TEST_ASSERT_NOT_EQUAL(SimMotor::DIR_BACKWARD, last);
+        last = e.direction;
+    }
+    TEST_ASSERT_EQUAL(SimMotor::DIR_FORWARD, last);
+}
+
+// E-STOP / link loss: stop() bypasses the ramp, and the next ramp starts from 0
+void test_stop_bypasses_ramp() {
+    Rig rig;
+    for (int i = 0; i < 60; i++) rig.tick(100);
+    TEST_ASSERT_EQUAL(100, rig.side.speed());
+
+    uint64_t stop_time = rig.clock.now_us;
+    rig.side.stop();
+    TEST_ASSERT_EQUAL(0, rig.side.speed());
+    TEST_ASSERT_EQUAL(SimMotor::DIR_STOPPED, rig.front.direction());
+    TEST_ASSERT_EQUAL(SimMotor::DIR_STOPPED, rig.rear.direction());
+    TEST_ASSERT_EQUAL_UINT32(stop_time, rig.front.timeline().back().time_us);
+
+    TEST_ASSERT_EQUAL(2, rig.tick(100));
+}
+
+// drive() also sets the output at once, and the ramp continues from there
+void test_drive_sets_output_immediately() {
+    Rig rig;
+    rig.side.drive(60);
+    TEST_ASSERT_EQUAL(60, rig.side.speed());
+    TEST_ASSERT_EQUAL(62, rig.tick(100));
+}
+
+void test_jerk_limit_on_rate() {
+    SlewRateLimiter limiter({500.0f, 1000.0f, 10000.0f});
+    float prev_rate = 0.0f;
+    for (int i = 0; i < 200; i++) {
+        if (limiter.step(100.0f, DT_S) >= 100.0f) break;   // Arrival zeroes the rate
+        TEST_ASSERT_FLOAT_WITHIN(10000.0f * DT_S + 0.01f, prev_rate, limiter.rate());
+        TEST_ASSERT_LESS_OR_EQUAL(500.0f + 0.01f, limiter.rate());
+        TEST_ASSERT_LESS_OR_EQUAL(100.0f, limiter.output());
+        prev_rate = limiter.rate();
+    }
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, limiter.output());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, limiter.rate());
+}
+
+void test_zero_limit_disables_limiting() {
+    SlewRateLimiter limiter({0.0f, 0.0f, 0.0f});
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, limiter.step(100.0f, DT_S));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, limiter.step(-100.0f, DT_S));     // Reversal still stops at zero first
+    TEST_ASSERT_EQUAL_FLOAT(-100.0f, limiter.step(-100.0f, DT_S));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_accel_limit);
+    RUN_TEST(test_decel_limit);
+    RUN_TEST(test_reversal_goes_through_zero);
+    RUN_TEST(test_stop_bypasses_ramp);
+    RUN_TEST(test_drive_sets_output_immediately);
+    RUN_TEST(test_jerk_limit_on_rate);
+    RUN_TEST(test_zero_limit_disables_limiting);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+// Host tests for SN_SPSC_Queue (lib/SN_Mailbox): pio test -e native -f test_spsc_queue
+
+#include <unity.h>
+#include <SN_SPSC_Queue.h>
+
+#include <atomic>
+#include <thread>
+
+// Large enough that a copy spans several cache lines and can be caught half-written
+struct StressItem {
+    uint32_t seq;
+    uint32_t words[31];     // Every word holds seq ^ (index * 0x9E3779B9)
+};
+
+static const uint32_t STRESS_ITEMS = 200000;
+
+static void fillItem(StressItem &item, uint32_t seq) {
+    item.seq = seq;
+    for (uint32_t i = 0; i < 31; i++) item.words[i] = seq ^ (i * 0x9E3779B9u);
+}
+
+static bool itemIntact(const StressItem &item) {
+    for (uint32_t i = 0; i < 31; i++) {
+        if (item.words[i] != (item.seq ^ (i * 0x9E3779B9u))) return false;
+    }
+    return true;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty_pop_leaves_output_untouched() {
+    SN_SPSC_Queue<int, 4> queue;
+    int out = 42;
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_FALSE(queue.pop(out));
+    TEST_ASSERT_EQUAL_INT(42, out);
+}
+
+void test_fifo_order_and_wrap() {
+    SN_SPSC_Queue<int, 4> queue;
+    int out = 0;
+    for (int round = 0; round < 10; round++) {
+        TEST_ASSERT_TRUE(queue.push(round * 2));
+        TEST_ASSERT_TRUE(queue.push(round * 2 + 1));
+        TEST_ASSERT_EQUAL(2, queue.size());
+        TEST_ASSERT_TRUE(queue.pop(out));
+        TEST_ASSERT_EQUAL_INT(round * 2, out);
+        TEST_ASSERT_TRUE(queue.pop(out));
+        TEST_ASSERT_EQUAL_INT(round * 2 + 1, out);
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_full_queue_keeps_queued_items_and_counts_overflow() {
+    SN_SPSC_Queue<int, 4> queue;
+    TEST_ASSERT_EQUAL(3, queue.capacity());
+    TEST_ASSERT_TRUE(queue.push(1));
+    TEST_ASSERT_TRUE(queue.push(2));
+    TEST_ASSERT_TRUE(queue.push(3));
+    TEST_ASSERT_FALSE(queue.push(4));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.overflows());
+
+    int out = 0;
+    TEST_ASSERT_TRUE(queue.pop(out));
+    TEST_ASSERT_EQUAL_INT(1, out);
+    TEST_ASSERT_TRUE(queue.push(5));
+    TEST_ASSERT_TRUE(queue.pop(out));
+    TEST_ASSERT_EQUAL_INT(2, out);
+    TEST_ASSERT_TRUE(queue.pop(out));
+    TEST_ASSERT_EQUAL_INT(3, out);
+    TEST_ASSERT_TRUE(queue.pop(out));
+    TEST_ASSERT_EQUAL_INT(5, out);
+}
+
+// Producer and consumer hammer the same (small) queue from two threads. The
+// producer retries on full, so the consumer must see every item exactly
+// once, in order and never torn.
+void test_two_thread_stress_no_torn_reads() {
+    static SN_SPSC_Queue<StressItem, 8> queue;
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> out_of_order(0);
+    std::atomic<uint32_t> received(0);
+
+    std::thread consumer([&]() {
+        StressItem item;
+        uint32_t expected = 0;
+        while (expected < STRESS_ITEMS) {
+            if (!queue.pop(item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!itemIntact(item)) torn++;
+            if (item.seq != expected) out_of_order++;
+            expected = item.seq + 1;
+            received++;
+        }
+    });
+
+    std::thread producer([&]() {
+        StressItem item;
+        for (uint32_t seq = 0; seq < STRESS_ITEMS; seq++) {
+            fillItem(item, seq);
+            while (!queue.push(item)) std::this_thread::yield();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, out_of_order.load());
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, received.load());
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_pop_leaves_output_untouched);
+    RUN_TEST(test_fifo_order_and_wrap);
+    RUN_TEST(test_full_queue_keeps_queued_items_and_counts_overflow);
+    RUN_TEST(test_two_thread_stress_no_torn_reads);
+    return UNITY_END();
+}
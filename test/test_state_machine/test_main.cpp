@@ -0,0 +1,311 @@
+// Tests for the table-driven hierarchical state machine (lib/SN_StateMachine):
+// pio test -e native -f test_state_machine
+//
+// The rover table below mirrors the state and transition tables in
+// src/main.cpp (ids, parents and row order); the actions are replaced by
+// recorders. Keep the two in step when the rover table changes.
+
+#include <unity.h>
+#include <string.h>
+#include <SN_StateMachine.h>
+
+// ---- Recorder: entry/exit/action calls as a string, e.g. "x6 e4 " ----
+static char calls[256];
+static uint32_t fake_us;
+static bool armed;
+
+static void note(const char *tag, int id) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%s%d ", tag, id);
+    strncat(calls, buf, sizeof(calls) - strlen(calls) - 1);
+}
+
+static uint32_t fakeClock() {
+    return fake_us += 10;
+}
+
+#define RECORDERS(id) \
+    static void enter##id(void *) { note("e", id); } \
+    static void exit##id(void *) { note("x", id); }
+RECORDERS(0) RECORDERS(1) RECORDERS(2) RECORDERS(3) RECORDERS(4) RECORDERS(5)
+RECORDERS(6) RECORDERS(7) RECORDERS(8) RECORDERS(9) RECORDERS(10)
+
+static void transitionAction(void *) { note("a", 0); }
+static bool isArmed(void *) { return armed; }
+
+// ---- Rover table (src/main.cpp) ----
+enum {
+    ST_JUST_POWERED_ON, ST_INITIALIZED, ST_COMMS_CONFIG, ST_WAITING_FOR_ARM, ST_ARMED,
+    ST_ERROR, ST_EMERGENCY_STOP, ST_OTA_FW_UPDATE, ST_REBOOT, SM_STARTUP, SM_OPERATIONAL,
+};
+enum { EV_INIT_DONE, EV_COMMS_OK, EV_COMMS_FAILED, EV_ESTOP_ENGAGED, EV_ESTOP_RELEASED, EV_ARMED, EV_DISARMED };
+
+static sm_event_t runInitialized(void *) { return EV_INIT_DONE; }
+
+static const sm_state_desc_t rover_states[] = {
+    { ST_JUST_POWERED_ON,  SM_NO_STATE,     "JUST_POWERED_ON", enter0,  exit0,  nullptr },
+    { ST_INITIALIZED,      SM_STARTUP,      "INITIALIZED",     enter1,  exit1,  runInitialized },
+    { ST_COMMS_CONFIG,     SM_STARTUP,      "COMMS_CONFIG",    enter2,  exit2,  nullptr },
+    { ST_WAITING_FOR_ARM,  SM_OPERATIONAL,  "WAITING_FOR_ARM", enter3,  exit3,  nullptr },
+    { ST_ARMED,            SM_OPERATIONAL,  "ARMED",           enter4,  exit4,  nullptr },
+    { ST_ERROR,            SM_NO_STATE,     "ERROR",           enter5,  exit5,  nullptr },
+    { ST_EMERGENCY_STOP,   SM_OPERATIONAL,  "EMERGENCY_STOP",  enter6,  exit6,  nullptr },
+    { ST_OTA_FW_UPDATE,    SM_NO_STATE,     "OTA_FW_UPDATE",   enter7,  exit7,  nullptr },
+    { ST_REBOOT,           SM_NO_STATE,     "REBOOT",          enter8,  exit8,  nullptr },
+    { SM_STARTUP,          SM_NO_STATE,     "STARTUP",         enter9,  exit9,  nullptr },
+    { SM_OPERATIONAL,      SM_NO_STATE,     "OPERATIONAL",     enter10, exit10, nullptr },
+};
+
+static const sm_transition_t rover_transitions[] = {
+    { ST_INITIALIZED,      EV_INIT_DONE,       nullptr, ST_COMMS_CONFIG,     nullptr },
+    { ST_COMMS_CONFIG,     EV_COMMS_OK,        nullptr, ST_WAITING_FOR_ARM,  nullptr },
+    { ST_COMMS_CONFIG,     EV_COMMS_FAILED,    nullptr, ST_ERROR,            nullptr },
+
+    { ST_EMERGENCY_STOP,   EV_ESTOP_ENGAGED,   nullptr, SM_NO_STATE,         transitionAction },  // nullptr in main.cpp
+    { ST_EMERGENCY_STOP,   EV_ESTOP_RELEASED,  isArmed, ST_ARMED,            nullptr },
+    { ST_EMERGENCY_STOP,   EV_ESTOP_RELEASED,  nullptr, ST_WAITING_FOR_ARM,  nullptr },
+    { ST_EMERGENCY_STOP,   EV_ARMED,           nullptr, SM_NO_STATE,         nullptr },
+    { ST_EMERGENCY_STOP,   EV_DISARMED,        nullptr, SM_NO_STATE,         nullptr },
+    { SM_OPERATIONAL,      EV_ESTOP_ENGAGED,   nullptr, ST_EMERGENCY_STOP,   nullptr },
+
+    { ST_WAITING_FOR_ARM,  EV_ARMED,           nullptr, ST_ARMED,            nullptr },
+    { ST_ARMED,            EV_DISARMED,        nullptr, ST_WAITING_FOR_ARM,  nullptr },
+};
+
+#define COUNT(a) (uint8_t)(sizeof(a) / sizeof(a[0]))
+
+static StateMachine makeRover() {
+    return StateMachine(rover_states, COUNT(rover_states), rover_transitions, COUNT(rover_transitions),
+                        nullptr, fakeClock);
+}
+
+// Start in a leaf and clear the recorder
+static void startIn(StateMachine &sm, sm_state_t state) {
+    sm.start(state);
+    calls[0] = '\0';
+}
+
+void setUp() {
+    calls[0] = '\0';
+    fake_us = 0;
+    armed = false;
+}
+void tearDown() {}
+
+void test_rover_table_is_valid() {
+    StateMachine sm = makeRover();
+    TEST_ASSERT_TRUE(sm.valid());
+}
+
+void test_start_enters_outermost_first() {
+    StateMachine sm = makeRover();
+    sm.start(ST_INITIALIZED);
+    TEST_ASSERT_EQUAL_STRING("e9 e1 ", calls);
+    TEST_ASSERT_TRUE(sm.isIn(SM_STARTUP));
+    TEST_ASSERT_EQUAL_UINT8(SM_NO_EVENT, sm.traceAt(0).event);
+}
+
+void test_run_action_event_is_dispatched() {
+    StateMachine sm = makeRover();
+    startIn(sm, ST_INITIALIZED);
+    sm.run();
+    TEST_ASSERT_EQUAL_UINT8(ST_COMMS_CONFIG, sm.state());
+    // Sibling under the same superstate: STARTUP is neither exited nor entered
+    TEST_ASSERT_EQUAL_STRING("x1 e2 ", calls);
+}
+
+// ESTOP_ENGAGED has no row for ARMED or WAITING_FOR_ARM; OPERATIONAL handles it
+void test_event_bubbles_to_superstate() {
+    StateMachine sm = makeRover();
+    startIn(sm, ST_ARMED);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_ESTOP_ENGAGED));
+    TEST_ASSERT_EQUAL_UINT8(ST_EMERGENCY_STOP, sm.state());
+    TEST_ASSERT_EQUAL_STRING("x4 e6 ", calls);
+
+    startIn(sm, ST_WAITING_FOR_ARM);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_ESTOP_ENGAGED));
+    TEST_ASSERT_EQUAL_UINT8(ST_EMERGENCY_STOP, sm.state());
+
+    // Nobody up the chain handles it
+    startIn(sm, ST_COMMS_CONFIG);
+    TEST_ASSERT_FALSE(sm.dispatch(EV_ARMED));
+    TEST_ASSERT_EQUAL_UINT8(ST_COMMS_CONFIG, sm.state());
+    TEST_ASSERT_EQUAL_STRING("", calls);
+}
+
+// The guarded row must come before the fallback or ARM would be lost on release
+void test_estop_release_guard_order() {
+    StateMachine sm = makeRover();
+    armed = true;
+    startIn(sm, ST_EMERGENCY_STOP);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_ESTOP_RELEASED));
+    TEST_ASSERT_EQUAL_UINT8(ST_ARMED, sm.state());
+
+    armed = false;
+    startIn(sm, ST_EMERGENCY_STOP);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_ESTOP_RELEASED));
+    TEST_ASSERT_EQUAL_UINT8(ST_WAITING_FOR_ARM, sm.state());
+
+    int guarded = -1, fallback = -1;
+    for (int i = 0; i < COUNT(rover_transitions); i++) {
+        const sm_transition_t &t = rover_transitions[i];
+        if (t.from != ST_EMERGENCY_STOP || t.event != EV_ESTOP_RELEASED) continue;
+        if (t.guard != nullptr && guarded < 0) guarded = i;
+        if (t.guard == nullptr && fallback < 0) fallback = i;
+    }
+    TEST_ASSERT_TRUE(guarded >= 0 && fallback >= 0);
+    TEST_ASSERT_LESS_THAN(fallback, guarded);
+}
+
+// Internal rows consume the event: no exit/entry, no trace entry, and the
+// superstate's ESTOP_ENGAGED row (which would re-enter EMERGENCY_STOP) is not reached
+void test_internal_transition_consumes_event() {
+    StateMachine sm = makeRover();
+    startIn(sm, ST_EMERGENCY_STOP);
+    uint32_t taken = sm.transitionCount();
+    uint8_t traced = sm.traceCount();
+
+    TEST_ASSERT_TRUE(sm.dispatch(EV_ESTOP_ENGAGED));
+    TEST_ASSERT_EQUAL_STRING("a0 ", calls);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_ARMED));
+    TEST_ASSERT_TRUE(sm.dispatch(EV_DISARMED));
+    TEST_ASSERT_EQUAL_STRING("a0 ", calls);
+
+    TEST_ASSERT_EQUAL_UINT8(ST_EMERGENCY_STOP, sm.state());
+    TEST_ASSERT_EQUAL_UINT32(taken, sm.transitionCount());
+    TEST_ASSERT_EQUAL_UINT8(traced, sm.traceCount());
+}
+
+// ---- Nested table: OUTER > MIDDLE > INNER, plus a top-level OTHER ----
+enum { N_OUTER, N_MIDDLE, N_INNER, N_OTHER };
+enum { EV_TO_OUTER, EV_TO_MIDDLE, EV_TO_OTHER, EV_SELF };
+
+static const sm_state_desc_t nested_states[] = {
+    { N_OUTER,  SM_NO_STATE, "OUTER",  enter0, exit0, nullptr },
+    { N_MIDDLE, N_OUTER,     "MIDDLE", enter1, exit1, nullptr },
+    { N_INNER,  N_MIDDLE,    "INNER",  enter2, exit2, nullptr },
+    { N_OTHER,  SM_NO_STATE, "OTHER",  enter3, exit3, nullptr },
+};
+
+static const sm_transition_t nested_transitions[] = {
+    { N_INNER,  EV_TO_OUTER,  nullptr, N_OUTER,  transitionAction },
+    { N_INNER,  EV_TO_MIDDLE, nullptr, N_MIDDLE, transitionAction },
+    { N_INNER,  EV_SELF,      nullptr, N_INNER,  transitionAction },
+    { N_OUTER,  EV_TO_OTHER,  nullptr, N_OTHER,  transitionAction },
+};
+
+static StateMachine makeNested() {
+    return StateMachine(nested_states, COUNT(nested_states), nested_transitions, COUNT(nested_transitions),
+                        nullptr, fakeClock);
+}
+
+// A transition to an ancestor leaves it and re-enters it, like a self-transition:
+// exits run innermost first, then the action, then the entry
+void test_transition_to_ancestor_order() {
+    StateMachine sm = makeNested();
+    startIn(sm, N_INNER);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_TO_OUTER));
+    TEST_ASSERT_EQUAL_STRING("x2 x1 x0 a0 e0 ", calls);
+    TEST_ASSERT_EQUAL_UINT8(N_OUTER, sm.state());
+
+    startIn(sm, N_INNER);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_TO_MIDDLE));
+    TEST_ASSERT_EQUAL_STRING("x2 x1 a0 e1 ", calls);
+    TEST_ASSERT_TRUE(sm.isIn(N_OUTER));
+}
+
+void test_self_and_cross_tree_transitions() {
+    StateMachine sm = makeNested();
+    startIn(sm, N_INNER);
+    TEST_ASSERT_TRUE(sm.dispatch(EV_SELF));
+    TEST_ASSERT_EQUAL_STRING("x2 a0 e2 ", calls);
+
+    // Handled by OUTER from INNER: the whole branch is left
+    calls[0] = '\0';
+    TEST_ASSERT_TRUE(sm.dispatch(EV_TO_OTHER));
+    TEST_ASSERT_EQUAL_STRING("x2 x1 x0 a0 e3 ", calls);
+    TEST_ASSERT_FALSE(sm.isIn(N_OUTER));
+}
+
+void test_trace_ring_wraps_keeping_newest() {
+    StateMachine sm = makeRover();
+    sm.start(ST_WAITING_FOR_ARM);
+    const int transitions = SN_SM_TRACE_DEPTH + 5;
+    for (int i = 0; i < transitions; i++) {
+        sm.dispatch((i % 2 == 0) ? EV_ARMED : EV_DISARMED);
+    }
+    TEST_ASSERT_EQUAL_UINT32(transitions + 1, sm.transitionCount());
+    TEST_ASSERT_EQUAL_UINT8(SN_SM_TRACE_DEPTH, sm.traceCount());
+
+    // Oldest first and in time order; the newest is the last DISARMED/ARMED
+    for (uint8_t i = 1; i < sm.traceCount(); i++) {
+        TEST_ASSERT_TRUE(sm.traceAt(i).time_us > sm.traceAt(i - 1).time_us);
+        TEST_ASSERT_EQUAL_UINT8(sm.traceAt(i - 1).to, sm.traceAt(i).from);
+    }
+    const sm_trace_entry_t &newest = sm.traceAt(sm.traceCount() - 1);
+    TEST_ASSERT_EQUAL_UINT8(sm.state(), newest.to);
+    TEST_ASSERT_EQUAL_UINT8((transitions - 1) % 2 == 0 ? EV_ARMED : EV_DISARMED, newest.event);
+    // The start() entry has been overwritten
+    for (uint8_t i = 0; i < sm.traceCount(); i++) TEST_ASSERT_TRUE(sm.traceAt(i).event != SM_NO_EVENT);
+
+    sm.clearTrace();
+    TEST_ASSERT_EQUAL_UINT8(0, sm.traceCount());
+    TEST_ASSERT_EQUAL_UINT8(ST_ARMED, sm.state());
+    sm.dispatch(EV_DISARMED);
+    sm.dispatch(EV_ARMED);
+    TEST_ASSERT_EQUAL_UINT8(2, sm.traceCount());
+    TEST_ASSERT_EQUAL_UINT8(ST_WAITING_FOR_ARM, sm.traceAt(0).to);
+    TEST_ASSERT_EQUAL_UINT8(ST_ARMED, sm.traceAt(1).to);
+}
+
+void test_valid_rejects_bad_tables() {
+    // Parent loop: 1 -> 2 -> 1
+    static const sm_state_desc_t loop[] = {
+        { 0, SM_NO_STATE, "A", nullptr, nullptr, nullptr },
+        { 1, 2,           "B", nullptr, nullptr, nullptr },
+        { 2, 1,           "C", nullptr, nullptr, nullptr },
+    };
+    // Table not indexed by id
+    static const sm_state_desc_t bad_id[] = {
+        { 0, SM_NO_STATE, "A", nullptr, nullptr, nullptr },
+        { 2, SM_NO_STATE, "B", nullptr, nullptr, nullptr },
+    };
+    // Parent outside the table
+    static const sm_state_desc_t bad_parent[] = {
+        { 0, SM_NO_STATE, "A", nullptr, nullptr, nullptr },
+        { 1, 7,           "B", nullptr, nullptr, nullptr },
+    };
+    // One level deeper than SM_MAX_DEPTH
+    sm_state_desc_t deep[SM_MAX_DEPTH + 1];
+    for (uint8_t i = 0; i < SM_MAX_DEPTH + 1; i++) {
+        deep[i] = { i, i == 0 ? (sm_state_t)SM_NO_STATE : (sm_state_t)(i - 1), "D", nullptr, nullptr, nullptr };
+    }
+
+    TEST_ASSERT_FALSE(StateMachine(loop, COUNT(loop), nullptr, 0, nullptr, fakeClock).valid());
+    TEST_ASSERT_FALSE(StateMachine(bad_id, COUNT(bad_id), nullptr, 0, nullptr, fakeClock).valid());
+    TEST_ASSERT_FALSE(StateMachine(bad_parent, COUNT(bad_parent), nullptr, 0, nullptr, fakeClock).valid());
+    TEST_ASSERT_FALSE(StateMachine(deep, SM_MAX_DEPTH + 1, nullptr, 0, nullptr, fakeClock).valid());
+    TEST_ASSERT_TRUE(StateMachine(deep, SM_MAX_DEPTH, nullptr, 0, nullptr, fakeClock).valid());
+
+    // An invalid machine ignores start() and dispatch()
+    StateMachine sm(loop, COUNT(loop), nested_transitions, COUNT(nested_transitions), nullptr, fakeClock);
+    sm.start(0);
+    TEST_ASSERT_EQUAL_UINT8(SM_NO_STATE, sm.state());
+    TEST_ASSERT_FALSE(sm.dispatch(EV_TO_OTHER));
+    TEST_ASSERT_EQUAL_UINT8(0, sm.traceCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rover_table_is_valid);
+    RUN_TEST(test_start_enters_outermost_first);
+    RUN_TEST(test_run_action_event_is_dispatched);
+    RUN_TEST(test_event_bubbles_to_superstate);
+    RUN_TEST(test_estop_release_guard_order);
+    RUN_TEST(test_internal_transition_consumes_event);
+    RUN_TEST(test_transition_to_ancestor_order);
+    RUN_TEST(test_self_and_cross_tree_transitions);
+    RUN_TEST(test_trace_ring_wraps_keeping_newest);
+    RUN_TEST(test_valid_rejects_bad_tables);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+// Closed-loop tests for the per-side velocity controller (lib/SN_DriveControl/SN_VelocityControl.*):
+// pio test -e native -f test_velocity_control
+//
+// The PI loop runs at the control task rate against DiffDrivePlant, with
+// feedback from the encoder counts the plant produces, the same way the
+// OBC runs it in SN_VELOCITY_CONTROL_MODE 1.
+
+#include <unity.h>
+#include <math.h>
+#include <SN_VelocityControl.h>
+
+static const float LOOP_HZ = 250.0f;
+static const float DT_S = 1.0f / LOOP_HZ;
+
+static const diff_drive_plant_config_t PLANT = {
+    0.15f,      // tau_s
+    12.6f,      // nominal_bus_v
+    5.0f,       // drag_pct
+    0.15f,      // current_per_pct_a
+    0.3f,       // idle_current_a
+    3000.0f,    // counts_per_s_full
+    360.0f,     // full_yaw_dps
+};
+
+static const velocity_pid_config_t PID = {
+    SN_VELOCITY_KP, SN_VELOCITY_KI, SN_VELOCITY_KFF, SN_VELOCITY_I_LIMIT, 100.0f
+};
+
+struct StepResponse {
+    float final_speed;      // Mean over the last second
+    float overshoot_pct;    // Past the setpoint, percent of the step
+    float settling_s;       // Last time outside the +-2 % band
+};
+
+// Drives straight ahead (left = -setpoint, right = +setpoint) from rest and records the right side
+static StepResponse runStep(float setpoint, float bus_v, float drag_pct, float duration_s) {
+    DiffDrivePlant plant(PLANT);
+    plant.setBusVoltage(bus_v);
+    plant.setDrag(drag_pct);
+    VelocityController left(PID), right(PID);
+    EncoderSpeedFeedback feedback(PLANT.counts_per_s_full);
+
+    StepResponse r = {0.0f, 0.0f, 0.0f};
+    float band = 0.02f * fabsf(setpoint);
+    float peak = 0.0f, tail_sum = 0.0f;
+    int tail_n = 0;
+    int steps = (int)(duration_s * LOOP_HZ);
+    for (int i = 0; i < steps; i++) {
+        wheel_speed_t measured = feedback.update(plant.leftCount(), plant.rightCount(), DT_S);
+        if (!measured.valid) measured = {0.0f, 0.0f, true};
+        float left_duty = left.update(-setpoint, measured.left, DT_S);
+        float right_duty = right.update(setpoint, measured.right, DT_S);
+        plant.step(left_duty, right_duty, DT_S);
+
+        float speed = plant.rightSpeed();
+        if (speed > peak) peak = speed;
+        if (fabsf(speed - setpoint) > band) r.settling_s = (i + 1) * DT_S;
+        if (i >= steps - (int)LOOP_HZ) {
+            tail_sum += speed;
+            tail_n++;
+        }
+    }
+    r.final_speed = tail_sum / tail_n;
+    r.overshoot_pct = peak > setpoint ? (peak - setpoint) / setpoint * 100.0f : 0.0f;
+    return r;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_step_settles_at_nominal_voltage() {
+    StepResponse r = runStep(50.0f, 12.6f, 5.0f, 3.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 50.0f, r.final_speed);
+    TEST_ASSERT_LESS_THAN_FLOAT(15.0f, r.overshoot_pct);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5f, r.settling_s);
+}
+
+// A sagging pack and heavier drag are absorbed by the integral
+void test_step_settles_on_sagging_battery() {
+    StepResponse r = runStep(50.0f, 10.8f, 10.0f, 4.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 50.0f, r.final_speed);
+    TEST_ASSERT_LESS_THAN_FLOAT(10.0f, r.overshoot_pct);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5f, r.settling_s);
+}
+
+// Setpoint beyond what the pack can deliver: output pinned, integral must not wind up
+void test_saturated_step_recovers_without_windup() {
+    DiffDrivePlant plant(PLANT);
+    plant.setBusVoltage(10.8f);
+    VelocityController right(PID);
+    EncoderSpeedFeedback feedback(PLANT.counts_per_s_full);
+
+    for (int i = 0; i < (int)(2.0f * LOOP_HZ); i++) {
+        wheel_speed_t m = feedback.update(0, plant.rightCount(), DT_S);
+        plant.step(0.0f, right.update(100.0f, m.valid ? m.right : 0.0f, DT_S), DT_S);
+    }
+    TEST_ASSERT_TRUE(right.saturated());
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT(PID.integrator_limit, right.integral());
+
+    // Back down to 40 %: no long overshoot below the new setpoint from a wound-up integral
+    float settled_at = 0.0f;
+    for (int i = 0; i < (int)(3.0f * LOOP_HZ); i++) {
+        wheel_speed_t m = feedback.update(0, plant.rightCount(), DT_S);
+        plant.step(0.0f, right.update(40.0f, m.right, DT_S), DT_S);
+        if (fabsf(plant.rightSpeed() - 40.0f) > 0.8f) settled_at = (i + 1) * DT_S;
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5f, settled_at);
+}
+
+void test_commanded_stop_releases_the_motors() {
+    VelocityController c(PID);
+    for (int i = 0; i < 100; i++) c.update(50.0f, 40.0f, DT_S);
+    TEST_ASSERT_TRUE(c.integral() > 0.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, c.update(0.0f, 0.5f, DT_S));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, c.integral());
+}
+
+// Mode 2: estimator fed once per sensor period with the mean applied duty
+void test_estimator_tracks_plant_at_sensor_rate() {
+    const float sensor_period_s = 0.2f;
+    const int ticks_per_sample = (int)(sensor_period_s * LOOP_HZ);
+
+    DiffDrivePlant plant(PLANT);
+    plant.setBusVoltage(11.5f);
+    CurrentYawSpeedEstimator estimator({PLANT.nominal_bus_v, PLANT.current_per_pct_a,
+                                        PLANT.idle_current_a, PLANT.full_yaw_dps});
+    wheel_speed_t estimate = {0.0f, 0.0f, false};
+    float left_sum = 0.0f, right_sum = 0.0f;
+    for (int i = 1; i <= (int)(4.0f * LOOP_HZ); i++) {
+        plant.step(-60.0f, 60.0f, DT_S);
+        left_sum += -60.0f;
+        right_sum += 60.0f;
+        if (i % ticks_per_sample == 0) {
+            estimate = estimator.update(left_sum / ticks_per_sample, right_sum / ticks_per_sample,
+                                        11.5f, plant.busCurrent(), plant.yawRate());
+            left_sum = right_sum = 0.0f;
+        }
+    }
+    TEST_ASSERT_TRUE(estimate.valid);
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, plant.rightSpeed(), estimate.right);
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, plant.leftSpeed(), estimate.left);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_step_settles_at_nominal_voltage);
+    RUN_TEST(test_step_settles_on_sagging_battery);
+    RUN_TEST(test_saturated_step_recovers_without_windup);
+    RUN_TEST(test_commanded_stop_releases_the_motors);
+    RUN_TEST(test_estimator_tracks_plant_at_sensor_rate);
+    return UNITY_END();
+}
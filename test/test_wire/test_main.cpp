@@ -0,0 +1,358 @@
+// Host tests for the ESP-NOW wire codec (lib/SN_ESPNOW/SN_ESPNOW_Wire.*):
+// pio test -e native -f test_wire
+
+#include <unity.h>
+#include <string.h>
+
+// SN_ESPNOW is not built on the host (SN_ESPNOW.cpp needs the ESP32 SDK), so
+// compile the codec into the test directly
+#include <SN_ESPNOW_Wire.cpp>
+
+static const sn_wire_meta_t META = {0xBEEF, 0x12345678};
+
+static void assertMeta(const sn_wire_meta_t &meta) {
+    TEST_ASSERT_EQUAL_UINT16(META.seq, meta.seq);
+    TEST_ASSERT_EQUAL_UINT32(META.tx_time_us, meta.tx_time_us);
+}
+
+static void assertHeader(const uint8_t *buf, sn_wire_frame_type_t type) {
+    TEST_ASSERT_EQUAL_UINT8(SN_WIRE_VERSION, SN_WIRE_HEADER_VERSION(buf[0]));
+    TEST_ASSERT_EQUAL_UINT8(type, SN_WIRE_HEADER_TYPE(buf[0]));
+    TEST_ASSERT_EQUAL_HEX8(0xEF, buf[1]);      // seq, little-endian
+    TEST_ASSERT_EQUAL_HEX8(0xBE, buf[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x78, buf[3]);      // tx_time_us, little-endian
+    TEST_ASSERT_EQUAL_HEX8(0x12, buf[6]);
+}
+
+static telemetry_GPS_data_t sampleGPS() {
+    telemetry_GPS_data_t gps;
+    gps.GPS_lat = 48.1234567;
+    gps.GPS_lon = -122.7654321;
+    gps.GPS_time = 45296.25;
+    gps.GPS_fix = true;
+    return gps;
+}
+
+static telemetry_IMU_data_t sampleIMU() {
+    telemetry_IMU_data_t imu;
+    imu.Heading_Degrees = 271.37f;
+    strcpy(imu.Heading_Cardinal, "NW");
+    imu.Pitch_Degrees = -12.34f;
+    imu.Roll_Degrees = 5.67f;
+    return imu;
+}
+
+static telemetry_HK_data_t sampleHK() {
+    telemetry_HK_data_t hk;
+    hk.Main_Bus_V = 11.873f;
+    hk.Main_Bus_I = -2.5f;
+    hk.Bus_5V = 5.012f;
+    hk.Bus_3V3 = 3.298f;
+    hk.temp = 41.25f;
+    hk.OBC_RSSI = -67;
+    hk.TC_Loss_Permille = 12;
+    hk.CPU_Load_Core0 = 35;
+    hk.CPU_Load_Core1 = 0xFF;
+    hk.Min_Stack_Free = 812;
+    hk.Heap_Free_KB = 180;
+    hk.Heap_Min_Free_KB = 150;
+    hk.Heap_Largest_KB = 110;
+    return hk;
+}
+
+static telecommand_data_t sampleTC() {
+    telecommand_data_t tc;
+    tc.Command = 0x0102;
+    tc.Joystick_X = 4095;
+    tc.Joystick_Y = 17;
+    tc.Encoder_Pos = 300;
+    tc.flags = 0x1A5;       // Includes the joystick settled bit (bit 8)
+    tc.CTU_RSSI = -42;
+    return tc;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_gps_round_trip() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    TEST_ASSERT_EQUAL(20, SN_Wire_EncodeTelemetryGPS(sampleGPS(), META, buf, sizeof(buf)));
+    assertHeader(buf, SN_WIRE_FRAME_TM_GPS);
+
+    telemetry_GPS_data_t out;
+    sn_wire_meta_t meta;
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryGPS(buf, 20, out, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, 48.1234567, out.GPS_lat);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, -122.7654321, out.GPS_lon);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 45296.25, out.GPS_time);
+    TEST_ASSERT_TRUE(out.GPS_fix);
+}
+
+void test_imu_round_trip() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    TEST_ASSERT_EQUAL(15, SN_Wire_EncodeTelemetryIMU(sampleIMU(), META, buf, sizeof(buf)));
+    assertHeader(buf, SN_WIRE_FRAME_TM_IMU);
+
+    telemetry_IMU_data_t out;
+    sn_wire_meta_t meta;
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryIMU(buf, 15, out, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 271.37f, out.Heading_Degrees);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, -12.34f, out.Pitch_Degrees);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 5.67f, out.Roll_Degrees);
+    TEST_ASSERT_EQUAL_STRING("NW", out.Heading_Cardinal);
+}
+
+void test_imu_heading_wraps_into_range() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    telemetry_IMU_data_t imu = sampleIMU();
+    telemetry_IMU_data_t out;
+
+    imu.Heading_Degrees = -90.0f;
+    SN_Wire_EncodeTelemetryIMU(imu, META, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryIMU(buf, 15, out));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 270.0f, out.Heading_Degrees);
+
+    imu.Heading_Degrees = 359.999f;     // Rounds up to 360.00, sent as 0
+    SN_Wire_EncodeTelemetryIMU(imu, META, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryIMU(buf, 15, out));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.0f, out.Heading_Degrees);
+}
+
+void test_hk_round_trip() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    TEST_ASSERT_EQUAL(30, SN_Wire_EncodeTelemetryHK(sampleHK(), META, buf, sizeof(buf)));
+    assertHeader(buf, SN_WIRE_FRAME_TM_HK);
+
+    telemetry_HK_data_t out;
+    sn_wire_meta_t meta;
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryHK(buf, 30, out, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 11.873f, out.Main_Bus_V);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, -2.5f, out.Main_Bus_I);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 5.012f, out.Bus_5V);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 3.298f, out.Bus_3V3);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 41.25f, out.temp);
+    TEST_ASSERT_EQUAL_INT16(-67, out.OBC_RSSI);
+    TEST_ASSERT_EQUAL_UINT16(12, out.TC_Loss_Permille);
+    TEST_ASSERT_EQUAL_UINT8(35, out.CPU_Load_Core0);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, out.CPU_Load_Core1);
+    TEST_ASSERT_EQUAL_UINT16(812, out.Min_Stack_Free);
+    TEST_ASSERT_EQUAL_UINT16(180, out.Heap_Free_KB);
+    TEST_ASSERT_EQUAL_UINT16(150, out.Heap_Min_Free_KB);
+    TEST_ASSERT_EQUAL_UINT16(110, out.Heap_Largest_KB);
+}
+
+void test_telecommand_round_trip() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    TEST_ASSERT_EQUAL(18, SN_Wire_EncodeTelecommand(sampleTC(), META, buf, sizeof(buf)));
+    assertHeader(buf, SN_WIRE_FRAME_TC_C2);
+
+    telecommand_data_t out;
+    sn_wire_meta_t meta;
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelecommand(buf, 18, out, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_EQUAL_UINT16(0x0102, out.Command);
+    TEST_ASSERT_EQUAL_UINT16(4095, out.Joystick_X);
+    TEST_ASSERT_EQUAL_UINT16(17, out.Joystick_Y);
+    TEST_ASSERT_EQUAL_UINT16(300, out.Encoder_Pos);
+    TEST_ASSERT_EQUAL_UINT16(0x1A5, out.flags);
+    TEST_ASSERT_EQUAL_INT16(-42, out.CTU_RSSI);
+}
+
+void test_redundant_telecommand_round_trip() {
+    telecommand_history_t history;
+    history.count = 3;
+    for (uint8_t i = 0; i < history.count; i++) {
+        history.samples[i].Seq = (uint16_t)(META.seq - 3 + i);
+        history.samples[i].Tx_Time_us = META.tx_time_us - (3 - i) * 20000;
+        history.samples[i].Joystick_X = (uint16_t)(1000 + i * 1000);
+        history.samples[i].Joystick_Y = (uint16_t)(4095 - i * 7);
+        history.samples[i].flags = (uint16_t)(0x100 | i);     // Settled bit survives the replay
+    }
+
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    size_t len = SN_Wire_EncodeTelecommandRedundant(sampleTC(), history, META, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(19 + 3 * 9, len);
+    assertHeader(buf, SN_WIRE_FRAME_TC_C2R);
+
+    telecommand_data_t out;
+    telecommand_history_t out_history;
+    sn_wire_meta_t meta;
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelecommandRedundant(buf, len, out, out_history, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_EQUAL_UINT16(4095, out.Joystick_X);
+    TEST_ASSERT_EQUAL_UINT8(3, out_history.count);
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT16(history.samples[i].Seq, out_history.samples[i].Seq);
+        TEST_ASSERT_EQUAL_UINT32(history.samples[i].Tx_Time_us, out_history.samples[i].Tx_Time_us);
+        TEST_ASSERT_EQUAL_UINT16(history.samples[i].Joystick_X, out_history.samples[i].Joystick_X);
+        TEST_ASSERT_EQUAL_UINT16(history.samples[i].Joystick_Y, out_history.samples[i].Joystick_Y);
+        TEST_ASSERT_EQUAL_UINT16(history.samples[i].flags, out_history.samples[i].flags);
+    }
+}
+
+void test_ping_pong_round_trip() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    sn_wire_meta_t meta;
+
+    TEST_ASSERT_EQUAL(7, SN_Wire_EncodePing(META, buf, sizeof(buf)));
+    assertHeader(buf, SN_WIRE_FRAME_TC_PING);
+    TEST_ASSERT_TRUE(SN_Wire_DecodePing(buf, 7, &meta));
+    assertMeta(meta);
+
+    telemetry_pong_data_t pong;
+    pong.Ping_Seq = 77;
+    pong.Ping_Tx_Time_us = 0xCAFEF00D;
+    TEST_ASSERT_EQUAL(13, SN_Wire_EncodePong(pong, META, buf, sizeof(buf)));
+    assertHeader(buf, SN_WIRE_FRAME_TM_PONG);
+
+    telemetry_pong_data_t out;
+    TEST_ASSERT_TRUE(SN_Wire_DecodePong(buf, 13, out, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_EQUAL_UINT16(77, out.Ping_Seq);
+    TEST_ASSERT_EQUAL_UINT32(0xCAFEF00D, out.Ping_Tx_Time_us);
+}
+
+void test_superframe_round_trip_and_sizes() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    telemetry_GPS_data_t gps;
+    telemetry_IMU_data_t imu;
+    telemetry_HK_data_t hk;
+    sn_wire_meta_t meta;
+
+    size_t len = SN_Wire_EncodeTelemetrySuperframe(SN_WIRE_SECTION_ALL, sampleGPS(), sampleIMU(), sampleHK(),
+                                                   META, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(SN_WIRE_SUPERFRAME_MAX_LEN, len);
+    assertHeader(buf, SN_WIRE_FRAME_TM_SUPER);
+    TEST_ASSERT_EQUAL_UINT8(SN_WIRE_SECTION_ALL, SN_Wire_DecodeTelemetrySuperframe(buf, len, gps, imu, hk, &meta));
+    assertMeta(meta);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, 48.1234567, gps.GPS_lat);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 271.37f, imu.Heading_Degrees);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 11.873f, hk.Main_Bus_V);
+
+    // A partial superframe only carries (and only writes) the selected sections
+    len = SN_Wire_EncodeTelemetrySuperframe(SN_WIRE_SECTION_IMU, sampleGPS(), sampleIMU(), sampleHK(),
+                                            META, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(8 + 8, len);
+    gps.GPS_lat = 1.0;
+    TEST_ASSERT_EQUAL_UINT8(SN_WIRE_SECTION_IMU, SN_Wire_DecodeTelemetrySuperframe(buf, len, gps, imu, hk));
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 1.0, gps.GPS_lat);
+
+    TEST_ASSERT_EQUAL(0, SN_Wire_EncodeTelemetrySuperframe(0, sampleGPS(), sampleIMU(), sampleHK(),
+                                                          META, buf, sizeof(buf)));
+}
+
+void test_fixed_point_saturates() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+
+    telemetry_GPS_data_t gps = sampleGPS();
+    gps.GPS_lat = 1000.0;
+    gps.GPS_lon = -1000.0;
+    gps.GPS_time = -5.0;
+    telemetry_GPS_data_t gps_out;
+    SN_Wire_EncodeTelemetryGPS(gps, META, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryGPS(buf, 20, gps_out));
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 90.0, gps_out.GPS_lat);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, -180.0, gps_out.GPS_lon);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 0.0, gps_out.GPS_time);
+
+    telemetry_IMU_data_t imu = sampleIMU();
+    imu.Pitch_Degrees = 1000.0f;
+    imu.Roll_Degrees = -1000.0f;
+    telemetry_IMU_data_t imu_out;
+    SN_Wire_EncodeTelemetryIMU(imu, META, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryIMU(buf, 15, imu_out));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 327.67f, imu_out.Pitch_Degrees);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -327.68f, imu_out.Roll_Degrees);
+
+    telemetry_HK_data_t hk = sampleHK();
+    hk.Main_Bus_V = -1.0f;
+    hk.Main_Bus_I = 100.0f;
+    hk.Bus_5V = 1e9f;
+    hk.temp = NAN;
+    hk.OBC_RSSI = -200;
+    hk.TC_Loss_Permille = 5000;
+    telemetry_HK_data_t hk_out;
+    SN_Wire_EncodeTelemetryHK(hk, META, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelemetryHK(buf, 30, hk_out));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, hk_out.Main_Bus_V);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 32.767f, hk_out.Main_Bus_I);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 65.535f, hk_out.Bus_5V);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, hk_out.temp);
+    TEST_ASSERT_EQUAL_INT16(-128, hk_out.OBC_RSSI);
+    TEST_ASSERT_EQUAL_UINT16(1000, hk_out.TC_Loss_Permille);
+
+    telecommand_data_t tc = sampleTC();
+    tc.CTU_RSSI = 300;
+    telecommand_data_t tc_out;
+    SN_Wire_EncodeTelecommand(tc, META, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(SN_Wire_DecodeTelecommand(buf, 18, tc_out));
+    TEST_ASSERT_EQUAL_INT16(127, tc_out.CTU_RSSI);
+}
+
+void test_rejects_wrong_length() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    telecommand_data_t tc;
+    telecommand_history_t history;
+    telemetry_HK_data_t hk;
+    telemetry_GPS_data_t gps;
+    telemetry_IMU_data_t imu;
+
+    TEST_ASSERT_EQUAL(0, SN_Wire_EncodeTelecommand(sampleTC(), META, buf, 17));
+    SN_Wire_EncodeTelecommand(sampleTC(), META, buf, sizeof(buf));
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelecommand(buf, 17, tc));
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelecommand(buf, 19, tc));
+
+    SN_Wire_EncodeTelemetryHK(sampleHK(), META, buf, sizeof(buf));
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelemetryHK(buf, 29, hk));
+
+    history.count = 2;
+    memset(history.samples, 0, sizeof(history.samples));
+    size_t len = SN_Wire_EncodeTelecommandRedundant(sampleTC(), history, META, buf, sizeof(buf));
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelecommandRedundant(buf, len - 1, tc, history));
+    buf[sizeof(sn_wire_tc_c2r_prefix_t) - 1] = 3;   // history_count disagrees with the length
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelecommandRedundant(buf, len, tc, history));
+
+    len = SN_Wire_EncodeTelemetrySuperframe(SN_WIRE_SECTION_GPS | SN_WIRE_SECTION_HK, sampleGPS(), sampleIMU(),
+                                            sampleHK(), META, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(0, SN_Wire_DecodeTelemetrySuperframe(buf, len + 1, gps, imu, hk));
+    buf[sizeof(sn_wire_header_t)] = 0x08;           // Unknown section bit
+    TEST_ASSERT_EQUAL(0, SN_Wire_DecodeTelemetrySuperframe(buf, len, gps, imu, hk));
+
+    TEST_ASSERT_EQUAL(SN_WIRE_FRAME_INVALID, SN_Wire_GetFrameType(buf, sizeof(sn_wire_header_t) - 1));
+    TEST_ASSERT_EQUAL(SN_WIRE_FRAME_INVALID, SN_Wire_GetFrameType(nullptr, 18));
+}
+
+void test_rejects_wrong_version_and_type() {
+    uint8_t buf[SN_WIRE_MAX_FRAME_LEN];
+    telecommand_data_t out;
+    out.Joystick_X = 1234;
+
+    SN_Wire_EncodeTelecommand(sampleTC(), META, buf, sizeof(buf));
+    buf[0] = (uint8_t)(((SN_WIRE_VERSION - 1) << 4) | SN_WIRE_FRAME_TC_C2);
+    TEST_ASSERT_EQUAL(SN_WIRE_FRAME_INVALID, SN_Wire_GetFrameType(buf, 18));
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelecommand(buf, 18, out));
+    TEST_ASSERT_EQUAL_UINT16(1234, out.Joystick_X);     // Left untouched
+
+    // Right length, wrong frame type
+    buf[0] = SN_WIRE_HEADER(SN_WIRE_FRAME_TM_IMU);
+    TEST_ASSERT_FALSE(SN_Wire_DecodeTelecommand(buf, 18, out));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_gps_round_trip);
+    RUN_TEST(test_imu_round_trip);
+    RUN_TEST(test_imu_heading_wraps_into_range);
+    RUN_TEST(test_hk_round_trip);
+    RUN_TEST(test_telecommand_round_trip);
+    RUN_TEST(test_redundant_telecommand_round_trip);
+    RUN_TEST(test_ping_pong_round_trip);
+    RUN_TEST(test_superframe_round_trip_and_sizes);
+    RUN_TEST(test_fixed_point_saturates);
+    RUN_TEST(test_rejects_wrong_length);
+    RUN_TEST(test_rejects_wrong_version_and_type);
+    return UNITY_END();
+}
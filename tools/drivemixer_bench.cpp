@@ -0,0 +1,95 @@
+// Host benchmark for the joystick-to-motor drive mix (table mixer vs the old per-call mapping).
+//
+//   cd lib/SN_DriveControl
+//   g++ -O2 -std=gnu++17 -I. ../../tools/drivemixer_bench.cpp SN_DriveMixer.cpp -o /tmp/drivemixer_bench
+//   /tmp/drivemixer_bench
+//
+// Both variants run over the same stream of raw 12-bit joystick readings.
+// "map + clamp" is the mapping the OBC used before the mixer: a full-scale
+// linear map per axis and a hard clamp of each motor to +-100 %, which bends
+// the turn ratio at the corners. "table" is SN_DriveMixer_Mix. The mismatch
+// columns count the inputs where the two disagree and the largest difference
+// in percent. The table path pays for the ratio-preserving divides on
+// saturated inputs. Timing is host time per call: it ranks the variants, the
+// ESP32 figures will differ.
+
+#include "SN_DriveMixer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const size_t SAMPLES = 1 << 16;
+static const int TIMING_PASSES = 200;
+
+// Pre-mixer mapping, kept verbatim for comparison
+static drive_mix_t mapAndClamp(uint16_t joystick_x, uint16_t joystick_y)
+{
+	int16_t raw_x = (int16_t)joystick_x - 2117;
+	int16_t raw_y = (int16_t)joystick_y - 2000;
+	int16_t steering = (abs(raw_x) < 50) ? 0 : (int16_t)(((int32_t)joystick_x * 200) / 4095) - 100;
+	int16_t throttle = (abs(raw_y) < 50) ? 0 : (int16_t)(((int32_t)joystick_y * 200) / 4095) - 100;
+
+	int16_t left = -steering - throttle;
+	int16_t right = -steering + throttle;
+	if (left > 100) left = 100;
+	if (left < -100) left = -100;
+	if (right > 100) right = 100;
+	if (right < -100) right = -100;
+	return { left, right };
+}
+
+static drive_mix_t tableMix(uint16_t joystick_x, uint16_t joystick_y)
+{
+	return SN_DriveMixer_Mix(joystick_x, joystick_y);
+}
+
+typedef drive_mix_t (*MixFn)(uint16_t, uint16_t);
+
+int main()
+{
+	// Mostly small deflections around centre with occasional full-stick swings
+	std::mt19937 rng(42);
+	std::normal_distribution<double> near(0.0, 400.0);
+	std::uniform_int_distribution<int> full(0, 4095);
+	std::vector<uint16_t> xs(SAMPLES), ys(SAMPLES);
+	for (size_t i = 0; i < SAMPLES; i++) {
+		bool swing = (i % 8) == 0;
+		int x = swing ? full(rng) : 2117 + (int)near(rng);
+		int y = swing ? full(rng) : 2000 + (int)near(rng);
+		xs[i] = (uint16_t)(x < 0 ? 0 : x > 4095 ? 4095 : x);
+		ys[i] = (uint16_t)(y < 0 ? 0 : y > 4095 ? 4095 : y);
+	}
+
+	size_t mismatches = 0;
+	int max_diff = 0;
+	for (size_t i = 0; i < SAMPLES; i++) {
+		drive_mix_t a = mapAndClamp(xs[i], ys[i]);
+		drive_mix_t b = tableMix(xs[i], ys[i]);
+		int diff = abs(a.left - b.left) > abs(a.right - b.right) ? abs(a.left - b.left) : abs(a.right - b.right);
+		if (diff) mismatches++;
+		if (diff > max_diff) max_diff = diff;
+	}
+	printf("%zu samples, table vs map + clamp: %zu differ, max %d %%\n\n", SAMPLES, mismatches, max_diff);
+
+	const MixFn variants[] = { mapAndClamp, tableMix };
+	const char *const names[] = { "map + clamp (pre-mixer)", "table (SN_DriveMixer_Mix)" };
+
+	printf("%-28s %10s\n", "variant", "ns/call");
+	for (int v = 0; v < 2; v++) {
+		volatile int32_t sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < TIMING_PASSES; pass++) {
+			for (size_t i = 0; i < SAMPLES; i++) {
+				drive_mix_t m = variants[v](xs[i], ys[i]);
+				sink = sink + m.left - m.right;
+			}
+		}
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+		            ((double)TIMING_PASSES * SAMPLES);
+		printf("%-28s %10.2f\n", names[v], ns);
+	}
+	return 0;
+}
@@ -0,0 +1,206 @@
+// Host benchmark for the MPUFilter variants (accuracy and throughput).
+//
+//   cd lib/SN_Sensors/MPUFilter
+//   g++ -O2 -std=gnu++17 -I. ../../../tools/mpufilter_bench.cpp MPUFilter.cpp MPUFilterQ.cpp -o /tmp/mpufilter_bench
+//   /tmp/mpufilter_bench
+//
+// A synthetic 200 Hz MPU6050 stream (+-2 g / +-250 deg/s counts, with noise)
+// is generated from a known rover-like motion. Every variant runs over the
+// same counts. The error is the rotation angle between its quaternion and
+// the true orientation, and "vs ref" is the angle to the current float
+// path (per-sample updateIMU, fast inverse square root). Timing is host
+// time per sample: it ranks the variants, the ESP32 figures will differ.
+
+#include "MPUFilter.h"
+#include "MPUFilterQ.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static const float SAMPLE_RATE_HZ = 200.0f;
+static const float DURATION_S = 120.0f;
+static const float ACCEL_LSB_PER_G = 16384.0f;
+static const float GYRO_LSB_PER_DPS = 131.0f;
+static const int TIMING_PASSES = 20;
+
+struct Quat { double w, x, y, z; };
+
+static Quat quatMultiply(const Quat &a, const Quat &b)
+{
+	return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+	         a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+	         a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+	         a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+static Quat quatNormalise(Quat q)
+{
+	double n = std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+	return { q.w / n, q.x / n, q.y / n, q.z / n };
+}
+
+// Rotation angle between two orientations, degrees (inputs need not be exactly unit length)
+static double quatAngleDeg(Quat a, Quat b)
+{
+	a = quatNormalise(a);
+	b = quatNormalise(b);
+	Quat d = quatMultiply({ a.w, -a.x, -a.y, -a.z }, b);
+	double vector = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+	return 2.0 * std::atan2(vector, std::fabs(d.w)) * 57.29577951;
+}
+
+struct Stream {
+	std::vector<int16_t> gyro;		// counts, 3 per sample
+	std::vector<int16_t> accel;
+	std::vector<float> gyro_dps;		// the same counts converted for the float filter
+	std::vector<float> accel_g;
+	std::vector<Quat> truth;		// orientation after each sample
+	size_t count;
+};
+
+static int16_t toCounts(double value, double lsb, double noise, std::mt19937 &rng)
+{
+	std::normal_distribution<double> n(0.0, noise);
+	double counts = std::round(value * lsb + n(rng));
+	return (int16_t)std::fmax(-32768.0, std::fmin(32767.0, counts));
+}
+
+// Body rates: slow yaw turns plus pitch/roll rocking as on rough ground
+static Stream makeStream()
+{
+	Stream s;
+	s.count = (size_t)(SAMPLE_RATE_HZ * DURATION_S);
+	std::mt19937 rng(42);
+
+	const int substeps = 20;
+	const double dt = 1.0 / SAMPLE_RATE_HZ;
+	Quat q = { 1, 0, 0, 0 };
+
+	for (size_t i = 0; i < s.count; i++) {
+		double rate[3] = { 0, 0, 0 };
+		for (int j = 0; j < substeps; j++) {
+			double t = (i + (j + 0.5) / substeps) * dt;
+			double wx = 0.35 * std::sin(2.1 * t) + 0.15 * std::sin(7.3 * t);	// rad/s
+			double wy = 0.25 * std::sin(1.7 * t + 1.0) + 0.10 * std::sin(5.9 * t);
+			double wz = 0.60 * std::sin(0.23 * t);
+			double h = 0.5 * dt / substeps;
+			q = quatNormalise(quatMultiply(q, { 1.0, wx * h, wy * h, wz * h }));
+			rate[0] += wx / substeps;
+			rate[1] += wy / substeps;
+			rate[2] += wz / substeps;
+		}
+
+		// Gravity in the sensor frame (what MPUFilter expects at rest: +z up)
+		double gx = 2.0 * (q.x * q.z - q.w * q.y);
+		double gy = 2.0 * (q.w * q.x + q.y * q.z);
+		double gz = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+
+		for (int axis = 0; axis < 3; axis++) {
+			int16_t g = toCounts(rate[axis] * 57.29577951, GYRO_LSB_PER_DPS, 4.0, rng);
+			s.gyro.push_back(g);
+			s.gyro_dps.push_back(g / GYRO_LSB_PER_DPS);
+		}
+		double grav[3] = { gx, gy, gz };
+		for (int axis = 0; axis < 3; axis++) {
+			int16_t a = toCounts(grav[axis], ACCEL_LSB_PER_G, 60.0, rng);
+			s.accel.push_back(a);
+			s.accel_g.push_back(a / ACCEL_LSB_PER_G);
+		}
+		s.truth.push_back(q);
+	}
+	return s;
+}
+
+enum Variant { PER_SAMPLE_FAST, PER_SAMPLE_SQRTF, BATCH_FAST, BATCH_SQRTF, FIXED_Q30 };
+static const char *const variant_names[] = {
+	"float updateIMU, fast invSqrt (ref)",
+	"float updateIMU, sqrtf",
+	"float batch, fast invSqrt",
+	"float batch, sqrtf",
+	"fixed-point Q30 batch",
+};
+
+static const size_t BATCH = 40;		// one 200 ms sensor cycle at 200 Hz
+
+// Runs one variant over the whole stream, recording the quaternion after every sample when trace is set
+static Quat runVariant(Variant variant, const Stream &s, std::vector<Quat> *trace)
+{
+	MPUFilter filter;
+	MPUFilterQ filter_q;
+	filter.begin(SAMPLE_RATE_HZ);
+	filter_q.begin(SAMPLE_RATE_HZ, GYRO_LSB_PER_DPS);
+	if (variant == PER_SAMPLE_SQRTF || variant == BATCH_SQRTF) filter.setNormalisation(MPUFILTER_NORM_SQRTF);
+
+	const float (*gyro)[3] = (const float (*)[3])s.gyro_dps.data();
+	const float (*accel)[3] = (const float (*)[3])s.accel_g.data();
+	const int16_t (*gyro_q)[3] = (const int16_t (*)[3])s.gyro.data();
+	const int16_t (*accel_q)[3] = (const int16_t (*)[3])s.accel.data();
+
+	size_t step = (trace || variant == PER_SAMPLE_FAST || variant == PER_SAMPLE_SQRTF) ? 1 : BATCH;
+	for (size_t i = 0; i < s.count; i += step) {
+		size_t n = (s.count - i < step) ? s.count - i : step;
+		switch (variant) {
+		case PER_SAMPLE_FAST:
+		case PER_SAMPLE_SQRTF:
+			filter.updateIMU(gyro[i][0], gyro[i][1], gyro[i][2], accel[i][0], accel[i][1], accel[i][2]);
+			break;
+		case BATCH_FAST:
+		case BATCH_SQRTF:
+			filter.updateIMUBatch(&gyro[i], &accel[i], nullptr, n);
+			break;
+		case FIXED_Q30:
+			filter_q.updateIMUBatch(&gyro_q[i], &accel_q[i], n);
+			break;
+		}
+		if (trace) {
+			if (variant == FIXED_Q30) trace->push_back({ filter_q.getQ0(), filter_q.getQ1(), filter_q.getQ2(), filter_q.getQ3() });
+			else trace->push_back({ filter.getQ0(), filter.getQ1(), filter.getQ2(), filter.getQ3() });
+		}
+	}
+	if (variant == FIXED_Q30) return { filter_q.getQ0(), filter_q.getQ1(), filter_q.getQ2(), filter_q.getQ3() };
+	return { filter.getQ0(), filter.getQ1(), filter.getQ2(), filter.getQ3() };
+}
+
+int main()
+{
+	Stream s = makeStream();
+	printf("%zu samples at %.0f Hz, batches of %zu\n\n", s.count, SAMPLE_RATE_HZ, BATCH);
+
+	std::vector<Quat> reference;
+	runVariant(PER_SAMPLE_FAST, s, &reference);
+
+	// Skip the first 10 s while the filter converges from identity
+	size_t settle = (size_t)(10.0f * SAMPLE_RATE_HZ);
+
+	printf("%-36s %10s %10s %10s %10s\n", "variant", "rms err", "max err", "max vs ref", "ns/sample");
+	for (int v = PER_SAMPLE_FAST; v <= FIXED_Q30; v++) {
+		Variant variant = (Variant)v;
+		std::vector<Quat> trace;
+		runVariant(variant, s, &trace);
+
+		double sum_sq = 0.0, max_err = 0.0, max_ref = 0.0;
+		for (size_t i = settle; i < s.count; i++) {
+			double err = quatAngleDeg(trace[i], s.truth[i]);
+			sum_sq += err * err;
+			max_err = std::fmax(max_err, err);
+			max_ref = std::fmax(max_ref, quatAngleDeg(trace[i], reference[i]));
+		}
+		double rms = std::sqrt(sum_sq / (s.count - settle));
+
+		volatile double sink = 0.0;
+		auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < TIMING_PASSES; pass++) {
+			Quat q = runVariant(variant, s, nullptr);
+			sink = sink + q.w;
+		}
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+		            ((double)TIMING_PASSES * s.count);
+
+		printf("%-36s %10.3f %10.3f %10.4f %10.1f\n", variant_names[v], rms, max_err, max_ref, ns);
+	}
+	printf("\nErrors in degrees. Yaw is unobserved without a magnetometer; its drift is shared by all variants.\n");
+	return 0;
+}
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Convert SN_Trace serial dumps to Chrome trace / Perfetto JSON.
+
+Capture the output of the "trace dump" serial console command (a whole
+serial log is fine, only the "# SN_TRACE BEGIN" ... "# SN_TRACE END" block is
+used), then:
+
+    tools/trace2chrome.py obc.log -o trace.json
+    tools/trace2chrome.py OBC=obc.log CTU=ctu.log -o trace.json
+
+Open the result in chrome://tracing or https://ui.perfetto.dev.
+
+Each input becomes one process (named by the optional LABEL= prefix), each
+core/task pair one thread. The boards' clocks are not synchronised, so with
+several inputs every board starts at t=0; use --align to shift one board so
+that an instant event (e.g. tc_send / tc_queued with the same sequence
+number) lines up with its counterpart on the other board.
+"""
+
+import argparse
+import json
+import sys
+
+WRAP = 1 << 32
+
+
+def parse_dump(path):
+    """Return the events of the last complete dump block in a log file."""
+    blocks = []
+    current = None
+    with open(path, "r", errors="replace") as f:
+        for raw in f:
+            line = raw.strip()
+            # Serial loggers may prefix lines; look for the marker anywhere
+            if "# SN_TRACE BEGIN" in line:
+                current = []
+                continue
+            if "# SN_TRACE END" in line:
+                if current is not None:
+                    blocks.append(current)
+                current = None
+                continue
+            if current is None or line.startswith("#") or not line:
+                continue
+            fields = line.split(",")
+            if len(fields) != 7:
+                continue
+            try:
+                current.append({
+                    "seq": int(fields[0]),
+                    "time_us": int(fields[1]),
+                    "phase": fields[2],
+                    "core": int(fields[3]),
+                    "thread": fields[4],
+                    "name": fields[5],
+                    "arg": int(fields[6]),
+                })
+            except ValueError:
+                continue
+    if not blocks:
+        raise SystemExit("%s: no complete SN_TRACE block found" % path)
+    return blocks[-1]
+
+
+def unwrap_times(events):
+    """Undo 32-bit microsecond wrap-around; events are in recording order."""
+    offset = 0
+    previous = None
+    for event in events:
+        t = event["time_us"] + offset
+        if previous is not None and previous - t > WRAP // 2:
+            offset += WRAP
+            t += WRAP
+        event["ts"] = t
+        previous = t
+
+
+def to_chrome(label, pid, events):
+    out = [{"name": "process_name", "ph": "M", "pid": pid, "tid": 0,
+            "args": {"name": label}}]
+    threads = {}
+    for event in events:
+        key = (event["core"], event["thread"])
+        if key not in threads:
+            tid = len(threads) + 1
+            threads[key] = tid
+            out.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": tid,
+                        "args": {"name": "%s (core %d)" % (event["thread"], event["core"])}})
+
+    for event in events:
+        item = {
+            "name": event["name"],
+            "ph": event["phase"],
+            "ts": event["ts"],
+            "pid": pid,
+            "tid": threads[(event["core"], event["thread"])],
+        }
+        if event["phase"] == "X":
+            item["dur"] = event["arg"]
+        elif event["phase"] == "i":
+            item["s"] = "t"
+            item["args"] = {"arg": event["arg"]}
+        out.append(item)
+    return out
+
+
+def find_instant(events, name, arg):
+    for event in events:
+        if event["phase"] == "i" and event["name"] == name and event["arg"] == arg:
+            return event["ts"]
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("inputs", nargs="+", help="[LABEL=]serial_log")
+    parser.add_argument("-o", "--output", default="-", help="output JSON file (default: stdout)")
+    parser.add_argument("--align", metavar="A:NAME:ARG=B:NAME:ARG",
+                        help="shift board B so its instant NAME/ARG coincides with A's, "
+                             "e.g. CTU:tc_send:1234=OBC:tc_queued:1234")
+    args = parser.parse_args()
+
+    boards = []
+    for spec in args.inputs:
+        label, _, path = spec.rpartition("=")
+        if not label:
+            label = path
+        events = parse_dump(path)
+        unwrap_times(events)
+        boards.append((label, events))
+
+    # Every board starts at 0 unless aligned below
+    for _, events in boards:
+        if events:
+            base = min(e["ts"] for e in events)
+            for e in events:
+                e["ts"] -= base
+
+    if args.align:
+        try:
+            left, right = args.align.split("=")
+            a_label, a_name, a_arg = left.split(":")
+            b_label, b_name, b_arg = right.split(":")
+        except ValueError:
+            raise SystemExit("--align: expected A:NAME:ARG=B:NAME:ARG")
+        by_label = dict(boards)
+        if a_label not in by_label or b_label not in by_label:
+            raise SystemExit("--align: unknown board label")
+        a_ts = find_instant(by_label[a_label], a_name, int(a_arg))
+        b_ts = find_instant(by_label[b_label], b_name, int(b_arg))
+        if a_ts is None or b_ts is None:
+            raise SystemExit("--align: instant event not found")
+        for e in by_label[b_label]:
+            e["ts"] += a_ts - b_ts
+
+    trace = []
+    for pid, (label, events) in enumerate(boards, start=1):
+        trace.extend(to_chrome(label, pid, events))
+
+    doc = {"traceEvents": trace, "displayTimeUnit": "ms"}
+    if args.output == "-":
+        json.dump(doc, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(doc, f)
+
+
+if __name__ == "__main__":
+    main()